@@ -32,10 +32,11 @@ let package = Package(
             name: "CCFITSIOWrapper",
             dependencies: ["CCFITSIO"],
             path: "Sources/CCFITSIO",
-            sources: ["cfitsio_wrapper.c"],
+            sources: ["cfitsio_wrapper.c", "pixel_kernels.c", "header_scanner.c", "checksum.c", "gzip_stream.c", "image_kernels.c"],
             publicHeadersPath: ".",
             linkerSettings: [
-                .linkedLibrary("cfitsio")
+                .linkedLibrary("cfitsio"),
+                .linkedLibrary("z")
             ]
         ),
         // Swift target that depends on the C library and wrapper
@@ -0,0 +1,296 @@
+import Foundation
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("apk_convolve_rows_horizontal")
+func convolveRowsHorizontal(_ src: UnsafePointer<Float32>, _ srcStride: Int, _ dst: UnsafeMutablePointer<Float32>, _ dstStride: Int, _ width: Int, _ y0: Int, _ y1: Int, _ weights: UnsafePointer<Float32>, _ radius: Int)
+
+@_silgen_name("apk_convolve_rows_vertical")
+func convolveRowsVertical(_ src: UnsafePointer<Float32>, _ srcStride: Int, _ dst: UnsafeMutablePointer<Float32>, _ dstStride: Int, _ width: Int, _ height: Int, _ y0: Int, _ y1: Int, _ weights: UnsafePointer<Float32>, _ radius: Int)
+
+@_silgen_name("apk_quantize_rows_u8")
+func quantizeRows(_ src: UnsafePointer<Float32>, _ srcStride: Int, _ dst: UnsafeMutablePointer<UInt8>, _ dstStride: Int, _ width: Int, _ y0: Int, _ y1: Int)
+
+@_silgen_name("apk_local_median_rows")
+func localMedianRows(_ bins: UnsafePointer<UInt8>, _ binStride: Int, _ dst: UnsafeMutablePointer<Float32>, _ dstStride: Int, _ width: Int, _ height: Int, _ y0: Int, _ y1: Int, _ halfWindow: Int)
+
+@_silgen_name("apk_subtract_clamped_f32")
+func subtractClamped(_ src: UnsafePointer<Float32>, _ background: UnsafePointer<Float32>, _ dst: UnsafeMutablePointer<Float32>, _ count: Int)
+
+@_silgen_name("apk_threshold_f32")
+func thresholdPixels(_ src: UnsafePointer<Float32>, _ dst: UnsafeMutablePointer<Float32>, _ count: Int, _ threshold: Float32)
+
+@_silgen_name("apk_sum_squares_f32")
+func accumulateSumSquares(_ src: UnsafePointer<Float32>, _ count: Int, _ sum: UnsafeMutablePointer<Double>, _ sumSquares: UnsafeMutablePointer<Double>)
+
+@_silgen_name("apk_histogram_f32")
+func accumulateHistogram(_ src: UnsafePointer<Float32>, _ count: Int, _ center: Float32, _ absolute: Int32, _ scale: Float32, _ bins: Int32, _ histogram: UnsafeMutablePointer<UInt32>)
+
+@_silgen_name("apk_binary_morphology_rows_horizontal")
+func binaryMorphologyRowsHorizontal(_ src: UnsafePointer<Float32>, _ srcStride: Int, _ dst: UnsafeMutablePointer<Float32>, _ dstStride: Int, _ width: Int, _ y0: Int, _ y1: Int, _ radius: Int, _ erode: Int32)
+
+@_silgen_name("apk_binary_morphology_rows_vertical")
+func binaryMorphologyRowsVertical(_ src: UnsafePointer<Float32>, _ srcStride: Int, _ dst: UnsafeMutablePointer<Float32>, _ dstStride: Int, _ width: Int, _ height: Int, _ y0: Int, _ y1: Int, _ radius: Int, _ erode: Int32)
+
+@_silgen_name("apk_collect_set_pixels")
+func collectSetPixels(_ row: UnsafePointer<Float32>, _ width: Int, _ y: Int, _ coordinates: UnsafeMutablePointer<Int32>) -> Int
+
+@_silgen_name("apk_gray_to_rgba_f32")
+func convertGrayToRGBA(_ src: UnsafePointer<Float32>, _ dst: UnsafeMutablePointer<Float32>, _ count: Int)
+
+@_silgen_name("apk_draw_ellipses_rows")
+func drawEllipseRows(_ rgba: UnsafeMutablePointer<Float32>, _ rowStride: Int, _ width: Int, _ y0: Int, _ y1: Int, _ ellipses: UnsafePointer<Float32>, _ ellipseCount: Int, _ color: UnsafePointer<Float32>)
+
+@_silgen_name("apk_draw_quads_rows")
+func drawQuadRows(_ rgba: UnsafeMutablePointer<Float32>, _ rowStride: Int, _ width: Int, _ y0: Int, _ y1: Int, _ quads: UnsafePointer<Float32>, _ quadCount: Int, _ color: UnsafePointer<Float32>, _ lineWidth: Float32)
+
+/// CPU implementations of the image operations of the star detection steps
+///
+/// Each operation splits the image into bands of rows that run on all cores; the per-row
+/// loops are C kernels that the compiler vectorizes. The results match the Metal shaders of
+/// the same steps. Inputs must be single-channel unless stated otherwise.
+extension CPUComputeContext {
+    /// Applies a separable Gaussian blur with clamped edges, like the `gaussian_blur_*` shaders
+    /// - Parameters:
+    ///   - image: The image to blur
+    ///   - radius: Blur radius in pixels (sigma = radius / 2)
+    /// - Returns: The blurred image
+    public func gaussianBlur(_ image: ImageBuffer, radius: Float) -> ImageBuffer {
+        guard radius > 0 else {
+            return image
+        }
+        let sigma = max(radius / 2.0, 0.5)
+        let kernelRadius = Int(ceil(radius * 2.0))
+        var weights = (-kernelRadius...kernelRadius).map { offset -> Float32 in
+            exp(-Float(offset * offset) / (2.0 * sigma * sigma))
+        }
+        let weightSum = weights.reduce(0, +)
+        weights = weights.map { $0 / weightSum }
+
+        let horizontal: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        weights.withUnsafeBufferPointer { taps in
+            forEachRowBand(height: image.height) { rows in
+                convolveRowsHorizontal(image.baseAddress, image.rowStride, horizontal.baseAddress, horizontal.rowStride,
+                                       image.width, rows.lowerBound, rows.upperBound, taps.baseAddress!, kernelRadius)
+            }
+            forEachRowBand(height: image.height) { rows in
+                convolveRowsVertical(horizontal.baseAddress, horizontal.rowStride, output.baseAddress, output.rowStride,
+                                     image.width, image.height, rows.lowerBound, rows.upperBound, taps.baseAddress!, kernelRadius)
+            }
+        }
+        return output
+    }
+
+    /// Computes the median of the window around each pixel, like the `local_median` shader
+    ///
+    /// Values are binned into 256 levels and the window is clipped at the image edges; each
+    /// output pixel is the center of its median bin.
+    /// - Parameters:
+    ///   - image: The image, with values in 0-1
+    ///   - windowSize: Window width and height in pixels
+    /// - Returns: The local median image
+    public func localMedian(_ image: ImageBuffer, windowSize: Int) -> ImageBuffer {
+        let bins: PixelBuffer<UInt8> = makeBuffer(width: image.width, height: image.height)
+        forEachRowBand(height: image.height) { rows in
+            quantizeRows(image.baseAddress, image.rowStride, bins.baseAddress, bins.rowStride,
+                         image.width, rows.lowerBound, rows.upperBound)
+        }
+
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        forEachRowBand(height: image.height) { rows in
+            localMedianRows(bins.baseAddress, bins.rowStride, output.baseAddress, output.rowStride,
+                            image.width, image.height, rows.lowerBound, rows.upperBound, max(0, windowSize / 2))
+        }
+        return output
+    }
+
+    /// Subtracts a background image, clamping the result to 0-1
+    /// - Parameters:
+    ///   - background: The background to subtract
+    ///   - image: The image
+    /// - Returns: The background-subtracted image
+    public func subtract(_ background: ImageBuffer, from image: ImageBuffer) -> ImageBuffer {
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        forEachRowBand(height: image.height) { rows in
+            for y in rows {
+                subtractClamped(image.row(y), background.row(y), output.row(y), image.width)
+            }
+        }
+        return output
+    }
+
+    /// Creates an image with every pixel set to the same value
+    /// - Parameters:
+    ///   - width: Width in pixels
+    ///   - height: Height in pixels
+    ///   - value: The pixel value
+    /// - Returns: The uniform image
+    public func uniformImage(width: Int, height: Int, value: Float32) -> ImageBuffer {
+        let output: ImageBuffer = makeBuffer(width: width, height: height)
+        forEachRowBand(height: height) { rows in
+            for y in rows {
+                output.row(y).update(repeating: value, count: width)
+            }
+        }
+        return output
+    }
+
+    /// Sets pixels at or above a threshold to 1 and all others to 0
+    /// - Parameters:
+    ///   - image: The image
+    ///   - threshold: The threshold value
+    /// - Returns: The binary mask
+    public func threshold(_ image: ImageBuffer, at threshold: Float32) -> ImageBuffer {
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        forEachRowBand(height: image.height) { rows in
+            for y in rows {
+                thresholdPixels(image.row(y), output.row(y), image.width, threshold)
+            }
+        }
+        return output
+    }
+
+    /// Applies binary erosion or dilation with a square kernel, like the `binary_*` shaders
+    ///
+    /// Pixels >= 0.5 are set. Erosion keeps a pixel only if its whole window is set; dilation
+    /// sets it if any pixel of the window is set. The window is clipped at the image edges.
+    /// - Parameters:
+    ///   - image: The binary image
+    ///   - kernelSize: Odd kernel width and height in pixels
+    ///   - erode: True for erosion, false for dilation
+    /// - Returns: The binary result
+    public func binaryMorphology(_ image: ImageBuffer, kernelSize: Int, erode: Bool) -> ImageBuffer {
+        // The square window is separable: combine along rows first, then along columns
+        let radius = kernelSize / 2
+        let horizontal: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height)
+        forEachRowBand(height: image.height) { rows in
+            binaryMorphologyRowsHorizontal(image.baseAddress, image.rowStride, horizontal.baseAddress, horizontal.rowStride,
+                                           image.width, rows.lowerBound, rows.upperBound, radius, erode ? 1 : 0)
+        }
+        forEachRowBand(height: image.height) { rows in
+            binaryMorphologyRowsVertical(horizontal.baseAddress, horizontal.rowStride, output.baseAddress, output.rowStride,
+                                         image.width, image.height, rows.lowerBound, rows.upperBound, radius, erode ? 1 : 0)
+        }
+        return output
+    }
+
+    /// Computes the mean and standard deviation of all pixels
+    /// - Parameter image: The image
+    /// - Returns: Mean and population standard deviation
+    public func meanAndStandardDeviation(_ image: ImageBuffer) -> (mean: Float, standardDeviation: Float) {
+        let totals = reduceRowBands(height: image.height, initial: (0.0, 0.0)) { rows -> (Double, Double) in
+            var sum = 0.0
+            var sumSquares = 0.0
+            for y in rows {
+                accumulateSumSquares(image.row(y), image.width, &sum, &sumSquares)
+            }
+            return (sum, sumSquares)
+        } combine: { total, band in
+            total.0 += band.0
+            total.1 += band.1
+        }
+
+        let count = Double(image.width * image.height)
+        guard count > 0 else {
+            return (0, 0)
+        }
+        let mean = totals.0 / count
+        let variance = totals.1 / count - mean * mean
+        return (Float(mean), Float(sqrt(max(0.0, variance))))
+    }
+
+    /// Counts the pixels per histogram bin
+    ///
+    /// The bin of a value v is `min(Int(clamp(v, 0, 1) * scale), bins - 1)`, where v is the
+    /// pixel value or, for `deviationFrom`, its absolute distance from that center.
+    /// - Parameters:
+    ///   - image: The image
+    ///   - bins: Number of bins
+    ///   - scale: Factor mapping 0-1 to bin indices (default: `bins`)
+    ///   - center: If set, histogram the absolute deviations from this value
+    /// - Returns: The count of each bin
+    public func histogram(_ image: ImageBuffer, bins: Int, scale: Float? = nil, deviationFrom center: Float? = nil) -> [Int] {
+        let binScale = scale ?? Float(bins)
+        return reduceRowBands(height: image.height, initial: [Int](repeating: 0, count: bins)) { rows -> [UInt32] in
+            var counts = [UInt32](repeating: 0, count: bins)
+            counts.withUnsafeMutableBufferPointer { histogram in
+                for y in rows {
+                    accumulateHistogram(image.row(y), image.width, center ?? 0, center == nil ? 0 : 1,
+                                        binScale, Int32(bins), histogram.baseAddress!)
+                }
+            }
+            return counts
+        } combine: { total, band in
+            for bin in 0..<bins {
+                total[bin] += Int(band[bin])
+            }
+        }
+    }
+
+    /// Returns the coordinates of all pixels >= 0.5, in row-major order
+    /// - Parameter image: The binary image
+    /// - Returns: The coordinates of the set pixels
+    public func setPixelCoordinates(_ image: ImageBuffer) -> [PixelCoordinate] {
+        return reduceRowBands(height: image.height, initial: [PixelCoordinate]()) { rows -> [PixelCoordinate] in
+            let scratch = UnsafeMutablePointer<Int32>.allocate(capacity: max(1, 2 * image.width))
+            defer { scratch.deallocate() }
+
+            var coordinates: [PixelCoordinate] = []
+            for y in rows {
+                let count = collectSetPixels(image.row(y), image.width, y, scratch)
+                for index in 0..<count {
+                    coordinates.append(PixelCoordinate(x: Int(scratch[2 * index]), y: Int(scratch[2 * index + 1])))
+                }
+            }
+            return coordinates
+        } combine: { total, band in
+            total.append(contentsOf: band)
+        }
+    }
+
+    /// Draws ellipses and quads on a grayscale image, like the `StarDetectionOverlay` filter
+    ///
+    /// Without ellipses the image is returned unchanged, as the Metal filter does.
+    /// - Parameters:
+    ///   - image: The grayscale image
+    ///   - ellipses: Ellipses to draw (outline and axes)
+    ///   - ellipseColor: RGB color of the ellipses
+    ///   - quads: Quads to draw (outline S1-S2-S3-S4-S1)
+    ///   - quadColor: RGB color of the quad lines
+    ///   - quadWidth: Line width of the quads in pixels
+    /// - Returns: An RGBA image with the overlay
+    public func drawStarDetectionOverlay(
+        on image: ImageBuffer,
+        ellipses: [StarEllipse],
+        ellipseColor: SIMD3<Float>,
+        quads: [QuadLine],
+        quadColor: SIMD3<Float>,
+        quadWidth: Float
+    ) -> ImageBuffer {
+        guard !ellipses.isEmpty else {
+            return image
+        }
+
+        let ellipseData = ellipses.flatMap { [$0.centroidX, $0.centroidY, $0.majorAxis, $0.minorAxis, $0.rotationAngle] }
+        let quadData = quads.flatMap { [$0.x1, $0.y1, $0.x2, $0.y2, $0.x3, $0.y3, $0.x4, $0.y4] }
+        let ellipseRGB = [ellipseColor.x, ellipseColor.y, ellipseColor.z]
+        let quadRGB = [quadColor.x, quadColor.y, quadColor.z]
+
+        // Each band copies its rows and draws the parts of the shapes that fall into them
+        let output: ImageBuffer = makeBuffer(width: image.width, height: image.height, channels: 4)
+        forEachRowBand(height: image.height) { rows in
+            for y in rows {
+                convertGrayToRGBA(image.row(y), output.row(y), image.width)
+            }
+            drawEllipseRows(output.baseAddress, output.rowStride, output.width, rows.lowerBound, rows.upperBound,
+                            ellipseData, ellipses.count, ellipseRGB)
+            if !quads.isEmpty {
+                drawQuadRows(output.baseAddress, output.rowStride, output.width, rows.lowerBound, rows.upperBound,
+                             quadData, quads.count, quadRGB, quadWidth)
+            }
+        }
+        return output
+    }
+}
@@ -0,0 +1,263 @@
+import Foundation
+import Metal
+
+/// A Float32 image in main memory, the pixel payload of `ProcessedImage`
+public typealias ImageBuffer = PixelBuffer<Float32>
+
+/// A strided 2D image of typed pixels in main memory
+///
+/// Pixels are stored row by row in an `AlignedPixelStore`, with `channels` interleaved values
+/// per pixel (1 for grayscale and binary images, 4 for RGBA). Buffers allocated here start
+/// every row on a 64-byte boundary; a buffer may also be a region of a larger store
+/// (`offset`, `rowStride`), which lets it wrap a region of another buffer or borrowed memory
+/// without copying. Buffers created by the CPU kernels are
+/// written once and then only read, so they can be shared between steps and threads.
+public struct PixelBuffer<Element> {
+    /// The backing store
+    public let store: AlignedPixelStore<Element>
+
+    /// Index of the first value in the store
+    public let offset: Int
+
+    /// Width in pixels
+    public let width: Int
+
+    /// Height in pixels
+    public let height: Int
+
+    /// Number of interleaved values per pixel
+    public let channels: Int
+
+    /// Distance between the starts of consecutive rows, in values
+    public let rowStride: Int
+
+    /// Allocates an uninitialized buffer whose rows start on 64-byte boundaries
+    /// - Parameters:
+    ///   - width: Width in pixels
+    ///   - height: Height in pixels
+    ///   - channels: Number of values per pixel (default: 1)
+    public init(width: Int, height: Int, channels: Int = 1) {
+        let rowStride = PixelBuffer.alignedRowStride(width: width, channels: channels)
+        self.init(
+            store: AlignedPixelStore(count: max(0, height - 1) * rowStride + width * channels),
+            offset: 0,
+            width: width,
+            height: height,
+            channels: channels,
+            rowStride: rowStride
+        )
+    }
+
+    /// Creates a buffer backed by an existing pixel store (no copy)
+    /// - Parameters:
+    ///   - store: Store holding the pixels
+    ///   - offset: Index of the first value in the store
+    ///   - width: Width in pixels
+    ///   - height: Height in pixels
+    ///   - channels: Number of values per pixel
+    ///   - rowStride: Row stride in values
+    public init(store: AlignedPixelStore<Element>, offset: Int, width: Int, height: Int, channels: Int, rowStride: Int) {
+        precondition(rowStride >= width * channels, "Row stride is smaller than a row")
+        precondition(height == 0 || offset + (height - 1) * rowStride + width * channels <= store.count, "Buffer exceeds its store")
+        self.store = store
+        self.offset = offset
+        self.width = width
+        self.height = height
+        self.channels = channels
+        self.rowStride = rowStride
+    }
+
+    /// Creates a buffer over memory owned by another object (no copy)
+    ///
+    /// Use this for pixels in a memory-mapped file or a shared Metal buffer.
+    /// - Parameters:
+    ///   - pointer: First value of the first row
+    ///   - width: Width in pixels
+    ///   - height: Height in pixels
+    ///   - channels: Number of values per pixel (default: 1)
+    ///   - rowStride: Row stride in values (default: no padding)
+    ///   - owner: Object that keeps the memory alive
+    public init(
+        borrowing pointer: UnsafeMutablePointer<Element>,
+        width: Int,
+        height: Int,
+        channels: Int = 1,
+        rowStride: Int? = nil,
+        owner: AnyObject?
+    ) {
+        let stride = rowStride ?? width * channels
+        self.init(
+            store: AlignedPixelStore(borrowing: pointer, count: max(0, height - 1) * stride + width * channels, owner: owner),
+            offset: 0,
+            width: width,
+            height: height,
+            channels: channels,
+            rowStride: stride
+        )
+    }
+
+    /// Row stride in values that starts every row of a new buffer on a 64-byte boundary
+    public static func alignedRowStride(width: Int, channels: Int) -> Int {
+        let alignment = max(1, AlignedPixelStore<Element>.alignment / MemoryLayout<Element>.stride)
+        return (width * channels + alignment - 1) / alignment * alignment
+    }
+
+    /// True if the buffer does not own its memory
+    public var isBorrowed: Bool {
+        !store.ownsMemory
+    }
+
+    /// True if the rows follow each other without padding
+    public var isContiguous: Bool {
+        rowStride == width * channels
+    }
+
+    /// Returns the value of a channel of a pixel
+    public subscript(x: Int, y: Int, channel: Int = 0) -> Element {
+        precondition(x >= 0 && x < width && y >= 0 && y < height && channel >= 0 && channel < channels, "Pixel out of range")
+        return store.pointer[offset + y * rowStride + x * channels + channel]
+    }
+
+    /// Returns a rectangular region of the buffer that shares its pixels (no copy)
+    /// - Parameters:
+    ///   - x: Left column of the region
+    ///   - y: Top row of the region
+    ///   - width: Width of the region in pixels
+    ///   - height: Height of the region in pixels
+    /// - Returns: The region, with the row stride of this buffer
+    public func region(x: Int, y: Int, width: Int, height: Int) -> PixelBuffer {
+        precondition(x >= 0 && y >= 0 && width >= 0 && height >= 0 && x + width <= self.width && y + height <= self.height,
+                     "Region exceeds the buffer")
+        return PixelBuffer(
+            store: store,
+            offset: offset + y * rowStride + x * channels,
+            width: width,
+            height: height,
+            channels: channels,
+            rowStride: rowStride
+        )
+    }
+
+    /// Copies the pixels into a new buffer that owns its memory
+    public func copy() -> PixelBuffer {
+        let output = PixelBuffer(width: width, height: height, channels: channels)
+        for y in 0..<height {
+            output.row(y).initialize(from: row(y), count: width * channels)
+        }
+        return output
+    }
+
+    /// Copies the pixels into an array, row by row without padding
+    public func toArray() -> [Element] {
+        let rowLength = width * channels
+        return [Element](unsafeUninitializedCapacity: rowLength * height) { destination, initialized in
+            for y in 0..<height {
+                (destination.baseAddress! + y * rowLength).initialize(from: row(y), count: rowLength)
+            }
+            initialized = rowLength * height
+        }
+    }
+
+    /// Calls `body` with the address of the first value and the row stride
+    ///
+    /// The pixels stay valid for the duration of the call. Write only to buffers that no other
+    /// step or thread reads yet.
+    public func withUnsafeBaseAddress<R>(_ body: (UnsafeMutablePointer<Element>, _ rowStride: Int) throws -> R) rethrows -> R {
+        return try withExtendedLifetime(store) {
+            try body(baseAddress, rowStride)
+        }
+    }
+
+    /// Address of the first value of the buffer
+    var baseAddress: UnsafeMutablePointer<Element> {
+        store.pointer + offset
+    }
+
+    /// Address of the first value of a row
+    func row(_ y: Int) -> UnsafeMutablePointer<Element> {
+        baseAddress + y * rowStride
+    }
+}
+
+extension PixelBuffer where Element == Float32 {
+    /// Copies the normalized pixels of the first plane of a FITS image into a new buffer
+    ///
+    /// The FITS image keeps its pixels in their original value range, so they are normalized
+    /// row by row while they are copied.
+    /// - Parameter fitsImage: The FITS image
+    public init(fitsImage: FITSImage) {
+        self.init(width: fitsImage.width, height: fitsImage.height)
+        let view = fitsImage.normalizedPixels
+        for y in 0..<height {
+            view.copyRow(y, into: row(y))
+        }
+    }
+
+    // MARK: - Metal
+
+    /// Creates a texture that reads the pixels of this buffer
+    ///
+    /// On devices with unified memory the texture is a view of the buffer's own memory when its
+    /// alignment allows it; otherwise the pixels are copied into a new texture. Either way the
+    /// texture must only be read.
+    /// - Parameter device: The Metal device
+    /// - Returns: A `.r32Float` or `.rgba32Float` texture
+    /// - Throws: PipelineStepError if the buffer has another channel count or no texture can be created
+    public func makeMetalTexture(device: MTLDevice) throws -> MTLTexture {
+        guard channels == 1 || channels == 4 else {
+            throw PipelineStepError.invalidInputType("image buffer", expected: "1 or 4 channels")
+        }
+        let pixelFormat: MTLPixelFormat = channels == 4 ? .rgba32Float : .r32Float
+        let descriptor = MTLTextureDescriptor.texture2DDescriptor(
+            pixelFormat: pixelFormat,
+            width: width,
+            height: height,
+            mipmapped: false
+        )
+        descriptor.usage = [.shaderRead]
+
+        if let texture = makeSharedTexture(device: device, descriptor: descriptor) {
+            return texture
+        }
+
+        descriptor.storageMode = .shared
+        guard let texture = device.makeTexture(descriptor: descriptor) else {
+            throw PipelineStepError.couldNotCreateResource("texture for image buffer")
+        }
+        texture.replace(
+            region: MTLRegionMake2D(0, 0, width, height),
+            mipmapLevel: 0,
+            withBytes: baseAddress,
+            bytesPerRow: rowStride * MemoryLayout<Float32>.stride
+        )
+        return texture
+    }
+
+    /// Wraps the store in a no-copy Metal buffer and returns a texture view of it, if possible
+    func makeSharedTexture(device: MTLDevice, descriptor: MTLTextureDescriptor) -> MTLTexture? {
+        let pageSize = Int(getpagesize())
+        let bytesPerRow = rowStride * MemoryLayout<Float32>.stride
+        let byteOffset = offset * MemoryLayout<Float32>.stride
+        let linearAlignment = device.minimumLinearTextureAlignment(for: descriptor.pixelFormat)
+        guard device.hasUnifiedMemory,
+              Int(bitPattern: store.pointer) % pageSize == 0,
+              store.allocatedByteCount % pageSize == 0,
+              bytesPerRow % linearAlignment == 0,
+              byteOffset % linearAlignment == 0 else {
+            return nil
+        }
+
+        // The Metal buffer keeps the store alive until the last texture view is released
+        let store = self.store
+        guard let metalBuffer = device.makeBuffer(
+            bytesNoCopy: store.pointer,
+            length: store.allocatedByteCount,
+            options: [.storageModeShared],
+            deallocator: { _, _ in withExtendedLifetime(store) {} }
+        ) else {
+            return nil
+        }
+        descriptor.storageMode = .shared
+        return metalBuffer.makeTexture(descriptor: descriptor, offset: byteOffset, bytesPerRow: bytesPerRow)
+    }
+}
@@ -0,0 +1,191 @@
+import Foundation
+import Metal
+
+/// Recycles the pixel stores of intermediate images between steps and frames
+///
+/// Stores are grouped in size classes, so images of the same geometry, and of nearly the same
+/// size, share them. The pool keeps a reference to every store it hands out; a store is free
+/// again once the pool holds the only reference, i.e. when the last image, region or texture
+/// using it has been released. No step has to return buffers explicitly, and a buffer can
+/// never be reused while something still reads it.
+///
+/// Stores that are not in use are released when the pool would otherwise exceed `byteBudget`.
+/// A pool is shared by all steps of a `PipelineExecutor` and is safe to use from any thread.
+public final class PixelBufferPool {
+    /// Usage counters of a pool
+    public struct Statistics: Equatable {
+        /// Requests served with a free store of the pool
+        public var buffersReused = 0
+        /// Requests that allocated a new store
+        public var buffersAllocated = 0
+        /// Bytes of all stores held by the pool, in use or free
+        public var bytes = 0
+        /// Number of stores held by the pool
+        public var storeCount = 0
+    }
+
+    private struct SizeClass: Hashable {
+        let element: ObjectIdentifier
+        let byteCount: Int
+    }
+
+    /// Maximum number of bytes the pool holds on to
+    public let byteBudget: Int
+
+    private let lock = NSLock()
+    private var stores: [SizeClass: [AnyObject]] = [:]
+    private var counters = Statistics()
+
+    /// Creates a pool
+    /// - Parameter byteBudget: Maximum number of bytes held by the pool (default: 1 GiB)
+    public init(byteBudget: Int = 1 << 30) {
+        self.byteBudget = byteBudget
+    }
+
+    /// Usage counters since the pool was created
+    public var statistics: Statistics {
+        lock.lock()
+        defer { lock.unlock() }
+        return counters
+    }
+
+    /// Returns an uninitialized buffer whose rows start on 64-byte boundaries
+    /// - Parameters:
+    ///   - width: Width in pixels
+    ///   - height: Height in pixels
+    ///   - channels: Number of values per pixel (default: 1)
+    /// - Returns: A buffer backed by a free store of the pool, or a new one
+    public func makeBuffer<Element>(width: Int, height: Int, channels: Int = 1) -> PixelBuffer<Element> {
+        let rowStride = PixelBuffer<Element>.alignedRowStride(width: width, channels: channels)
+        let count = max(0, height - 1) * rowStride + width * channels
+        return PixelBuffer(
+            store: takeStore(count: count),
+            offset: 0,
+            width: width,
+            height: height,
+            channels: channels,
+            rowStride: rowStride
+        )
+    }
+
+    /// Returns a writable texture backed by a store of the pool, if the device allows it
+    ///
+    /// This works for 2D `.r32Float` and `.rgba32Float` textures on devices with unified memory;
+    /// for anything else it returns nil and the caller allocates the texture itself.
+    ///
+    /// Pooled textures are linear views of a buffer, which the GPU samples more slowly than its
+    /// own tiled textures, especially for neighbourhood reads. Use them only for outputs that
+    /// the CPU reads back, where the shared memory saves the copy; textures that later kernels
+    /// read should come from `device.makeTexture(descriptor:)`.
+    /// - Parameters:
+    ///   - descriptor: Descriptor of the texture
+    ///   - device: The Metal device
+    /// - Returns: The texture, or nil if it cannot come from the pool
+    public func makeTexture(descriptor: MTLTextureDescriptor, device: MTLDevice) -> MTLTexture? {
+        let channels: Int
+        switch descriptor.pixelFormat {
+        case .r32Float:
+            channels = 1
+        case .rgba32Float:
+            channels = 4
+        default:
+            return nil
+        }
+        guard device.hasUnifiedMemory,
+              descriptor.textureType == .type2D,
+              descriptor.mipmapLevelCount == 1 else {
+            return nil
+        }
+        let buffer: ImageBuffer = makeBuffer(width: descriptor.width, height: descriptor.height, channels: channels)
+        return buffer.makeSharedTexture(device: device, descriptor: descriptor)
+    }
+
+    /// Releases all stores that are not in use
+    public func removeUnused() {
+        lock.lock()
+        defer { lock.unlock() }
+        for sizeClass in Array(stores.keys) {
+            evictUnused(in: sizeClass)
+        }
+    }
+
+    /// Number of bytes of the size class of a request
+    ///
+    /// Requests up to a page are rounded to 64 bytes; larger ones to whole pages and then to a
+    /// quarter octave, which wastes at most a quarter of the allocation.
+    static func sizeClassByteCount(for byteCount: Int) -> Int {
+        let pageSize = Int(getpagesize())
+        guard byteCount > pageSize else {
+            return max(64, (byteCount + 63) / 64 * 64)
+        }
+        let pages = (byteCount + pageSize - 1) / pageSize
+        let octave = Int.bitWidth - (pages - 1).leadingZeroBitCount - 1
+        let step = max(1, (1 << max(0, octave)) / 4)
+        return (pages + step - 1) / step * step * pageSize
+    }
+
+    /// Returns a free store of the size class of `count` elements, or allocates one
+    private func takeStore<Element>(count: Int) -> AlignedPixelStore<Element> {
+        let stride = MemoryLayout<Element>.stride
+        let sizeClass = SizeClass(
+            element: ObjectIdentifier(Element.self),
+            byteCount: PixelBufferPool.sizeClassByteCount(for: max(1, count) * stride)
+        )
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        // Check the stores in place, so that no extra reference hides a free one
+        for index in (stores[sizeClass] ?? []).indices where isKnownUniquelyReferenced(&stores[sizeClass]![index]) {
+            counters.buffersReused += 1
+            // swiftlint:disable:next force_cast
+            return stores[sizeClass]![index] as! AlignedPixelStore<Element>
+        }
+
+        let store = AlignedPixelStore<Element>(count: sizeClass.byteCount / stride)
+        counters.buffersAllocated += 1
+
+        // Make room by releasing free stores, starting with other size classes
+        if counters.bytes + store.allocatedByteCount > byteBudget {
+            for other in Array(stores.keys) where other != sizeClass {
+                evictUnused(in: other)
+            }
+            evictUnused(in: sizeClass)
+        }
+        guard counters.bytes + store.allocatedByteCount <= byteBudget else {
+            // Over budget with stores in use: hand out the store without keeping it
+            return store
+        }
+        stores[sizeClass, default: []].append(store)
+        counters.bytes += store.allocatedByteCount
+        counters.storeCount += 1
+        return store
+    }
+
+    /// Drops the free stores of a size class
+    private func evictUnused(in sizeClass: SizeClass) {
+        guard let count = stores[sizeClass]?.count else {
+            return
+        }
+        for index in (0..<count).reversed() where isKnownUniquelyReferenced(&stores[sizeClass]![index]) {
+            counters.bytes -= PixelBufferPool.allocatedByteCount(of: stores[sizeClass]![index])
+            counters.storeCount -= 1
+            stores[sizeClass]!.remove(at: index)
+        }
+        if stores[sizeClass]?.isEmpty == true {
+            stores[sizeClass] = nil
+        }
+    }
+
+    /// Allocated bytes of a store of any element type
+    private static func allocatedByteCount(of store: AnyObject) -> Int {
+        return (store as? AllocatedByteCounting)?.allocatedByteCount ?? 0
+    }
+}
+
+/// Stores that report the size of their allocation, whatever their element type
+protocol AllocatedByteCounting: AnyObject {
+    var allocatedByteCount: Int { get }
+}
+
+extension AlignedPixelStore: AllocatedByteCounting {}
@@ -37,9 +37,47 @@ public struct ProcessingStep: Codable, Equatable {
 }
 
 /// Represents a processed image with metadata about its processing history
+///
+/// The primary payload is an `ImageBuffer` in main memory that CPU code reads in place. Images
+/// computed with Metal start out with only a texture; `pixelBuffer()` reads it back once and
+/// `metalTexture(device:)` creates a texture for a buffer once (without copying on devices with
+/// unified memory). Both results are kept with the image.
 public class ProcessedImage {
     /// The Metal texture containing the image data
-    public let texture: MTLTexture
+    ///
+    /// For an image that only has a pixel buffer, the texture is created on the system default
+    /// device the first time it is accessed. Use `metalTexture(device:)` to choose the device and
+    /// handle errors, or `existingTexture` to check for a texture without creating one.
+    public var texture: MTLTexture {
+        if let texture = existingTexture {
+            return texture
+        }
+        guard let device = MTLCreateSystemDefaultDevice() else {
+            preconditionFailure("No Metal device to create a texture for \(name)")
+        }
+        do {
+            return try metalTexture(device: device)
+        } catch {
+            preconditionFailure("Could not create a texture for \(name): \(error.localizedDescription)")
+        }
+    }
+    
+    /// The Metal texture containing the image data, if one has been created
+    public var existingTexture: MTLTexture? {
+        payload.lock.lock()
+        defer { payload.lock.unlock() }
+        return payload.texture
+    }
+    
+    /// The pixels in main memory, if they are available without reading back a texture
+    public var buffer: ImageBuffer? {
+        payload.lock.lock()
+        defer { payload.lock.unlock() }
+        return payload.buffer
+    }
+    
+    /// The pixels in main memory and on the GPU, filled in lazily
+    private let payload: Payload
     
     /// The type of image (grayscale, binary, RGB, RGBA)
     public let imageType: ImageType
@@ -61,12 +99,12 @@ public class ProcessedImage {
     public let name: String
     
     /// Width of the image
-    public var width: Int { texture.width }
+    public let width: Int
     
     /// Height of the image
-    public var height: Int { texture.height }
+    public let height: Int
     
-    public init(
+    public convenience init(
         texture: MTLTexture,
         imageType: ImageType,
         originalMinValue: Float = 0.0,
@@ -76,7 +114,77 @@ public class ProcessedImage {
         id: String = UUID().uuidString,
         name: String = "Processed Image"
     ) {
-        self.texture = texture
+        self.init(
+            texture: texture,
+            buffer: nil,
+            imageType: imageType,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            processingHistory: processingHistory,
+            fitsImage: fitsImage,
+            id: id,
+            name: name
+        )
+    }
+    
+    /// Creates a processed image whose pixels are in main memory
+    public convenience init(
+        buffer: ImageBuffer,
+        imageType: ImageType,
+        originalMinValue: Float = 0.0,
+        originalMaxValue: Float = 1.0,
+        processingHistory: [ProcessingStep] = [],
+        fitsImage: FITSImage? = nil,
+        id: String = UUID().uuidString,
+        name: String = "Processed Image"
+    ) {
+        self.init(
+            texture: nil,
+            buffer: buffer,
+            imageType: imageType,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            processingHistory: processingHistory,
+            fitsImage: fitsImage,
+            id: id,
+            name: name
+        )
+    }
+    
+    private convenience init(
+        texture: MTLTexture?,
+        buffer: ImageBuffer?,
+        imageType: ImageType,
+        originalMinValue: Float,
+        originalMaxValue: Float,
+        processingHistory: [ProcessingStep],
+        fitsImage: FITSImage?,
+        id: String,
+        name: String
+    ) {
+        self.init(
+            payload: Payload(texture: texture, buffer: buffer),
+            imageType: imageType,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            processingHistory: processingHistory,
+            fitsImage: fitsImage,
+            id: id,
+            name: name
+        )
+    }
+    
+    private init(
+        payload: Payload,
+        imageType: ImageType,
+        originalMinValue: Float,
+        originalMaxValue: Float,
+        processingHistory: [ProcessingStep],
+        fitsImage: FITSImage?,
+        id: String,
+        name: String
+    ) {
+        self.payload = payload
         self.imageType = imageType
         self.originalMinValue = originalMinValue
         self.originalMaxValue = originalMaxValue
@@ -84,6 +192,8 @@ public class ProcessedImage {
         self.fitsImage = fitsImage
         self.id = id
         self.name = name
+        self.width = payload.buffer?.width ?? payload.texture?.width ?? 0
+        self.height = payload.buffer?.height ?? payload.texture?.height ?? 0
     }
     
     /// Creates a new ProcessedImage by applying a processing step
@@ -94,6 +204,46 @@ public class ProcessedImage {
         newTexture: MTLTexture,
         newImageType: ImageType? = nil,
         newName: String? = nil
+    ) -> ProcessedImage {
+        return withProcessingStep(
+            stepID: stepID,
+            stepName: stepName,
+            parameters: parameters,
+            texture: newTexture,
+            buffer: nil,
+            newImageType: newImageType,
+            newName: newName
+        )
+    }
+    
+    /// Creates a new ProcessedImage by applying a processing step that ran on the CPU
+    public func withProcessingStep(
+        stepID: String,
+        stepName: String,
+        parameters: [String: String] = [:],
+        newBuffer: ImageBuffer,
+        newImageType: ImageType? = nil,
+        newName: String? = nil
+    ) -> ProcessedImage {
+        return withProcessingStep(
+            stepID: stepID,
+            stepName: stepName,
+            parameters: parameters,
+            texture: nil,
+            buffer: newBuffer,
+            newImageType: newImageType,
+            newName: newName
+        )
+    }
+    
+    private func withProcessingStep(
+        stepID: String,
+        stepName: String,
+        parameters: [String: String],
+        texture: MTLTexture?,
+        buffer: ImageBuffer?,
+        newImageType: ImageType?,
+        newName: String?
     ) -> ProcessedImage {
         let nextOrder = processingHistory.count
         let newStep = ProcessingStep(
@@ -104,7 +254,8 @@ public class ProcessedImage {
         )
         
         return ProcessedImage(
-            texture: newTexture,
+            texture: texture,
+            buffer: buffer,
             imageType: newImageType ?? imageType,
             originalMinValue: originalMinValue,
             originalMaxValue: originalMaxValue,
@@ -115,6 +266,20 @@ public class ProcessedImage {
         )
     }
     
+    /// Creates a copy of this image with the same pixels and a different processing history
+    public func withProcessingHistory(_ history: [ProcessingStep]) -> ProcessedImage {
+        return ProcessedImage(
+            payload: payload,
+            imageType: imageType,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            processingHistory: history,
+            fitsImage: fitsImage,
+            id: id,
+            name: name
+        )
+    }
+    
     /// Checks if this image has been processed with a specific step and parameters
     public func hasProcessingStep(stepID: String, parameters: [String: String]? = nil) -> Bool {
         if let params = parameters {
@@ -137,11 +302,15 @@ public class ProcessedImage {
         device: MTLDevice,
         pixelFormat: MTLPixelFormat = .r32Float
     ) throws -> ProcessedImage {
-        let texture = try fitsImage.createMetalTexture(device: device, pixelFormat: pixelFormat)
+        // Grayscale images keep the normalized FITS pixels as their buffer and share them with the texture
+        let buffer: ImageBuffer? = pixelFormat == .r32Float ? ImageBuffer(fitsImage: fitsImage) : nil
+        let texture = try buffer?.makeMetalTexture(device: device)
+            ?? fitsImage.createMetalTexture(device: device, pixelFormat: pixelFormat)
         let imageType: ImageType = pixelFormat == .rgba32Float ? .rgba : .grayscale
         
         return ProcessedImage(
             texture: texture,
+            buffer: buffer,
             imageType: imageType,
             originalMinValue: fitsImage.originalMinValue,
             originalMaxValue: fitsImage.originalMaxValue,
@@ -151,6 +320,131 @@ public class ProcessedImage {
             name: "Original Image"
         )
     }
+    
+    /// Creates a ProcessedImage for the CPU backend from the normalized pixels of a FITSImage
+    public static func fromFITSImage(_ fitsImage: FITSImage) -> ProcessedImage {
+        return ProcessedImage(
+            buffer: ImageBuffer(fitsImage: fitsImage),
+            imageType: .grayscale,
+            originalMinValue: fitsImage.originalMinValue,
+            originalMaxValue: fitsImage.originalMaxValue,
+            processingHistory: [],
+            fitsImage: fitsImage,
+            id: UUID().uuidString,
+            name: "Original Image"
+        )
+    }
+    
+    /// Returns the image as a Metal texture, creating one from the pixel buffer the first time
+    /// - Parameter device: The Metal device for the new texture
+    /// - Returns: A `.r32Float` or `.rgba32Float` texture
+    /// - Throws: PipelineStepError if the texture cannot be created
+    public func metalTexture(device: MTLDevice) throws -> MTLTexture {
+        payload.lock.lock()
+        defer { payload.lock.unlock() }
+        if let texture = payload.texture {
+            return texture
+        }
+        guard let buffer = payload.buffer else {
+            throw PipelineStepError.couldNotCreateResource("texture for image without pixels")
+        }
+        let texture = try buffer.makeMetalTexture(device: device)
+        payload.texture = texture
+        return texture
+    }
+    
+    /// Returns the pixels in main memory, reading back the texture the first time
+    /// - Parameter commandQueue: Queue used for the read back (default: a new queue on the texture's device)
+    /// - Returns: The pixel buffer (1 channel, or 4 for RGBA textures)
+    /// - Throws: PipelineStepError if the texture cannot be read back
+    public func pixelBuffer(commandQueue: MTLCommandQueue? = nil) throws -> ImageBuffer {
+        payload.lock.lock()
+        defer { payload.lock.unlock() }
+        if let buffer = payload.buffer {
+            return buffer
+        }
+        guard let texture = payload.texture else {
+            throw PipelineStepError.couldNotCreateResource("pixel buffer for image without pixels")
+        }
+        let buffer = try ProcessedImage.readBack(texture, commandQueue: commandQueue, name: name)
+        payload.buffer = buffer
+        return buffer
+    }
+    
+    /// Copies a texture into a new pixel buffer
+    private static func readBack(_ texture: MTLTexture, commandQueue: MTLCommandQueue?, name: String) throws -> ImageBuffer {
+        let channels: Int
+        switch texture.pixelFormat {
+        case .r32Float:
+            channels = 1
+        case .rgba32Float:
+            channels = 4
+        default:
+            throw PipelineStepError.invalidInputType(name, expected: "r32Float or rgba32Float texture")
+        }
+        
+        let output = ImageBuffer(width: texture.width, height: texture.height, channels: channels)
+        let device = texture.device
+        let bytesPerRow = output.rowStride * MemoryLayout<Float32>.stride
+        let bufferSize = bytesPerRow * texture.height
+        
+        // With unified memory the blit writes straight into the output's store
+        let pageSize = Int(getpagesize())
+        let store = output.store
+        let sharedBuffer = device.hasUnifiedMemory
+            && Int(bitPattern: store.pointer) % pageSize == 0
+            && store.allocatedByteCount % pageSize == 0
+            && store.allocatedByteCount >= bufferSize
+            ? device.makeBuffer(bytesNoCopy: store.pointer, length: store.allocatedByteCount,
+                                options: [.storageModeShared], deallocator: { _, _ in withExtendedLifetime(store) {} })
+            : nil
+        
+        guard let commandQueue = commandQueue ?? device.makeCommandQueue(),
+              let readBuffer = sharedBuffer ?? device.makeBuffer(length: bufferSize, options: [.storageModeShared]),
+              let commandBuffer = commandQueue.makeCommandBuffer(),
+              let blitEncoder = commandBuffer.makeBlitCommandEncoder() else {
+            throw PipelineStepError.couldNotCreateResource("texture read back")
+        }
+        
+        blitEncoder.copy(
+            from: texture,
+            sourceSlice: 0,
+            sourceLevel: 0,
+            sourceOrigin: MTLOrigin(x: 0, y: 0, z: 0),
+            sourceSize: MTLSize(width: texture.width, height: texture.height, depth: 1),
+            to: readBuffer,
+            destinationOffset: 0,
+            destinationBytesPerRow: bytesPerRow,
+            destinationBytesPerImage: bufferSize
+        )
+        blitEncoder.endEncoding()
+        commandBuffer.commit()
+        commandBuffer.waitUntilCompleted()
+        
+        if let error = commandBuffer.error {
+            throw PipelineStepError.executionFailed("Failed to read texture: \(error.localizedDescription)")
+        }
+        if sharedBuffer == nil {
+            let rowLength = texture.width * channels
+            let source = readBuffer.contents().bindMemory(to: Float32.self, capacity: output.rowStride * texture.height)
+            for y in 0..<texture.height {
+                output.row(y).update(from: source + y * output.rowStride, count: rowLength)
+            }
+        }
+        return output
+    }
+    
+    /// Holds the pixel buffer and texture of an image; images with the same pixels share it
+    private final class Payload {
+        let lock = NSLock()
+        var texture: MTLTexture?
+        var buffer: ImageBuffer?
+        
+        init(texture: MTLTexture?, buffer: ImageBuffer?) {
+            self.texture = texture
+            self.buffer = buffer
+        }
+    }
 }
 
 /// Extension to help with image type detection
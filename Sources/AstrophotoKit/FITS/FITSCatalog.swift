@@ -0,0 +1,256 @@
+import Foundation
+import os
+
+/// Header summary of one image HDU, as collected by `FITSCatalogScanner`
+public struct FITSCatalogEntry: Codable, Equatable {
+    /// Path of the FITS file
+    public let path: String
+
+    /// HDU number (0 = primary)
+    public let hdu: Int
+
+    /// Image dimensions
+    public let width: Int
+    public let height: Int
+    public let depth: Int
+
+    /// BITPIX of the image (ZBITPIX for tile-compressed images)
+    public let bitpix: Int
+
+    /// Exposure time in seconds (EXPTIME or EXPOSURE)
+    public let exposureTime: Double?
+
+    /// Filter name (FILTER)
+    public let filter: String?
+
+    /// Observation start (DATE-OBS), as written in the header
+    public let dateObs: String?
+
+    /// Sensor temperature in °C (CCD-TEMP)
+    public let ccdTemperature: Double?
+
+    /// Sensor gain (GAIN)
+    public let gain: Double?
+}
+
+/// Scans FITS headers of many files in parallel without reading any pixel data
+///
+/// Files are scanned concurrently across all cores while the number of simultaneously open
+/// CFITSIO handles is bounded by `maxOpenFiles`. When an index file is configured, files whose
+/// modification date and size are unchanged since the previous scan are not opened at all.
+public final class FITSCatalogScanner {
+    /// Maximum number of files that are open at the same time
+    public let maxOpenFiles: Int
+
+    /// Location of the on-disk index, or nil to always scan every file
+    public let indexURL: URL?
+
+    /// Per-file record in the on-disk index
+    private struct IndexRecord: Codable {
+        let modificationDate: Double
+        let fileSize: Int
+        let entries: [FITSCatalogEntry]
+    }
+
+    /// Creates a scanner
+    /// - Parameters:
+    ///   - maxOpenFiles: Maximum number of simultaneously open files (default: number of active cores)
+    ///   - indexURL: Optional JSON index that is reused and updated incrementally
+    public init(maxOpenFiles: Int = ProcessInfo.processInfo.activeProcessorCount, indexURL: URL? = nil) {
+        self.maxOpenFiles = max(1, maxOpenFiles)
+        self.indexURL = indexURL
+    }
+
+    /// Scans all FITS files (.fits, .fit, .fts) in a directory
+    /// - Parameters:
+    ///   - directory: The directory to scan
+    ///   - recursive: Whether to descend into subdirectories (default: false)
+    /// - Returns: One entry per image HDU, ordered by path and HDU
+    public func scan(directory: URL, recursive: Bool = false) throws -> [FITSCatalogEntry] {
+        let extensions: Set<String> = ["fits", "fit", "fts"]
+        let fileManager = FileManager.default
+        var paths: [String] = []
+
+        if recursive {
+            let enumerator = fileManager.enumerator(at: directory, includingPropertiesForKeys: nil)
+            while let url = enumerator?.nextObject() as? URL {
+                if extensions.contains(url.pathExtension.lowercased()) {
+                    paths.append(url.path)
+                }
+            }
+        } else {
+            let urls = try fileManager.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)
+            paths = urls.filter { extensions.contains($0.pathExtension.lowercased()) }.map { $0.path }
+        }
+
+        return try scan(paths: paths.sorted())
+    }
+
+    /// Scans the headers of the given files
+    ///
+    /// Files that cannot be opened or parsed are logged and skipped. Index records of files
+    /// that no longer exist are dropped; failing to write the index is logged and does not
+    /// fail the scan.
+    /// - Parameter paths: Paths of the FITS files
+    /// - Returns: One entry per image HDU, in the order of `paths`
+    public func scan(paths: [String]) throws -> [FITSCatalogEntry] {
+        var index = loadIndex()
+        var results = [[FITSCatalogEntry]](repeating: [], count: paths.count)
+        var records = [IndexRecord?](repeating: nil, count: paths.count)
+        var nextPath = 0
+        let resultsLock = NSLock()
+
+        // One worker per allowed open file; each takes the next unscanned path until none are left
+        DispatchQueue.concurrentPerform(iterations: min(maxOpenFiles, max(1, paths.count))) { _ in
+            while true {
+                resultsLock.lock()
+                let i = nextPath
+                nextPath += 1
+                resultsLock.unlock()
+                guard i < paths.count else {
+                    return
+                }
+
+                let path = paths[i]
+                let attributes = try? FileManager.default.attributesOfItem(atPath: path)
+                let modificationDate = (attributes?[.modificationDate] as? Date)?.timeIntervalSince1970 ?? 0
+                let fileSize = (attributes?[.size] as? NSNumber)?.intValue ?? 0
+
+                if let record = index[path], record.modificationDate == modificationDate, record.fileSize == fileSize {
+                    resultsLock.lock()
+                    results[i] = record.entries
+                    resultsLock.unlock()
+                    continue
+                }
+
+                do {
+                    let entries = try FITSCatalogScanner.scanFile(path: path)
+                    resultsLock.lock()
+                    results[i] = entries
+                    records[i] = IndexRecord(modificationDate: modificationDate, fileSize: fileSize, entries: entries)
+                    resultsLock.unlock()
+                } catch {
+                    Logger.swiftfitsio.warning("Skipping \(path) in catalog scan: \(error.localizedDescription)")
+                }
+            }
+        }
+
+        let missing = index.keys.filter { !FileManager.default.fileExists(atPath: $0) }
+        for path in missing {
+            index[path] = nil
+        }
+
+        let updated = records.indices.filter { records[$0] != nil }
+        for i in updated {
+            index[paths[i]] = records[i]
+        }
+        if !updated.isEmpty || !missing.isEmpty {
+            do {
+                try saveIndex(index)
+            } catch {
+                Logger.swiftfitsio.error("Failed to write catalog index: \(error.localizedDescription)")
+            }
+        }
+
+        Logger.swiftfitsio.debug("Catalog scan of \(paths.count) files: \(updated.count) scanned, \(paths.count - updated.count) from index or skipped, \(missing.count) missing pruned")
+
+        return results.flatMap { $0 }
+    }
+
+    /// Reads the image HDU summaries of a single file
+    ///
+    /// Only header cards are read; the data units are never touched.
+    static func scanFile(path: String) throws -> [FITSCatalogEntry] {
+        let file = try FITSFile(path: path)
+        var entries: [FITSCatalogEntry] = []
+
+        for hdu in 0..<(try file.numberOfHDUs()) {
+            try file.moveToHDU(hdu)
+            let header = FITSHeader(table: try file.readKeywordTable())
+
+            // Tile-compressed images are stored in binary tables and describe the image with Z keywords
+            let compressed = header["ZIMAGE"]?.boolValue == true
+            if !compressed, let xtension = header["XTENSION"]?.stringValue, xtension != "IMAGE" {
+                continue
+            }
+            let prefix = compressed ? "Z" : ""
+            guard let naxis = header[prefix + "NAXIS"]?.intValue, naxis > 0,
+                  let bitpix = header[prefix + "BITPIX"]?.intValue else {
+                continue
+            }
+
+            func axis(_ n: Int) -> Int {
+                return n <= naxis ? Int(header[prefix + "NAXIS\(n)"]?.intValue ?? 1) : 1
+            }
+
+            entries.append(FITSCatalogEntry(
+                path: path,
+                hdu: hdu,
+                width: axis(1),
+                height: axis(2),
+                depth: axis(3),
+                bitpix: Int(bitpix),
+                exposureTime: number(header, "EXPTIME") ?? number(header, "EXPOSURE"),
+                filter: header["FILTER"]?.stringValue,
+                dateObs: header["DATE-OBS"]?.stringValue,
+                ccdTemperature: number(header, "CCD-TEMP"),
+                gain: number(header, "GAIN")
+            ))
+        }
+
+        return entries
+    }
+
+    /// Returns a numeric keyword as Double, accepting both integer and floating point values
+    private static func number(_ header: FITSHeader, _ keyword: String) -> Double? {
+        switch header[keyword] {
+        case .integer(let value): return Double(value)
+        case .floatingPoint(let value): return value
+        default: return nil
+        }
+    }
+
+    /// Converts catalog entries to a columnar table
+    ///
+    /// Each column is stored under its name as an array with one element per entry; optional
+    /// keywords are `[Double?]` / `[String?]` columns. `row_count` holds the number of rows.
+    /// - Parameter entries: The catalog entries
+    /// - Returns: A table named "FITS Catalog"
+    public static func table(from entries: [FITSCatalogEntry]) -> ProcessedTable {
+        let data: [String: Any] = [
+            "path": entries.map { $0.path },
+            "hdu": entries.map { $0.hdu },
+            "width": entries.map { $0.width },
+            "height": entries.map { $0.height },
+            "depth": entries.map { $0.depth },
+            "bitpix": entries.map { $0.bitpix },
+            "exptime": entries.map { $0.exposureTime },
+            "filter": entries.map { $0.filter },
+            "date_obs": entries.map { $0.dateObs },
+            "ccd_temp": entries.map { $0.ccdTemperature },
+            "gain": entries.map { $0.gain },
+            "row_count": entries.count
+        ]
+        return ProcessedTable(data: data, name: "FITS Catalog")
+    }
+
+    private func loadIndex() -> [String: IndexRecord] {
+        guard let indexURL = indexURL, let data = try? Data(contentsOf: indexURL) else {
+            return [:]
+        }
+        do {
+            return try JSONDecoder().decode([String: IndexRecord].self, from: data)
+        } catch {
+            Logger.swiftfitsio.warning("Ignoring unreadable catalog index at \(indexURL.path): \(error.localizedDescription)")
+            return [:]
+        }
+    }
+
+    private func saveIndex(_ index: [String: IndexRecord]) throws {
+        guard let indexURL = indexURL else {
+            return
+        }
+        let data = try JSONEncoder().encode(index)
+        try data.write(to: indexURL, options: .atomic)
+    }
+}
@@ -0,0 +1,262 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("apk_checksum_accumulate")
+func accumulateChecksum(_ data: UnsafeRawPointer?, _ length: Int, _ sum: UInt32) -> UInt32
+
+@_silgen_name("apk_checksum_combine")
+func combineChecksums(_ a: UInt32, _ b: UInt32) -> UInt32
+
+@_silgen_name("fits_verify_chksum_wrapper")
+func verifyChecksumWithCFITSIO(_ fptr: OpaquePointer?, _ dataStatus: UnsafeMutablePointer<Int32>, _ hduStatus: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_update_chksum_wrapper")
+func updateChecksumKeyword(_ fptr: OpaquePointer?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_update_key_str_wrapper")
+func updateStringKeyword(_ fptr: OpaquePointer?, _ keyname: UnsafePointer<CChar>?, _ value: UnsafePointer<CChar>?, _ comment: UnsafePointer<CChar>?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_flush_file_wrapper")
+func flushFITSFile(_ fptr: OpaquePointer?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+/// Result of verifying the checksums of one HDU
+public struct FITSChecksumResult: Equatable {
+    /// State of a checksum keyword
+    public enum Status: Equatable {
+        /// The keyword matches the data
+        case valid
+        /// The keyword does not match the data
+        case invalid
+        /// The keyword is not present
+        case missing
+    }
+
+    /// The HDU number (0 = primary)
+    public let hdu: Int
+
+    /// State of DATASUM, the checksum of the data unit
+    public let dataStatus: Status
+
+    /// State of CHECKSUM, the checksum of the whole HDU
+    public let hduStatus: Status
+
+    /// True unless a checksum keyword is present and wrong
+    public var isValid: Bool {
+        dataStatus != .invalid && hduStatus != .invalid
+    }
+}
+
+/// Extension to FITSFile for verifying and writing FITS checksums (CHECKSUM / DATASUM)
+extension FITSFile {
+    /// Size of the chunks that are summed in parallel: 2048 FITS blocks (about 5.6 MiB)
+    static let checksumChunkSize = 2880 * 2048
+
+    /// Verifies the CHECKSUM and DATASUM keywords of every HDU
+    ///
+    /// The file is mapped and each data unit is summed in chunks on all cores. Files that
+    /// cannot be mapped (e.g. gzip-compressed files) are verified by CFITSIO instead.
+    /// The current HDU is not changed.
+    /// - Parameter maxConcurrency: Maximum number of chunks summed at the same time (default: number of active cores)
+    /// - Returns: One result per HDU, in file order
+    /// - Throws: An error if the HDUs cannot be read
+    public func verifyChecksums(maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws -> [FITSChecksumResult] {
+        let scanner = try openAnotherHandle()
+        var results: [FITSChecksumResult] = []
+
+        let mapped = try withRawFileBytes { bytes in
+            for hdu in 0..<(try scanner.numberOfHDUs()) {
+                try scanner.moveToHDU(hdu)
+                let (headStart, dataStart, dataEnd) = try scanner.hduAddress()
+                let table = try scanner.readKeywordTable()
+
+                let dataSum = FITSFile.checksum(of: UnsafeRawBufferPointer(rebasing: bytes[dataStart..<dataEnd]), maxConcurrency: maxConcurrency)
+                let headerSum = FITSFile.checksum(of: UnsafeRawBufferPointer(rebasing: bytes[headStart..<dataStart]), maxConcurrency: 1)
+                let hduSum = combineChecksums(headerSum, dataSum)
+
+                // DATASUM holds the unsigned sum as a decimal string; the CHECKSUM value makes
+                // the sum of the whole HDU negative zero in ones' complement
+                var dataStatus = FITSChecksumResult.Status.missing
+                if let value = table.value(for: "DATASUM") {
+                    let expected = value.stringValue.flatMap { UInt32($0.trimmingCharacters(in: .whitespaces)) }
+                    dataStatus = expected == dataSum ? .valid : .invalid
+                }
+                let hduStatus: FITSChecksumResult.Status = table.value(for: "CHECKSUM") == nil
+                    ? .missing
+                    : (hduSum == 0xFFFF_FFFF || hduSum == 0 ? .valid : .invalid)
+
+                results.append(FITSChecksumResult(hdu: hdu, dataStatus: dataStatus, hduStatus: hduStatus))
+            }
+        }
+
+        if mapped == nil {
+            Logger.swiftfitsio.debug("Verifying checksums of \(self.path) with CFITSIO")
+            results = try verifyChecksumsWithCFITSIO(scanner)
+        }
+        return results
+    }
+
+    /// Writes DATASUM and CHECKSUM keywords for HDUs of a file opened for writing
+    ///
+    /// The data sums are computed in parallel from the file on disk; CFITSIO then only
+    /// sums the header to update CHECKSUM.
+    /// - Parameters:
+    ///   - hduNumbers: HDUs to update (nil = all HDUs)
+    ///   - maxConcurrency: Maximum number of chunks summed at the same time (default: number of active cores)
+    /// - Throws: An error if the file cannot be mapped or the keywords cannot be written
+    public func writeChecksums(hduNumbers: [Int]? = nil, maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        guard memoryBuffer == nil else {
+            throw FITSFileError.writeError(status: -1, message: "Files opened from memory are read-only")
+        }
+
+        func check(_ status: Int32, _ action: String) throws {
+            guard status == 0 else {
+                let errorString = FITSFile.errorMessage(for: status)
+                Logger.swiftfitsio.error("Error \(action): status \(status), \(errorString)")
+                throw FITSFileError.writeError(status: status, message: errorString)
+            }
+        }
+
+        let originalHDU = try currentHDU()
+        var status: Int32 = 0
+        for hdu in try hduNumbers ?? Array(0..<numberOfHDUs()) {
+            // Flush first so that the mapped file matches what CFITSIO has written; updating
+            // an earlier header may have moved this HDU
+            _ = flushFITSFile(file, &status)
+            try check(status, "flushing before summing HDU \(hdu)")
+            try moveToHDU(hdu)
+            let (_, dataStart, dataEnd) = try hduAddress()
+            let mapped = try withRawFileBytes { bytes in
+                FITSFile.checksum(of: UnsafeRawBufferPointer(rebasing: bytes[dataStart..<dataEnd]), maxConcurrency: maxConcurrency)
+            }
+            guard let dataSum = mapped else {
+                throw FITSFileError.writeError(status: -1, message: "Checksums can only be written to uncompressed disk files")
+            }
+
+            _ = updateStringKeyword(file, "DATASUM", String(dataSum), "data unit checksum", &status)
+            _ = updateChecksumKeyword(file, &status)
+            try check(status, "writing checksums of HDU \(hdu)")
+        }
+        _ = flushFITSFile(file, &status)
+        try check(status, "flushing checksums")
+        try moveToHDU(originalHDU)
+    }
+
+    /// Computes the ones' complement checksum of a word-aligned byte range
+    /// - Parameters:
+    ///   - bytes: The bytes to sum; the length must be a multiple of 4
+    ///   - maxConcurrency: Maximum number of chunks summed at the same time
+    /// - Returns: The 32-bit ones' complement sum
+    static func checksum(of bytes: UnsafeRawBufferPointer, maxConcurrency: Int) -> UInt32 {
+        let chunkCount = (bytes.count + checksumChunkSize - 1) / checksumChunkSize
+        guard chunkCount > 1, maxConcurrency > 1 else {
+            return accumulateChecksum(bytes.baseAddress, bytes.count, 0)
+        }
+
+        // Workers take every workerCount-th chunk; partial sums can be combined in any order
+        let workerCount = min(chunkCount, maxConcurrency)
+        let lock = NSLock()
+        var sum: UInt32 = 0
+        DispatchQueue.concurrentPerform(iterations: workerCount) { worker in
+            var partial: UInt32 = 0
+            for chunk in stride(from: worker, to: chunkCount, by: workerCount) {
+                let start = chunk * checksumChunkSize
+                let length = min(checksumChunkSize, bytes.count - start)
+                partial = accumulateChecksum(bytes.baseAddress! + start, length, partial)
+            }
+            lock.lock()
+            sum = combineChecksums(sum, partial)
+            lock.unlock()
+        }
+        return sum
+    }
+
+    /// Returns the header start, data start and data end offsets of the current HDU
+    private func hduAddress() throws -> (headStart: Int, dataStart: Int, dataEnd: Int) {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        var status: Int32 = 0
+        var headStart: Int64 = 0
+        var dataStart: Int64 = 0
+        var dataEnd: Int64 = 0
+        _ = getHDUAddress(file, &headStart, &dataStart, &dataEnd, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error getting HDU layout: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+        return (Int(headStart), Int(dataStart), Int(dataEnd))
+    }
+
+    /// Calls `body` with the raw bytes of the whole file, mapped from disk or from memory
+    /// - Returns: The result of `body`, or nil if the file is not a plain FITS file that can be mapped
+    private func withRawFileBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) throws -> R? {
+        if let buffer = memoryBuffer {
+            guard buffer.count >= 6, memcmp(buffer.baseAddress!, "SIMPLE", 6) == 0 else {
+                return nil
+            }
+            return try body(buffer)
+        }
+        return try withMappedFile(path: path, body)
+    }
+
+    /// Verifies all HDUs with CFITSIO's single-threaded checksum routine
+    private func verifyChecksumsWithCFITSIO(_ scanner: FITSFile) throws -> [FITSChecksumResult] {
+        guard let file = scanner.fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        func checksumStatus(_ value: Int32) -> FITSChecksumResult.Status {
+            value > 0 ? .valid : (value < 0 ? .invalid : .missing)
+        }
+
+        return try (0..<scanner.numberOfHDUs()).map { hdu in
+            try scanner.moveToHDU(hdu)
+            var status: Int32 = 0
+            var dataStatus: Int32 = 0
+            var hduStatus: Int32 = 0
+            _ = verifyChecksumWithCFITSIO(file, &dataStatus, &hduStatus, &status)
+            guard status == 0 else {
+                let errorString = FITSFile.errorMessage(for: status)
+                throw FITSFileError.readError(status: status, message: errorString)
+            }
+            return FITSChecksumResult(hdu: hdu, dataStatus: checksumStatus(dataStatus), hduStatus: checksumStatus(hduStatus))
+        }
+    }
+}
+
+/// Maps a whole file read-only and calls `body` with its bytes
+/// - Returns: The result of `body`, or nil if the file is not a plain (uncompressed) FITS file
+private func withMappedFile<R>(path: String, _ body: (UnsafeRawBufferPointer) throws -> R) throws -> R? {
+    let descriptor = open(path, O_RDONLY)
+    guard descriptor >= 0 else {
+        let message = String(cString: strerror(errno))
+        throw FITSFileError.cannotOpenFile(path: path, status: -1, message: message)
+    }
+    defer { close(descriptor) }
+
+    var fileStatus = stat()
+    guard fstat(descriptor, &fileStatus) == 0, fileStatus.st_size >= 6 else {
+        return nil
+    }
+    let length = Int(fileStatus.st_size)
+    guard let mapping = mmap(nil, length, PROT_READ, MAP_PRIVATE, descriptor, 0),
+          mapping != UnsafeMutableRawPointer(bitPattern: -1) else {
+        let message = String(cString: strerror(errno))
+        Logger.swiftfitsio.error("Failed to map FITS file at \(path): \(message)")
+        throw FITSFileError.readError(status: -1, message: message)
+    }
+    defer { munmap(mapping, length) }
+
+    // Offsets of gzip-compressed files refer to the decompressed stream
+    guard memcmp(mapping, "SIMPLE", 6) == 0 else {
+        return nil
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL)
+    return try body(UnsafeRawBufferPointer(start: mapping, count: length))
+}
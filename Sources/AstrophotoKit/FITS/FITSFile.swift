@@ -13,12 +13,37 @@ func closeFITSFile(_ fptr: OpaquePointer?, _ status: UnsafeMutablePointer<Int32>
 @_silgen_name("fits_get_num_hdus_wrapper")
 func getNumberOfHDUs(_ fptr: OpaquePointer?, _ numhdus: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
 
+@_silgen_name("fits_create_file_wrapper")
+func createFITSFile(_ fptr: UnsafeMutablePointer<OpaquePointer?>, _ filename: UnsafePointer<CChar>?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_open_memfile_wrapper")
+func openFITSMemoryFile(_ fptr: UnsafeMutablePointer<OpaquePointer?>, _ name: UnsafePointer<CChar>?, _ buffer: UnsafeRawPointer?, _ size: Int, _ handle: UnsafeMutablePointer<UnsafeMutableRawPointer?>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_free_memfile_handle_wrapper")
+func freeFITSMemoryFileHandle(_ handle: UnsafeMutableRawPointer?)
+
 @_silgen_name("fits_get_errstatus_wrapper")
 func getFITSErrorStatus(_ status: Int32, _ errText: UnsafeMutablePointer<CChar>)
 
 /// A Swift wrapper for FITS file operations using CFITSIO
 public class FITSFile {
     internal var fitsfile: OpaquePointer?
+
+    /// The path the file was opened from
+    public let path: String
+
+    /// Largest single pixel allocation, in bytes, that whole-image reads may make
+    ///
+    /// Reads that would need more throw `FITSFileError.allocationTooLarge`; use the
+    /// row-chunk reader or `readPixels(at:count:into:)` to process such images in pieces.
+    public var maxAllocationBytes: Int = FITSFile.defaultMaxAllocationBytes
+
+    /// The buffer of a file opened from memory, and the object that keeps it alive
+    internal private(set) var memoryBuffer: UnsafeRawBufferPointer?
+    private var memoryOwner: AnyObject?
+
+    /// Buffer pointer and size that CFITSIO's memory driver refers to while the file is open
+    private var memoryHandle: UnsafeMutableRawPointer?
     
     /// Opens a FITS file for reading or writing
     /// - Parameters:
@@ -48,12 +73,118 @@ public class FITSFile {
         Logger.swiftfitsio.debug("Opened FITS file at \(path)")
         
         self.fitsfile = file
+        self.path = path
+    }
+    
+    /// Creates a new, empty FITS file for writing
+    /// - Parameters:
+    ///   - path: The file path of the new FITS file
+    ///   - overwrite: Whether an existing file at `path` is replaced (default: true)
+    /// - Throws: An error if the file cannot be created
+    public init(creating path: String, overwrite: Bool = true) throws {
+        var status: Int32 = 0
+        var fitsfilePtr: OpaquePointer?
+        
+        // CFITSIO replaces an existing file when the name starts with '!'
+        let cPath = ((overwrite ? "!" : "") + path).cString(using: .utf8)
+        
+        _ = createFITSFile(&fitsfilePtr, cPath, &status)
+        
+        guard status == 0, let file = fitsfilePtr else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Failed to create FITS file at \(path): status \(status), \(errorString)")
+            throw FITSFileError.cannotOpenFile(path: path, status: status, message: errorString)
+        }
+        
+        Logger.swiftfitsio.debug("Created FITS file at \(path)")
+        
+        self.fitsfile = file
+        self.path = path
+    }
+    
+    /// Opens a FITS file held in memory, without copying it
+    ///
+    /// The buffer is read in place through CFITSIO's memory driver and all read operations
+    /// work as for files on disk. The caller must keep the buffer alive and unchanged for as
+    /// long as the file (and any image views that map it) is in use; `init(data:name:)`
+    /// takes care of this for `Data`.
+    /// - Parameters:
+    ///   - buffer: The complete contents of a FITS file
+    ///   - name: A name for the file in log and error messages (default: "memory")
+    /// - Throws: An error if the buffer is not a valid FITS file
+    public convenience init(buffer: UnsafeRawBufferPointer, name: String = "memory") throws {
+        try self.init(buffer: buffer, path: "mem://\(name)", owner: nil)
+    }
+
+    /// Opens a FITS file held in a `Data` value, without copying it
+    ///
+    /// The data is bridged to `NSData`, whose bytes stay at a fixed address while the file
+    /// holds on to it.
+    /// - Parameters:
+    ///   - data: The complete contents of a FITS file
+    ///   - name: A name for the file in log and error messages (default: "memory")
+    /// - Throws: An error if the data is not a valid FITS file
+    public convenience init(data: Data, name: String = "memory") throws {
+        let object = data as NSData
+        try self.init(buffer: UnsafeRawBufferPointer(start: object.bytes, count: object.length), path: "mem://\(name)", owner: object)
+    }
+
+    private init(buffer: UnsafeRawBufferPointer, path: String, owner: AnyObject?) throws {
+        var status: Int32 = 0
+        var fitsfilePtr: OpaquePointer?
+        var handle: UnsafeMutableRawPointer?
+        
+        _ = openFITSMemoryFile(&fitsfilePtr, path.cString(using: .utf8), buffer.baseAddress, buffer.count, &handle, &status)
+        
+        guard status == 0, let file = fitsfilePtr else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Failed to open FITS file at \(path): status \(status), \(errorString)")
+            throw FITSFileError.cannotOpenFile(path: path, status: status, message: errorString)
+        }
+        
+        Logger.swiftfitsio.debug("Opened FITS file at \(path) (\(buffer.count) bytes in memory)")
+        
+        self.fitsfile = file
+        self.path = path
+        self.memoryBuffer = buffer
+        self.memoryOwner = owner
+        self.memoryHandle = handle
+    }
+
+    /// Opens a second, independent read-only handle on the same file or memory buffer
+    ///
+    /// Handles have their own current HDU and CFITSIO buffers, so they can be used
+    /// concurrently from different threads.
+    func openAnotherHandle() throws -> FITSFile {
+        if let buffer = memoryBuffer {
+            return try FITSFile(buffer: buffer, path: path, owner: memoryOwner)
+        }
+        return try FITSFile(path: path)
     }
     
     deinit {
+        try? close()
+    }
+    
+    /// Closes the file; for files being written this flushes all pending data
+    ///
+    /// The handle is released even if closing fails. Any later operation on the file throws
+    /// `FITSFileError.fileNotOpen`.
+    /// - Throws: An error if CFITSIO reports a failure, e.g. while flushing buffered writes
+    public func close() throws {
+        var status: Int32 = 0
         if let file = fitsfile {
-            var status: Int32 = 0
             _ = closeFITSFile(file, &status)
+            fitsfile = nil
+        }
+        if let handle = memoryHandle {
+            freeFITSMemoryFileHandle(handle)
+            memoryHandle = nil
+        }
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error closing \(self.path): status \(status), \(errorString)")
+            throw FITSFileError.writeError(status: status, message: errorString)
         }
     }
     
@@ -79,6 +210,17 @@ public class FITSFile {
         
         return Int(numHDUs)
     }
+
+    /// Converts a CFITSIO status code into its error message
+    /// - Parameter status: The CFITSIO status code
+    /// - Returns: The error text reported by CFITSIO
+    static func errorMessage(for status: Int32) -> String {
+        // CFITSIO uses FLEN_ERRMSG (81) for error messages
+        var errorText = [CChar](repeating: 0, count: 81)
+        getFITSErrorStatus(status, &errorText)
+        errorText[80] = 0
+        return String(cString: errorText)
+    }
 }
 
 /// Errors that can occur when working with FITS files
@@ -87,6 +229,8 @@ public enum FITSFileError: Error, LocalizedError {
     case fileNotOpen
     case readError(status: Int32, message: String)
     case unsupportedDataType(bitpix: Int32)
+    case allocationTooLarge(bytes: Int, limit: Int)
+    case writeError(status: Int32, message: String)
     
     public var errorDescription: String? {
         switch self {
@@ -98,6 +242,10 @@ public enum FITSFileError: Error, LocalizedError {
             return "Error reading FITS file: status \(status), \(message)"
         case .unsupportedDataType(let bitpix):
             return "Unsupported data type: bitpix = \(bitpix)"
+        case .writeError(let status, let message):
+            return "Error writing FITS file: status \(status), \(message)"
+        case .allocationTooLarge(let bytes, let limit):
+            return "Image needs \(bytes) bytes, more than the allocation limit of \(limit) bytes"
         }
     }
 }
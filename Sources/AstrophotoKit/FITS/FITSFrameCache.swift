@@ -0,0 +1,434 @@
+import Foundation
+import os
+
+/// A process-wide cache of decoded FITS frames with a byte budget
+///
+/// Frames are keyed by path, HDU, modification time, file size and pixel type, so a file
+/// that changes on disk is decoded again. When the cached frames exceed `byteBudget`, the
+/// least recently used ones are evicted. If a `spillDirectory` is set, evicted Float32
+/// frames are written there as raw Float32 buffers and read back on the next request, which
+/// is much cheaper than decoding a compressed or scaled integer file again. Spilled frames
+/// are limited to `spillByteBudget`, oldest first, and dropped once their file changes.
+///
+/// Frames larger than `byteBudget` are returned without being cached or spilled.
+public final class FITSFrameCache {
+    /// The shared cache used by the app and the batch tools
+    public static let shared = FITSFrameCache()
+
+    /// The form in which a frame is cached
+    public enum PixelType: Hashable {
+        /// Float32 images, as returned by `FITSFile.readFITSImage(hduNumber:)`
+        case normalizedFloat32
+        /// Pixels in their stored type, as returned by `FITSFile.readNativeImage()`
+        case native
+    }
+
+    /// Usage counters of a cache
+    public struct Statistics: Equatable {
+        /// Requests served from memory
+        public var hits = 0
+        /// Requests served from the spill directory
+        public var spillHits = 0
+        /// Requests that decoded the file
+        public var misses = 0
+        /// Frames evicted from memory
+        public var evictions = 0
+        /// Evicted frames written to the spill directory
+        public var spills = 0
+        /// Bytes of the frames held in the spill directory
+        public var spillBytes = 0
+        /// Bytes of the frames held in memory
+        public var bytes = 0
+        /// Number of frames held in memory
+        public var entryCount = 0
+    }
+
+    private struct Key: Hashable {
+        let path: String
+        let hdu: Int
+        let modificationTime: TimeInterval
+        let fileSize: Int
+        let pixelType: PixelType
+
+        /// True if `other` is the same HDU in the same form, but of an older or newer version of the file
+        func supersedes(_ other: Key) -> Bool {
+            return path == other.path && hdu == other.hdu && pixelType == other.pixelType && self != other
+        }
+    }
+
+    private enum Frame {
+        case image(FITSImage)
+        case native(FITSNativePixels)
+
+        var byteCount: Int {
+            switch self {
+            case .image(let image):
+                return image.width * image.height * image.depth * MemoryLayout<Float32>.stride
+            case .native(let pixels):
+                return pixels.byteCount
+            }
+        }
+    }
+
+    private struct Entry {
+        let frame: Frame
+        var lastUsed: UInt64
+    }
+
+    private struct SpillFile {
+        let url: URL
+        let byteCount: Int
+        let spilledAt: UInt64
+    }
+
+    /// Maximum number of bytes of decoded frames kept in memory
+    public var byteBudget: Int {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return budget
+        }
+        set {
+            lock.lock()
+            budget = newValue
+            let evicted = evictToBudget()
+            lock.unlock()
+            spill(evicted)
+        }
+    }
+
+    /// Directory that evicted Float32 frames are written to (nil = no spilling)
+    ///
+    /// The directory belongs to this cache: spill files left in it by an earlier process
+    /// are deleted when the cache is created.
+    public let spillDirectory: URL?
+
+    /// Maximum number of bytes of frames kept in the spill directory
+    public let spillByteBudget: Int
+
+    private let lock = NSLock()
+    private var budget: Int
+    private var entries: [Key: Entry] = [:]
+    private var spilled: [Key: SpillFile] = [:]
+    private var tick: UInt64 = 0
+    private var counters = Statistics()
+
+    /// Creates an empty cache
+    /// - Parameters:
+    ///   - byteBudget: Maximum number of bytes kept in memory (default: 2 GiB)
+    ///   - spillDirectory: Directory for evicted frames, not shared with another cache (default: none)
+    ///   - spillByteBudget: Maximum number of bytes kept in the spill directory (default: 8 GiB)
+    public init(byteBudget: Int = 1 << 31, spillDirectory: URL? = nil, spillByteBudget: Int = 1 << 33) {
+        self.budget = byteBudget
+        self.spillDirectory = spillDirectory
+        self.spillByteBudget = spillByteBudget
+        if let directory = spillDirectory {
+            try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+            removeStaleSpills(in: directory)
+        }
+    }
+
+    deinit {
+        for spill in spilled.values {
+            try? FileManager.default.removeItem(at: spill.url)
+        }
+    }
+
+    /// Current usage counters
+    public var statistics: Statistics {
+        lock.lock()
+        defer { lock.unlock() }
+        var statistics = counters
+        statistics.entryCount = entries.count
+        statistics.bytes = entries.values.reduce(0) { $0 + $1.frame.byteCount }
+        statistics.spillBytes = spilled.values.reduce(0) { $0 + $1.byteCount }
+        return statistics
+    }
+
+    /// Returns the image of an HDU, decoding the file only if it is not cached
+    /// - Parameters:
+    ///   - path: The file path to the FITS file
+    ///   - hduNumber: The HDU to read (nil = primary HDU)
+    /// - Returns: The decoded image
+    /// - Throws: An error if the file cannot be read
+    public func image(path: String, hduNumber: Int? = nil) throws -> FITSImage {
+        let key = try makeKey(path: path, hduNumber: hduNumber, pixelType: .normalizedFloat32)
+        if let frame = lookUp(key), case .image(let image) = frame {
+            return image
+        }
+        if let image = restoreSpilled(key) {
+            return image
+        }
+
+        let image = try FITSFile(path: path).readFITSImage(hduNumber: hduNumber)
+        insert(.image(image), for: key)
+        return image
+    }
+
+    /// Returns the native-typed pixels of an HDU, decoding the file only if they are not cached
+    /// - Parameters:
+    ///   - path: The file path to the FITS file
+    ///   - hduNumber: The HDU to read (nil = primary HDU)
+    /// - Returns: The decoded pixels
+    /// - Throws: An error if the file cannot be read
+    public func nativePixels(path: String, hduNumber: Int? = nil) throws -> FITSNativePixels {
+        let key = try makeKey(path: path, hduNumber: hduNumber, pixelType: .native)
+        if let frame = lookUp(key), case .native(let pixels) = frame {
+            return pixels
+        }
+
+        let file = try FITSFile(path: path)
+        if let hdu = hduNumber {
+            try file.moveToHDU(hdu)
+        }
+        let pixels = try file.readNativeImage()
+        insert(.native(pixels), for: key)
+        return pixels
+    }
+
+    /// Removes all frames from memory and the spill directory
+    public func removeAll() {
+        lock.lock()
+        let urls = spilled.values.map(\.url)
+        entries.removeAll()
+        spilled.removeAll()
+        lock.unlock()
+
+        for url in urls {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+
+    /// Builds the cache key of an HDU from the file's current modification time and size
+    private func makeKey(path: String, hduNumber: Int?, pixelType: PixelType) throws -> Key {
+        let attributes = try FileManager.default.attributesOfItem(atPath: path)
+        let modificationDate = attributes[.modificationDate] as? Date ?? .distantPast
+        let fileSize = (attributes[.size] as? NSNumber)?.intValue ?? 0
+        return Key(
+            path: path,
+            hdu: hduNumber ?? 0,
+            modificationTime: modificationDate.timeIntervalSinceReferenceDate,
+            fileSize: fileSize,
+            pixelType: pixelType
+        )
+    }
+
+    /// Returns a cached frame and marks it as most recently used
+    private func lookUp(_ key: Key) -> Frame? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard var entry = entries[key] else {
+            return nil
+        }
+        tick += 1
+        entry.lastUsed = tick
+        entries[key] = entry
+        counters.hits += 1
+        return entry.frame
+    }
+
+    /// Adds a decoded frame and evicts older frames beyond the budget
+    ///
+    /// Frames of older versions of the file are dropped; a frame larger than the budget is not kept.
+    private func insert(_ frame: Frame, for key: Key) {
+        lock.lock()
+        counters.misses += 1
+        let superseded = removeSuperseded(by: key)
+        var evicted: [(Key, Frame)] = []
+        if frame.byteCount <= budget {
+            tick += 1
+            entries[key] = Entry(frame: frame, lastUsed: tick)
+            evicted = evictToBudget()
+        }
+        lock.unlock()
+
+        removeFiles(superseded)
+        spill(evicted)
+    }
+
+    /// Removes the frames and spills of other versions of the key's file; must be called with the lock held
+    /// - Returns: The spill files to delete
+    private func removeSuperseded(by key: Key) -> [URL] {
+        for stale in entries.keys where key.supersedes(stale) {
+            entries[stale] = nil
+        }
+        var urls: [URL] = []
+        for stale in spilled.keys where key.supersedes(stale) {
+            urls.append(spilled.removeValue(forKey: stale)!.url)
+        }
+        return urls
+    }
+
+    /// Removes the oldest spills until the spill budget is met; must be called with the lock held
+    /// - Returns: The spill files to delete
+    private func trimSpills() -> [URL] {
+        var bytes = spilled.values.reduce(0) { $0 + $1.byteCount }
+        var urls: [URL] = []
+        while bytes > spillByteBudget, let oldest = spilled.min(by: { $0.value.spilledAt < $1.value.spilledAt }) {
+            spilled[oldest.key] = nil
+            bytes -= oldest.value.byteCount
+            urls.append(oldest.value.url)
+        }
+        return urls
+    }
+
+    /// Deletes the spill files of an earlier cache, which are never read back
+    ///
+    /// The shared cache lives until the process exits, so its spills are not removed in `deinit`.
+    private func removeStaleSpills(in directory: URL) {
+        let contents = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)) ?? []
+        let stale = contents.filter { $0.pathExtension == "frame" }
+        if !stale.isEmpty {
+            Logger.swiftfitsio.debug("Removing \(stale.count) stale spill files from \(directory.path)")
+        }
+        removeFiles(stale)
+    }
+
+    /// Deletes spill files that are no longer referenced
+    private func removeFiles(_ urls: [URL]) {
+        for url in urls {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+
+    /// Removes least recently used frames until the budget is met; must be called with the lock held
+    private func evictToBudget() -> [(Key, Frame)] {
+        var bytes = entries.values.reduce(0) { $0 + $1.frame.byteCount }
+        var evicted: [(Key, Frame)] = []
+        while bytes > budget, let oldest = entries.min(by: { $0.value.lastUsed < $1.value.lastUsed }) {
+            entries[oldest.key] = nil
+            bytes -= oldest.value.frame.byteCount
+            counters.evictions += 1
+            evicted.append((oldest.key, oldest.value.frame))
+        }
+        return evicted
+    }
+
+    /// Writes evicted Float32 frames to the spill directory
+    private func spill(_ evicted: [(Key, Frame)]) {
+        guard let directory = spillDirectory else {
+            return
+        }
+
+        for (key, frame) in evicted {
+            guard case .image(let image) = frame, frame.byteCount <= min(byteBudget, spillByteBudget) else {
+                continue
+            }
+            let url = directory.appendingPathComponent("\(UUID().uuidString).frame")
+            do {
+                try FITSFrameCache.encode(image).write(to: url)
+            } catch {
+                Logger.swiftfitsio.error("Failed to spill frame of \(key.path): \(error.localizedDescription)")
+                continue
+            }
+
+            lock.lock()
+            tick += 1
+            var stale: [URL] = []
+            if let replaced = spilled.updateValue(SpillFile(url: url, byteCount: frame.byteCount, spilledAt: tick), forKey: key) {
+                stale.append(replaced.url)
+            }
+            counters.spills += 1
+            stale += trimSpills()
+            lock.unlock()
+            removeFiles(stale)
+        }
+    }
+
+    /// Reads a spilled frame back into memory, if there is one for the key
+    private func restoreSpilled(_ key: Key) -> FITSImage? {
+        lock.lock()
+        let url = spilled.removeValue(forKey: key)?.url
+        lock.unlock()
+
+        guard let url = url else {
+            return nil
+        }
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        guard let data = try? Data(contentsOf: url, options: .alwaysMapped),
+              let image = FITSFrameCache.decode(data) else {
+            Logger.swiftfitsio.error("Could not read spilled frame of \(key.path)")
+            return nil
+        }
+
+        lock.lock()
+        counters.spillHits += 1
+        var evicted: [(Key, Frame)] = []
+        if Frame.image(image).byteCount <= budget {
+            tick += 1
+            entries[key] = Entry(frame: .image(image), lastUsed: tick)
+            evicted = evictToBudget()
+        }
+        lock.unlock()
+
+        spill(evicted)
+        return image
+    }
+
+    /// Spill file layout: width, height, depth (Int64), bitpix (Int32), original min/max
+    /// (Float32), header length (Int64), header cards, pixels in their original range (Float32)
+    private static func encode(_ image: FITSImage) -> Data {
+        let table = image.header.table
+        let cards = (0..<table.count).map { table.card(at: $0) }.joined()
+            + "END".padding(toLength: FITSKeywordTable.cardLength, withPad: " ", startingAt: 0)
+        let headerBytes = Array(cards.utf8)
+
+        var data = Data()
+        for value in [Int64(image.width), Int64(image.height), Int64(image.depth)] {
+            withUnsafeBytes(of: value) { data.append(contentsOf: $0) }
+        }
+        withUnsafeBytes(of: image.bitpix) { data.append(contentsOf: $0) }
+        withUnsafeBytes(of: image.originalMinValue) { data.append(contentsOf: $0) }
+        withUnsafeBytes(of: image.originalMaxValue) { data.append(contentsOf: $0) }
+        withUnsafeBytes(of: Int64(headerBytes.count)) { data.append(contentsOf: $0) }
+        data.append(contentsOf: headerBytes)
+
+        let pixels = image.rawPixels.toArray()
+        pixels.withUnsafeBytes { data.append(contentsOf: $0) }
+        return data
+    }
+
+    private static func decode(_ data: Data) -> FITSImage? {
+        return data.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) -> FITSImage? in
+            let fixedSize = 3 * 8 + 4 + 2 * 4 + 8
+            guard bytes.count >= fixedSize else {
+                return nil
+            }
+            let width = Int(bytes.loadUnaligned(fromByteOffset: 0, as: Int64.self))
+            let height = Int(bytes.loadUnaligned(fromByteOffset: 8, as: Int64.self))
+            let depth = Int(bytes.loadUnaligned(fromByteOffset: 16, as: Int64.self))
+            let bitpix = bytes.loadUnaligned(fromByteOffset: 24, as: Int32.self)
+            let minValue = bytes.loadUnaligned(fromByteOffset: 28, as: Float32.self)
+            let maxValue = bytes.loadUnaligned(fromByteOffset: 32, as: Float32.self)
+            let headerLength = Int(bytes.loadUnaligned(fromByteOffset: 36, as: Int64.self))
+
+            let pixelCount = width * height * depth
+            let pixelOffset = fixedSize + headerLength
+            guard pixelCount > 0, headerLength >= 0,
+                  bytes.count == pixelOffset + pixelCount * MemoryLayout<Float32>.stride,
+                  let dataType = try? FITSDataType(bitpix: bitpix) else {
+                return nil
+            }
+
+            let header = FITSHeader(table: FITSKeywordTable(text: Array(bytes[fixedSize..<pixelOffset])))
+            let store = FITSPixelStore(count: pixelCount)
+            store.withUnsafeMutableBufferPointer { destination in
+                _ = memcpy(destination.baseAddress!, bytes.baseAddress! + pixelOffset, pixelCount * MemoryLayout<Float32>.stride)
+            }
+
+            return FITSImage(
+                width: width,
+                height: height,
+                depth: depth,
+                bitpix: bitpix,
+                dataType: dataType,
+                storage: store,
+                originalMinValue: minValue,
+                originalMaxValue: maxValue,
+                header: header
+            )
+        }
+    }
+}
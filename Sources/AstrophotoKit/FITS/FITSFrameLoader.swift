@@ -0,0 +1,295 @@
+import Foundation
+import os
+
+/// A frame produced by `FITSFrameLoader`
+public struct FITSLoadedFrame {
+    /// Position of the file in the loader's path list
+    public let index: Int
+
+    /// Path of the file the frame was read from
+    public let path: String
+
+    /// The decoded image, or the error that occurred while reading it
+    public let result: Result<FITSImage, Error>
+}
+
+/// An asynchronous sequence of FITS frames that are read ahead in the background
+///
+/// While the consumer processes one frame, a background thread reads and decodes
+/// the next ones, so I/O overlaps with computation. At most `prefetchCount`
+/// frames, and at most `memoryBudget` bytes of pixels, wait in the queue. Pixel stores come
+/// from a fixed ring: once the consumer has released a frame (e.g. after uploading it to a
+/// texture), its store is reused for a later frame of the same size.
+///
+/// Frames are delivered in path order. A file that cannot be read yields a frame with a
+/// failed `result` and does not end the sequence. The sequence can be iterated once.
+public final class FITSFrameLoader: AsyncSequence {
+    public typealias Element = FITSLoadedFrame
+
+    /// Queue and buffer counters of a loader
+    public struct Metrics: Equatable {
+        /// Frames currently waiting in the queue
+        public var queuedFrames = 0
+        /// Pixel bytes of the frames waiting in the queue
+        public var queuedBytes = 0
+        /// Largest number of frames that waited in the queue at the same time
+        public var peakQueuedFrames = 0
+        /// Frames read so far, including failed ones
+        public var framesLoaded = 0
+        /// Times the consumer asked for a frame before it was ready
+        public var consumerWaits = 0
+        /// Times the loader waited for room in the queue
+        public var producerWaits = 0
+        /// Frames read into a reused pixel store
+        public var buffersReused = 0
+        /// Frames that needed a newly allocated pixel store
+        public var buffersAllocated = 0
+    }
+
+    /// The files to read, in order
+    public let paths: [String]
+
+    /// HDU to read from every file (nil = primary HDU)
+    public let hduNumber: Int?
+
+    /// Maximum number of frames read ahead of the consumer
+    public let prefetchCount: Int
+
+    /// Maximum number of pixel bytes read ahead of the consumer
+    ///
+    /// A single frame larger than the budget is still read once the queue is empty.
+    public let memoryBudget: Int
+
+    private let condition = NSCondition()
+    private var queue: [FITSLoadedFrame] = []
+    private var waitingConsumer: CheckedContinuation<FITSLoadedFrame?, Never>?
+    private var started = false
+    private var finished = false
+    private var cancelled = false
+    private var ring: [FITSPixelStore?]
+    private var counters = Metrics()
+
+    /// Creates a loader; reading starts when the sequence is first iterated
+    /// - Parameters:
+    ///   - paths: The files to read, in order
+    ///   - hduNumber: HDU to read from every file (nil = primary HDU)
+    ///   - prefetchCount: Maximum number of frames read ahead (default: 4)
+    ///   - memoryBudget: Maximum number of pixel bytes read ahead (default: 1 GiB)
+    public init(paths: [String], hduNumber: Int? = nil, prefetchCount: Int = 4, memoryBudget: Int = 1 << 30) {
+        self.paths = paths
+        self.hduNumber = hduNumber
+        self.prefetchCount = max(1, prefetchCount)
+        self.memoryBudget = memoryBudget
+        // One store per queued frame, one for the frame being read and one held by the consumer
+        self.ring = Array(repeating: nil, count: max(1, prefetchCount) + 2)
+    }
+
+    deinit {
+        cancel()
+    }
+
+    /// Current queue and buffer counters
+    public var metrics: Metrics {
+        condition.lock()
+        defer { condition.unlock() }
+        return counters
+    }
+
+    /// Stops reading ahead; frames already queued are still delivered
+    ///
+    /// Called automatically when the iterator is discarded before the sequence ends, and when
+    /// the task waiting for the next frame is cancelled.
+    public func cancel() {
+        condition.lock()
+        cancelled = true
+        condition.broadcast()
+        condition.unlock()
+    }
+
+    public struct Iterator: AsyncIteratorProtocol {
+        /// Cancels the loader when the last copy of the iterator goes away
+        final class Lifetime {
+            let loader: FITSFrameLoader
+
+            init(loader: FITSFrameLoader) {
+                self.loader = loader
+            }
+
+            deinit {
+                loader.cancel()
+            }
+        }
+
+        let lifetime: Lifetime
+
+        public mutating func next() async -> FITSLoadedFrame? {
+            return await lifetime.loader.nextFrame()
+        }
+    }
+
+    public func makeAsyncIterator() -> Iterator {
+        return Iterator(lifetime: Iterator.Lifetime(loader: self))
+    }
+
+    /// Returns the next frame, waiting for the loader if it is not ready yet
+    ///
+    /// Cancelling the waiting task cancels the loader; the frames already read are delivered
+    /// and the sequence then ends.
+    private func nextFrame() async -> FITSLoadedFrame? {
+        return await withTaskCancellationHandler {
+            await waitForFrame()
+        } onCancel: {
+            cancel()
+        }
+    }
+
+    private func waitForFrame() async -> FITSLoadedFrame? {
+        return await withCheckedContinuation { continuation in
+            condition.lock()
+            if !started {
+                started = true
+                Thread.detachNewThread { [self] in
+                    self.load()
+                }
+            }
+            if !queue.isEmpty {
+                let frame = queue.removeFirst()
+                counters.queuedFrames = queue.count
+                counters.queuedBytes -= frame.byteCount
+                condition.broadcast()
+                condition.unlock()
+                continuation.resume(returning: frame)
+            } else if finished {
+                condition.unlock()
+                continuation.resume(returning: nil)
+            } else {
+                counters.consumerWaits += 1
+                waitingConsumer = continuation
+                condition.unlock()
+            }
+        }
+    }
+
+    /// Reads all frames in order on the loader thread
+    private func load() {
+        for (index, path) in paths.enumerated() {
+            let result = Result { try readFrame(path: path) }
+            if case .failure(let error) = result, error is CancellationError {
+                break
+            }
+
+            condition.lock()
+            counters.framesLoaded += 1
+            let frame = FITSLoadedFrame(index: index, path: path, result: result)
+            if let consumer = waitingConsumer {
+                waitingConsumer = nil
+                condition.unlock()
+                consumer.resume(returning: frame)
+            } else {
+                queue.append(frame)
+                counters.queuedFrames = queue.count
+                counters.queuedBytes += frame.byteCount
+                counters.peakQueuedFrames = max(counters.peakQueuedFrames, queue.count)
+                condition.unlock()
+            }
+        }
+
+        condition.lock()
+        finished = true
+        let consumer = waitingConsumer
+        waitingConsumer = nil
+        condition.unlock()
+        consumer?.resume(returning: nil)
+
+        Logger.swiftfitsio.debug("Frame loader finished after \(self.metrics.framesLoaded) of \(self.paths.count) frames")
+    }
+
+    /// Reads one frame into a store from the ring, once there is room in the queue for it
+    private func readFrame(path: String) throws -> FITSImage {
+        let file = try FITSFile(path: path)
+        if let hdu = hduNumber {
+            try file.moveToHDU(hdu)
+        }
+        let geometry = try file.readImageGeometry()
+        let byteCount = try file.checkAllocation(count: geometry.pixelCount, stride: MemoryLayout<Float32>.stride)
+        guard let fptr = file.fitsfile, geometry.naxis > 0 else {
+            throw FITSFileError.readError(status: -1, message: "HDU contains no image data")
+        }
+
+        try waitForRoom(byteCount: byteCount)
+
+        let header = FITSHeader(table: try file.readKeywordTable())
+        let store = takeStore(count: geometry.pixelCount)
+        let (minVal, maxVal) = try file.readPixelValues(file: fptr, count: store.count, into: store.pointer)
+
+        return FITSImage(
+            width: geometry.width,
+            height: geometry.height,
+            depth: geometry.depth,
+            bitpix: geometry.bitpix,
+            dataType: try FITSDataType(bitpix: geometry.bitpix),
+            storage: store,
+            originalMinValue: minVal,
+            originalMaxValue: maxVal,
+            header: header
+        )
+    }
+
+    /// Waits until the queue has room for a frame of `byteCount` bytes
+    private func waitForRoom(byteCount: Int) throws {
+        condition.lock()
+        defer { condition.unlock() }
+
+        var waited = false
+        while !cancelled && (queue.count >= prefetchCount || (!queue.isEmpty && counters.queuedBytes + byteCount > memoryBudget)) {
+            if !waited {
+                counters.producerWaits += 1
+                waited = true
+            }
+            condition.wait()
+        }
+        if cancelled {
+            throw CancellationError()
+        }
+    }
+
+    /// Returns a store of `count` pixels, reusing one from the ring that no frame refers to
+    private func takeStore(count: Int) -> FITSPixelStore {
+        condition.lock()
+        defer { condition.unlock() }
+
+        var freeSlot: Int?
+        for slot in ring.indices {
+            guard ring[slot] != nil else {
+                freeSlot = freeSlot ?? slot
+                continue
+            }
+            // A store is free once the ring holds the only reference to it
+            guard isKnownUniquelyReferenced(&ring[slot]!) else {
+                continue
+            }
+            if ring[slot]!.count == count {
+                counters.buffersReused += 1
+                return ring[slot]!
+            }
+            freeSlot = freeSlot ?? slot
+        }
+
+        let store = FITSPixelStore(count: count)
+        counters.buffersAllocated += 1
+        if let slot = freeSlot {
+            ring[slot] = store
+        }
+        return store
+    }
+}
+
+private extension FITSLoadedFrame {
+    /// Pixel bytes of the frame, for the memory budget
+    var byteCount: Int {
+        if case .success(let image) = result {
+            return image.width * image.height * image.depth * MemoryLayout<Float32>.stride
+        }
+        return 0
+    }
+}
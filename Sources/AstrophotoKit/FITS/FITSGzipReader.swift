@@ -0,0 +1,440 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("apk_gz_open")
+func openGzipStream(_ path: UnsafePointer<CChar>?) -> UnsafeMutableRawPointer?
+
+@_silgen_name("apk_gz_read")
+func readGzipStream(_ handle: UnsafeMutableRawPointer?, _ buffer: UnsafeMutableRawPointer?, _ length: Int) -> Int
+
+@_silgen_name("apk_gz_close")
+func closeGzipStream(_ handle: UnsafeMutableRawPointer?)
+
+@_silgen_name("apk_bgzf_index")
+func indexBlockGzip(_ data: UnsafePointer<UInt8>?, _ length: Int, _ offsets: UnsafeMutablePointer<UInt64>?, _ sizes: UnsafeMutablePointer<UInt32>?, _ capacity: Int) -> Int
+
+@_silgen_name("apk_inflate_member")
+func inflateGzipMember(_ source: UnsafePointer<UInt8>?, _ sourceLength: Int, _ destination: UnsafeMutablePointer<UInt8>?, _ capacity: Int) -> Int
+
+/// Streams images out of gzip-compressed FITS files (.fits.gz) in bounded memory
+///
+/// CFITSIO decompresses a whole .fits.gz file into memory before reading any of it. This
+/// reader instead inflates the file chunk by chunk and converts the data unit band by band,
+/// so only one band of rows and the decompression window are held at a time, and HDUs before
+/// the requested one are skipped without being kept.
+///
+/// Files in the blocked gzip layout (BGZF, as written by `bgzip` or `pigz --blocked`) record
+/// the size of every gzip member, so the members are located without inflating and batches of
+/// them are inflated in parallel. Other gzip files, including plain multi-member files, are
+/// inflated serially. Uncompressed FITS files are also accepted.
+///
+/// Values are physical values (`BZERO + BSCALE * stored`). Integer BLANK values are not
+/// translated to NaN, as with `FITSMappedImage`. Tile-compressed HDUs are not supported.
+public final class FITSGzipReader {
+    /// FITS block size in bytes
+    static let blockSize = 2880
+
+    /// Path of the compressed file
+    public let path: String
+
+    /// Maximum number of gzip members inflated at the same time
+    public let maxConcurrency: Int
+
+    /// True if the file is in BGZF layout and is inflated in parallel
+    public var isBlockCompressed: Bool {
+        blockIndex != nil
+    }
+
+    /// Member offsets and uncompressed sizes of a BGZF file
+    private let blockIndex: BlockIndex?
+
+    /// Opens a compressed FITS file and checks whether its members can be inflated in parallel
+    /// - Parameters:
+    ///   - path: The file path to the .fits.gz file
+    ///   - maxConcurrency: Maximum number of gzip members inflated at the same time (default: number of active cores)
+    /// - Throws: An error if the file cannot be opened
+    public init(path: String, maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws {
+        guard FileManager.default.isReadableFile(atPath: path) else {
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: "File is not readable")
+        }
+        self.path = path
+        self.maxConcurrency = max(1, maxConcurrency)
+        self.blockIndex = maxConcurrency > 1 ? BlockIndex(path: path) : nil
+
+        let memberCount = blockIndex?.offsets.count ?? 0
+        Logger.swiftfitsio.debug("Opened \(path) for streaming, \(memberCount) BGZF members")
+    }
+
+    /// Calls `body` for every band of rows of an image HDU, inflating the file as it goes
+    /// - Parameters:
+    ///   - hduNumber: The HDU to read (0 = primary)
+    ///   - rowsPerChunk: Maximum number of rows per chunk (default: 256)
+    ///   - body: Closure receiving each chunk of original pixel values; the pixels are only valid during the call
+    /// - Throws: An error if the file is corrupt, the HDU contains no image, or `body` throws
+    public func forEachRowChunk(hduNumber: Int = 0, rowsPerChunk: Int = 256, _ body: (FITSRowChunk) throws -> Void) throws {
+        // The band buffer is allocated once the image width is known from the header
+        var band: UnsafeMutableBufferPointer<Float32>?
+        defer { band?.deallocate() }
+
+        try streamImage(hduNumber: hduNumber, rowsPerChunk: rowsPerChunk) { unit, plane, firstRow, rowCount, bytes in
+            let buffer = band ?? UnsafeMutableBufferPointer<Float32>.allocate(capacity: max(1, rowsPerChunk) * unit.geometry.width)
+            band = buffer
+            let count = rowCount * unit.geometry.width
+            convertBigEndianPixels(bytes, bitpix: unit.geometry.bitpix, count: count, scale: unit.bscale, zero: unit.bzero, into: buffer.baseAddress!)
+            try body(FITSRowChunk(
+                plane: plane,
+                firstRow: firstRow,
+                rowCount: rowCount,
+                width: unit.geometry.width,
+                pixels: UnsafeBufferPointer(rebasing: buffer[0..<count])
+            ))
+        }
+    }
+
+    /// Reads a complete image HDU, like `FITSFile.readFITSImage(hduNumber:)`
+    ///
+    /// The stored pixels are converted band by band straight into the image's pixel store, so
+    /// the decompressed file is never held in memory.
+    /// - Parameter hduNumber: The HDU to read (0 = primary)
+    /// - Returns: The decoded image
+    /// - Throws: An error if the file is corrupt or the HDU contains no image
+    public func readFITSImage(hduNumber: Int = 0) throws -> FITSImage {
+        var store: FITSPixelStore?
+        var imageUnit: DataUnit?
+        var minVal = Float32.greatestFiniteMagnitude
+        var maxVal = -Float32.greatestFiniteMagnitude
+        var finiteCount = 0
+
+        try streamImage(hduNumber: hduNumber, rowsPerChunk: 256) { unit, plane, firstRow, rowCount, bytes in
+            if store == nil {
+                store = FITSPixelStore(count: unit.geometry.pixelCount)
+                imageUnit = unit
+            }
+            let count = rowCount * unit.geometry.width
+            let destination = store!.pointer + (plane * unit.geometry.height + firstRow) * unit.geometry.width
+            convertBigEndianPixels(bytes, bitpix: unit.geometry.bitpix, count: count, scale: unit.bscale, zero: unit.bzero, into: destination)
+            finiteCount += accumulateRange(destination, count, &minVal, &maxVal)
+        }
+
+        guard let store = store, let unit = imageUnit else {
+            throw FITSFileError.readError(status: -1, message: "HDU \(hduNumber) contains no image data")
+        }
+        if finiteCount == 0 {
+            minVal = 0
+            maxVal = 0
+        }
+
+        return FITSImage(
+            width: unit.geometry.width,
+            height: unit.geometry.height,
+            depth: unit.geometry.depth,
+            bitpix: unit.geometry.bitpix,
+            dataType: try FITSDataType(bitpix: unit.geometry.bitpix),
+            storage: store,
+            originalMinValue: minVal,
+            originalMaxValue: maxVal,
+            header: unit.header
+        )
+    }
+
+    /// Header and layout of an HDU's data unit
+    private struct DataUnit {
+        let header: FITSHeader
+        let geometry: FITSImageGeometry
+        let bscale: Double
+        let bzero: Double
+        /// Size of the data unit including padding to a whole FITS block
+        let paddedByteCount: Int
+        let isImage: Bool
+    }
+
+    /// Skips to an HDU and calls `body` with the raw big-endian bytes of each band of rows
+    private func streamImage(hduNumber: Int, rowsPerChunk: Int, _ body: (DataUnit, Int, Int, Int, UnsafeRawPointer) throws -> Void) throws {
+        let source: GzipByteSource
+        if let index = blockIndex {
+            source = BlockGzipSource(index: index, maxConcurrency: maxConcurrency)
+        } else {
+            source = try SerialGzipSource(path: path)
+        }
+
+        var unit = try readDataUnit(from: source, primary: true)
+        for _ in 0..<hduNumber {
+            try source.skip(unit.paddedByteCount)
+            unit = try readDataUnit(from: source, primary: false)
+        }
+
+        let geometry = unit.geometry
+        guard unit.isImage, geometry.naxis > 0, geometry.pixelCount > 0 else {
+            throw FITSFileError.readError(status: -1, message: "HDU \(hduNumber) contains no image data")
+        }
+
+        let rowsPerBand = max(1, rowsPerChunk)
+        let rowBytes = geometry.width * geometry.bytesPerPixel
+        let raw = UnsafeMutableRawPointer.allocate(byteCount: rowsPerBand * rowBytes, alignment: 16)
+        defer { raw.deallocate() }
+
+        for plane in 0..<geometry.depth {
+            var row = 0
+            while row < geometry.height {
+                let rowCount = min(rowsPerBand, geometry.height - row)
+                try source.readFully(into: raw, count: rowCount * rowBytes)
+                try body(unit, plane, row, rowCount, UnsafeRawPointer(raw))
+                row += rowCount
+            }
+        }
+    }
+
+    /// Reads the header blocks of the next HDU and derives the size of its data unit
+    private func readDataUnit(from source: GzipByteSource, primary: Bool) throws -> DataUnit {
+        var text: [UInt8] = []
+        var block = [UInt8](repeating: 0, count: FITSGzipReader.blockSize)
+        var foundEnd = false
+
+        while !foundEnd {
+            try block.withUnsafeMutableBytes { try source.readFully(into: $0.baseAddress!, count: $0.count) }
+            text.append(contentsOf: block)
+            foundEnd = stride(from: 0, to: block.count, by: FITSKeywordTable.cardLength).contains { start in
+                block[start] == 0x45 && block[start + 1] == 0x4E && block[start + 2] == 0x44
+                    && block[(start + 3)..<(start + 8)].allSatisfy { $0 == 0x20 }
+            }
+        }
+
+        let table = FITSKeywordTable(text: text)
+        func integer(_ keyword: String) -> Int? {
+            table.value(for: keyword)?.intValue.map { Int($0) }
+        }
+        func double(_ keyword: String) -> Double? {
+            let value = table.value(for: keyword)
+            return value?.doubleValue ?? value?.intValue.map { Double($0) }
+        }
+
+        guard let bitpix = integer("BITPIX"), let naxis = integer("NAXIS"), naxis >= 0 && naxis <= FITSImageGeometry.maxAxes,
+              [8, 16, 32, 64, -32, -64].contains(bitpix) else {
+            throw FITSFileError.readError(status: -1, message: "Invalid FITS header in \(path)")
+        }
+        let axes = try (0..<naxis).map { axis -> Int in
+            guard let length = integer("NAXIS\(axis + 1)") else {
+                throw FITSFileError.readError(status: -1, message: "Missing NAXIS\(axis + 1) in \(path)")
+            }
+            return length
+        }
+        let geometry = try FITSImageGeometry(bitpix: Int32(bitpix), axes: axes)
+
+        // Random groups and tables add PCOUNT bytes of heap per group
+        let groupCount = integer("GCOUNT") ?? 1
+        let parameterCount = integer("PCOUNT") ?? 0
+        let byteCount = naxis == 0 ? 0 : geometry.bytesPerPixel * groupCount * (parameterCount + geometry.pixelCount)
+        let blockSize = FITSGzipReader.blockSize
+
+        return DataUnit(
+            header: FITSHeader(table: table),
+            geometry: geometry,
+            bscale: double("BSCALE") ?? 1.0,
+            bzero: double("BZERO") ?? 0.0,
+            paddedByteCount: (byteCount + blockSize - 1) / blockSize * blockSize,
+            isImage: primary || table.value(for: "XTENSION")?.stringValue?.trimmingCharacters(in: .whitespaces) == "IMAGE"
+        )
+    }
+}
+
+/// A sequential source of decompressed bytes
+private protocol GzipByteSource: AnyObject {
+    /// Reads up to `count` bytes; returns fewer only at the end of the stream
+    func read(into buffer: UnsafeMutableRawPointer, count: Int) throws -> Int
+
+    /// Discards the next `count` bytes
+    func skip(_ count: Int) throws
+}
+
+private extension GzipByteSource {
+    /// Reads exactly `count` bytes
+    func readFully(into buffer: UnsafeMutableRawPointer, count: Int) throws {
+        guard try read(into: buffer, count: count) == count else {
+            throw FITSFileError.readError(status: -1, message: "Unexpected end of compressed FITS file")
+        }
+    }
+}
+
+/// Inflates a gzip file on the calling thread through zlib's buffered reader
+private final class SerialGzipSource: GzipByteSource {
+    private let handle: UnsafeMutableRawPointer
+
+    init(path: String) throws {
+        guard let handle = openGzipStream(path) else {
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: String(cString: strerror(errno)))
+        }
+        self.handle = handle
+    }
+
+    deinit {
+        closeGzipStream(handle)
+    }
+
+    func read(into buffer: UnsafeMutableRawPointer, count: Int) throws -> Int {
+        let result = readGzipStream(handle, buffer, count)
+        guard result >= 0 else {
+            throw FITSFileError.readError(status: -1, message: "Corrupt gzip stream")
+        }
+        return result
+    }
+
+    func skip(_ count: Int) throws {
+        let scratchSize = 1 << 18
+        let scratch = UnsafeMutableRawPointer.allocate(byteCount: scratchSize, alignment: 16)
+        defer { scratch.deallocate() }
+
+        var remaining = count
+        while remaining > 0 {
+            let length = min(scratchSize, remaining)
+            try readFully(into: scratch, count: length)
+            remaining -= length
+        }
+    }
+}
+
+/// The members of a BGZF file, located from their headers without inflating them
+private struct BlockIndex {
+    /// The mapped compressed file
+    let data: Data
+    /// Byte offset of each member in the compressed file
+    let offsets: [UInt64]
+    /// Uncompressed size of each member
+    let sizes: [UInt32]
+
+    /// Indexes a file; returns nil if it is not entirely in BGZF layout
+    init?(path: String) {
+        guard let data = try? Data(contentsOf: URL(fileURLWithPath: path), options: .alwaysMapped) else {
+            return nil
+        }
+        let count = data.withUnsafeBytes { indexBlockGzip($0.bindMemory(to: UInt8.self).baseAddress, $0.count, nil, nil, 0) }
+        guard count > 0 else {
+            return nil
+        }
+        var offsets = [UInt64](repeating: 0, count: count)
+        var sizes = [UInt32](repeating: 0, count: count)
+        _ = data.withUnsafeBytes { bytes in
+            indexBlockGzip(bytes.bindMemory(to: UInt8.self).baseAddress, bytes.count, &offsets, &sizes, count)
+        }
+        self.data = data
+        self.offsets = offsets
+        self.sizes = sizes
+    }
+
+    /// Compressed length of a member
+    func compressedLength(of member: Int) -> Int {
+        let end = member + 1 < offsets.count ? Int(offsets[member + 1]) : data.count
+        return end - Int(offsets[member])
+    }
+}
+
+/// Inflates batches of BGZF members in parallel into a window that is read sequentially
+private final class BlockGzipSource: GzipByteSource {
+    /// Uncompressed bytes inflated per batch, a few members per worker
+    private let windowCapacity: Int
+
+    private let index: BlockIndex
+    private let maxConcurrency: Int
+    private var window: UnsafeMutableRawPointer
+    private var windowLength = 0
+    private var windowPosition = 0
+    private var nextMember = 0
+
+    init(index: BlockIndex, maxConcurrency: Int) {
+        // BGZF members hold at most 64 KiB of uncompressed data
+        self.windowCapacity = max(1, maxConcurrency) * 4 * 65536
+        self.index = index
+        self.maxConcurrency = maxConcurrency
+        self.window = UnsafeMutableRawPointer.allocate(byteCount: windowCapacity, alignment: 16)
+    }
+
+    deinit {
+        window.deallocate()
+    }
+
+    func read(into buffer: UnsafeMutableRawPointer, count: Int) throws -> Int {
+        var copied = 0
+        while copied < count {
+            if windowPosition == windowLength {
+                guard try refill() else {
+                    break
+                }
+            }
+            let length = min(count - copied, windowLength - windowPosition)
+            memcpy(buffer + copied, window + windowPosition, length)
+            copied += length
+            windowPosition += length
+        }
+        return copied
+    }
+
+    func skip(_ count: Int) throws {
+        var remaining = count
+        let buffered = min(remaining, windowLength - windowPosition)
+        windowPosition += buffered
+        remaining -= buffered
+
+        // Whole members inside the skipped range are never inflated
+        while remaining > 0 && nextMember < index.sizes.count && Int(index.sizes[nextMember]) <= remaining {
+            remaining -= Int(index.sizes[nextMember])
+            nextMember += 1
+        }
+        while remaining > 0 {
+            guard try refill() else {
+                throw FITSFileError.readError(status: -1, message: "Unexpected end of compressed FITS file")
+            }
+            let length = min(remaining, windowLength)
+            windowPosition = length
+            remaining -= length
+        }
+    }
+
+    /// Inflates the next batch of members into the window; returns false at the end of the file
+    private func refill() throws -> Bool {
+        var members: [(member: Int, offset: Int)] = []
+        var length = 0
+        while nextMember < index.sizes.count && length + Int(index.sizes[nextMember]) <= windowCapacity {
+            members.append((nextMember, length))
+            length += Int(index.sizes[nextMember])
+            nextMember += 1
+        }
+        guard !members.isEmpty else {
+            return false
+        }
+
+        // Workers take every workerCount-th member; each inflates into its own part of the window
+        let index = self.index
+        let window = self.window
+        let workerCount = min(maxConcurrency, members.count)
+        let lock = NSLock()
+        var failed = false
+        index.data.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) in
+            let base = bytes.bindMemory(to: UInt8.self).baseAddress!
+            DispatchQueue.concurrentPerform(iterations: workerCount) { worker in
+                for item in stride(from: worker, to: members.count, by: workerCount) {
+                    let (member, offset) = members[item]
+                    let size = Int(index.sizes[member])
+                    let produced = inflateGzipMember(
+                        base + Int(index.offsets[member]),
+                        index.compressedLength(of: member),
+                        (window + offset).assumingMemoryBound(to: UInt8.self),
+                        size
+                    )
+                    if produced != size {
+                        lock.lock()
+                        failed = true
+                        lock.unlock()
+                    }
+                }
+            }
+        }
+        guard !failed else {
+            throw FITSFileError.readError(status: -1, message: "Corrupt gzip member in compressed FITS file")
+        }
+
+        windowLength = length
+        windowPosition = 0
+        return true
+    }
+}
@@ -0,0 +1,168 @@
+import Foundation
+import os
+
+/// A thread-safe pool of open `FITSFile` handles, keyed by path
+///
+/// A CFITSIO handle must only be used by one thread at a time. The pool hands every caller
+/// a handle of its own and takes it back afterwards, so many threads can read different
+/// HDUs of the same file concurrently without serializing on a lock. Idle handles are kept
+/// open for reuse and closed in least-recently-used order once `maxOpenHandles` is reached.
+///
+/// A returned handle keeps its current HDU; callers should move to the HDU they need
+/// (see `withHandle(path:hdu:_:)`).
+public final class FITSHandlePool {
+    /// Usage counters of a pool
+    public struct Statistics: Equatable {
+        /// Checkouts served by an idle handle
+        public var hits = 0
+        /// Checkouts that opened a new handle
+        public var misses = 0
+        /// Idle handles closed to stay within the limit
+        public var evictions = 0
+        /// Handles currently open, idle or checked out
+        public var openHandles = 0
+    }
+
+    /// Maximum number of handles (file descriptors) open at the same time
+    public let maxOpenHandles: Int
+
+    private struct IdleHandle {
+        let file: FITSFile
+        let lastUsed: UInt64
+    }
+
+    private let condition = NSCondition()
+    private var idle: [String: [IdleHandle]] = [:]
+    private var idleCount = 0
+    private var checkedOut = 0
+    private var tick: UInt64 = 0
+    private var counters = Statistics()
+
+    /// Creates an empty pool
+    /// - Parameter maxOpenHandles: Maximum number of open handles (default: 64)
+    public init(maxOpenHandles: Int = 64) {
+        self.maxOpenHandles = max(1, maxOpenHandles)
+    }
+
+    /// Current usage counters
+    public var statistics: Statistics {
+        condition.lock()
+        defer { condition.unlock() }
+        var statistics = counters
+        statistics.openHandles = idleCount + checkedOut
+        return statistics
+    }
+
+    /// Takes a handle on a file out of the pool, opening one if no idle handle is available
+    ///
+    /// When `maxOpenHandles` handles are checked out, the call waits until one is returned.
+    /// Every checked-out handle must be returned with `checkIn(_:)`.
+    ///
+    /// The pool is not re-entrant: a thread that already holds a handle and checks out another
+    /// one (e.g. by nesting `withHandle` calls) deadlocks once the limit is reached and every
+    /// other handle is held by threads doing the same. Return a handle before taking the next.
+    /// - Parameter path: The file path of the FITS file
+    /// - Returns: A handle that only the caller uses until it is checked in
+    /// - Throws: An error if a new handle cannot be opened
+    public func checkOut(path: String) throws -> FITSFile {
+        condition.lock()
+        while true {
+            // A handle on the same file may have been returned while waiting
+            if let entry = idle[path]?.popLast() {
+                if idle[path]!.isEmpty {
+                    idle[path] = nil
+                }
+                idleCount -= 1
+                checkedOut += 1
+                counters.hits += 1
+                condition.unlock()
+                return entry.file
+            }
+            guard idleCount + checkedOut >= maxOpenHandles else {
+                break
+            }
+
+            // Make room for a new handle by closing the least recently used idle one
+            if let (evictPath, index) = leastRecentlyUsedIdle() {
+                let evicted = idle[evictPath]!.remove(at: index)
+                if idle[evictPath]!.isEmpty {
+                    idle[evictPath] = nil
+                }
+                idleCount -= 1
+                counters.evictions += 1
+                try? evicted.file.close()
+            } else {
+                condition.wait()
+            }
+        }
+        checkedOut += 1
+        counters.misses += 1
+        condition.unlock()
+
+        do {
+            return try FITSFile(path: path)
+        } catch {
+            condition.lock()
+            checkedOut -= 1
+            condition.signal()
+            condition.unlock()
+            throw error
+        }
+    }
+
+    /// Returns a handle to the pool for reuse
+    /// - Parameter file: A handle obtained from `checkOut(path:)`
+    public func checkIn(_ file: FITSFile) {
+        condition.lock()
+        defer { condition.unlock() }
+
+        checkedOut -= 1
+        if file.fitsfile != nil {
+            tick += 1
+            idle[file.path, default: []].append(IdleHandle(file: file, lastUsed: tick))
+            idleCount += 1
+        }
+        condition.signal()
+    }
+
+    /// Calls `body` with a pooled handle on a file, optionally moved to an HDU
+    /// - Parameters:
+    ///   - path: The file path of the FITS file
+    ///   - hdu: HDU to move to before calling `body` (nil = leave the handle where it is)
+    ///   - body: Work to do with the handle; the handle must not escape
+    /// - Returns: The result of `body`
+    /// - Throws: An error if no handle can be opened, or the error thrown by `body`
+    public func withHandle<R>(path: String, hdu: Int? = nil, _ body: (FITSFile) throws -> R) throws -> R {
+        let file = try checkOut(path: path)
+        defer { checkIn(file) }
+        if let hdu = hdu {
+            try file.moveToHDU(hdu)
+        }
+        return try body(file)
+    }
+
+    /// Closes all idle handles; handles that are checked out return to the pool as usual
+    public func removeAll() {
+        condition.lock()
+        let files = idle.values.flatMap { $0.map(\.file) }
+        idle.removeAll()
+        idleCount = 0
+        condition.unlock()
+
+        for file in files {
+            try? file.close()
+        }
+        Logger.swiftfitsio.debug("Closed \(files.count) idle handles")
+    }
+
+    /// Finds the idle handle that was returned longest ago; must be called with the lock held
+    private func leastRecentlyUsedIdle() -> (String, Int)? {
+        var oldest: (path: String, index: Int, lastUsed: UInt64)?
+        for (path, entries) in idle {
+            for (index, entry) in entries.enumerated() where oldest == nil || entry.lastUsed < oldest!.lastUsed {
+                oldest = (path, index, entry.lastUsed)
+            }
+        }
+        return oldest.map { ($0.path, $0.index) }
+    }
+}
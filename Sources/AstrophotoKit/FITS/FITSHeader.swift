@@ -0,0 +1,203 @@
+import Foundation
+
+/// Lazily indexed header of one HDU
+///
+/// The header keeps the raw card block parsed into a `FITSKeywordTable`. A keyword index
+/// is built on the first lookup and values are decoded only when requested, so reading
+/// `EXPTIME` from a frame does not box every card of its header. Repeated keywords such as
+/// `HISTORY` and `COMMENT` keep all their cards, in header order.
+///
+/// `FITSHeader` is immutable and safe to share between threads.
+public final class FITSHeader {
+    /// The parsed header cards
+    public let table: FITSKeywordTable
+
+    private let lock = NSLock()
+    private var index: [String: [Int]]?
+    private var cachedDictionary: [String: FITSHeaderValue]?
+
+    /// Creates a header from parsed header cards
+    public init(table: FITSKeywordTable) {
+        self.table = table
+    }
+
+    /// Creates a header by formatting a keyword dictionary as header cards
+    ///
+    /// Keywords are written in sorted order. `.comment` values become commentary cards.
+    /// - Parameter dictionary: Keyword values
+    public convenience init(dictionary: [String: FITSHeaderValue]) {
+        var text: [UInt8] = []
+        text.reserveCapacity((dictionary.count + 1) * FITSKeywordTable.cardLength)
+        for keyword in dictionary.keys.sorted() {
+            text.append(contentsOf: FITSHeader.formatCard(keyword: keyword, value: dictionary[keyword]!).utf8)
+        }
+        text.append(contentsOf: FITSHeader.cardBytes("END"))
+        self.init(table: FITSKeywordTable(text: text))
+    }
+
+    /// An empty header
+    public static let empty = FITSHeader(dictionary: [:])
+
+    /// Number of cards in the header
+    public var count: Int {
+        table.count
+    }
+
+    /// True if the header has no cards
+    public var isEmpty: Bool {
+        table.count == 0
+    }
+
+    /// The distinct keywords in the header, in order of first appearance
+    public var keywords: [String] {
+        let index = keywordIndex()
+        return index.keys.sorted { index[$0]![0] < index[$1]![0] }
+    }
+
+    /// Returns the value of the first card with the given keyword
+    public subscript(keyword: String) -> FITSHeaderValue? {
+        guard let first = keywordIndex()[keyword]?.first else {
+            return nil
+        }
+        return table.value(at: first)
+    }
+
+    /// Returns the values of all cards with the given keyword, in header order
+    public func values(for keyword: String) -> [FITSHeaderValue] {
+        return (keywordIndex()[keyword] ?? []).map { table.value(at: $0) }
+    }
+
+    /// Returns the comment of the first card with the given keyword
+    public func comment(for keyword: String) -> String? {
+        return keywordIndex()[keyword]?.first.map { table.comment(at: $0) }
+    }
+
+    /// The text of all HISTORY cards
+    public var history: [String] {
+        return (keywordIndex()["HISTORY"] ?? []).map { table.comment(at: $0) }
+    }
+
+    /// The text of all COMMENT cards
+    public var comments: [String] {
+        return (keywordIndex()["COMMENT"] ?? []).map { table.comment(at: $0) }
+    }
+
+    /// The header as a keyword dictionary (built once, on first access)
+    ///
+    /// For repeated keywords only the last card is kept; use `values(for:)` to get all of them.
+    public var dictionary: [String: FITSHeaderValue] {
+        lock.lock()
+        defer { lock.unlock() }
+        if let cachedDictionary = cachedDictionary {
+            return cachedDictionary
+        }
+        let dictionary = table.dictionary()
+        cachedDictionary = dictionary
+        return dictionary
+    }
+
+    /// Returns the keyword → card indices map, building it on first use
+    private func keywordIndex() -> [String: [Int]] {
+        lock.lock()
+        defer { lock.unlock() }
+        if let index = index {
+            return index
+        }
+        var built: [String: [Int]] = [:]
+        built.reserveCapacity(table.count)
+        for card in 0..<table.count {
+            let keyword = table.keyword(at: card)
+            if !keyword.isEmpty {
+                built[keyword, default: []].append(card)
+            }
+        }
+        index = built
+        return built
+    }
+
+    /// Formats a keyword and value as an 80-character header card
+    ///
+    /// Characters outside printable ASCII are replaced by `?`, since FITS headers may only
+    /// contain bytes 0x20–0x7E. A `.comment` value under a keyword longer than 8 characters
+    /// is written as a HIERARCH string card instead of cutting the keyword. NaN and infinite
+    /// values have no FITS representation and are written as an undefined value.
+    /// - Parameters:
+    ///   - keyword: The keyword; keywords longer than 8 characters use the HIERARCH convention
+    ///   - value: The value
+    ///   - comment: Optional comment appended after the value
+    /// - Returns: The card text, padded or truncated to 80 bytes
+    public static func formatCard(keyword: String, value: FITSHeaderValue, comment: String? = nil) -> String {
+        let keyword = printableASCII(keyword)
+        let isHierarch = keyword.count > 8 || keyword.contains(" ")
+        var card: String
+
+        switch value {
+        case .comment(let text) where !isHierarch:
+            card = keyword.padding(toLength: 8, withPad: " ", startingAt: 0) + printableASCII(text)
+        default:
+            let formatted: String
+            switch value {
+            case .string(let string), .comment(let string):
+                // Strings are quoted, with embedded quotes doubled, and at least 8 characters long
+                let escaped = printableASCII(string).replacingOccurrences(of: "'", with: "''")
+                formatted = "'" + escaped.padding(toLength: max(8, escaped.count), withPad: " ", startingAt: 0) + "'"
+            case .integer(let integer):
+                formatted = rightJustified("\(integer)")
+            case .floatingPoint(let double) where !double.isFinite:
+                // Undefined value: blank value field
+                formatted = rightJustified("")
+            case .floatingPoint(let double):
+                let text = "\(double)".uppercased()
+                formatted = rightJustified(text.contains(".") || text.contains("E") ? text : text + ".")
+            case .boolean(let bool):
+                formatted = rightJustified(bool ? "T" : "F")
+            }
+            if isHierarch {
+                card = "HIERARCH \(keyword) = \(formatted)"
+            } else {
+                card = keyword.padding(toLength: 8, withPad: " ", startingAt: 0) + "= " + formatted
+            }
+            if let comment = comment, !comment.isEmpty {
+                card += " / " + printableASCII(comment)
+            }
+        }
+
+        return String(decoding: cardBytes(card), as: UTF8.self)
+    }
+
+    /// Replaces every character outside printable ASCII (0x20–0x7E) with `?`
+    private static func printableASCII(_ text: String) -> String {
+        var scalars = String.UnicodeScalarView()
+        for scalar in text.unicodeScalars {
+            scalars.append((0x20...0x7E).contains(scalar.value) ? scalar : "?")
+        }
+        return String(scalars)
+    }
+
+    /// Returns the bytes of a card, padded with spaces or truncated to 80 bytes
+    private static func cardBytes(_ card: String) -> [UInt8] {
+        var bytes = Array(card.utf8.prefix(FITSKeywordTable.cardLength))
+        bytes.append(contentsOf: repeatElement(UInt8(ascii: " "), count: FITSKeywordTable.cardLength - bytes.count))
+        return bytes
+    }
+
+    /// Right-justifies a fixed-format value so that it ends in column 30
+    private static func rightJustified(_ text: String) -> String {
+        guard text.count < 20 else {
+            return text
+        }
+        return String(repeating: " ", count: 20 - text.count) + text
+    }
+}
+
+extension FITSHeader: Equatable {
+    public static func == (lhs: FITSHeader, rhs: FITSHeader) -> Bool {
+        if lhs === rhs {
+            return true
+        }
+        guard lhs.count == rhs.count else {
+            return false
+        }
+        return (0..<lhs.count).allSatisfy { lhs.table.card(at: $0) == rhs.table.card(at: $0) }
+    }
+}
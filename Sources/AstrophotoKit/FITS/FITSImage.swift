@@ -65,19 +65,26 @@ public enum FITSCoordinateConverter {
 @_silgen_name("fits_movabs_hdu_wrapper")
 func moveToHDUPointer(_ fptr: OpaquePointer?, _ hduNumber: Int32, _ hduType: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
 
-@_silgen_name("fits_get_hdrspace_wrapper")
-func getHeaderSpace(_ fptr: OpaquePointer?, _ numKeys: UnsafeMutablePointer<Int32>, _ numMore: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
-
-@_silgen_name("fits_read_keyn_wrapper")
-func readKeyAtIndex(_ fptr: OpaquePointer?, _ index: Int32, _ keyName: UnsafeMutablePointer<CChar>, _ value: UnsafeMutablePointer<CChar>, _ comment: UnsafeMutablePointer<CChar>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+@_silgen_name("fits_get_hdu_num_wrapper")
+func getCurrentHDUNumber(_ fptr: OpaquePointer?, _ hduNumber: UnsafeMutablePointer<Int32>) -> Int32
 
 @_silgen_name("fits_get_img_param_wrapper")
 func getImageParameters(_ fptr: OpaquePointer?, _ maxDimensions: Int32, _ bitpix: UnsafeMutablePointer<Int32>, _ naxis: UnsafeMutablePointer<Int32>, _ naxes: UnsafeMutablePointer<Int64>, _ status: UnsafeMutablePointer<Int32>) -> Int32
 
-@_silgen_name("fits_read_img_wrapper")
-func readImageData(_ fptr: OpaquePointer?, _ dataType: Int32, _ naxis: Int32, _ firstPixel: UnsafeMutablePointer<Int64>, _ numElements: UnsafeMutablePointer<Int64>, _ nullValue: UnsafeMutablePointer<Float32>?, _ array: UnsafeMutablePointer<Float32>, _ anyNull: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+@_silgen_name("apk_minmax_f32")
+func accumulateRange(_ src: UnsafePointer<Float32>?, _ count: Int, _ minValue: UnsafeMutablePointer<Float32>, _ maxValue: UnsafeMutablePointer<Float32>) -> Int
+
+@_silgen_name("apk_normalize_f32")
+func normalizePixels(_ src: UnsafePointer<Float32>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ minValue: Float32, _ maxValue: Float32)
+
 
 /// Represents a FITS image with metadata and pixel data
+///
+/// The pixels live in a single reference-counted `FITSPixelStore`, in their original (physical)
+/// value range. The original-range and normalized pixels are both zero-copy views of that
+/// store, so the original values are kept exactly; regions extracted from an image share the
+/// store as well. Copying a `FITSImage` never copies pixels; the store is
+/// duplicated only when a shared image is mutated.
 public struct FITSImage: Equatable {
     /// Image dimensions
     public let width: Int
@@ -88,23 +95,245 @@ public struct FITSImage: Equatable {
     public let bitpix: Int32
     public let dataType: FITSDataType
     
-    /// Pixel data as Float32 array (normalized for Metal)
-    public let pixelData: [Float32]
-    
-    /// Raw pixel data
-    public let rawData: Data
-    
     /// Original pixel value range (before normalization)
     public let originalMinValue: Float32
     public let originalMaxValue: Float32
     
-    /// Metadata from FITS header
-    public let metadata: [String: FITSHeaderValue]
+    /// FITS header, indexed and decoded lazily
+    public let header: FITSHeader
+    
+    /// Metadata from FITS header as a keyword dictionary
+    ///
+    /// Built from `header` on first access. Prefer `header[keyword]` to look up single
+    /// keywords and `header.values(for:)` for repeated keywords such as HISTORY.
+    public var metadata: [String: FITSHeaderValue] {
+        header.dictionary
+    }
+    
+    /// Shared storage of the pixels in their original value range
+    public private(set) var storage: FITSPixelStore
+    
+    /// Index of the first pixel of this image in the store
+    public private(set) var storageOffset: Int
+    
+    /// Distance between the starts of consecutive rows in the store, in pixels
+    public private(set) var rowStride: Int
+    
+    /// Distance between the starts of consecutive planes in the store, in pixels
+    public private(set) var planeStride: Int
+    
+    /// Creates an image backed by an existing pixel store (no copy)
+    /// - Parameters:
+    ///   - storage: Store holding the pixels in their original value range
+    ///   - storageOffset: Index of the first pixel in the store (default: 0)
+    ///   - rowStride: Row stride in pixels (default: width)
+    ///   - planeStride: Plane stride in pixels (default: rowStride * height)
+    public init(
+        width: Int,
+        height: Int,
+        depth: Int,
+        bitpix: Int32,
+        dataType: FITSDataType,
+        storage: FITSPixelStore,
+        storageOffset: Int = 0,
+        rowStride: Int? = nil,
+        planeStride: Int? = nil,
+        originalMinValue: Float32,
+        originalMaxValue: Float32,
+        header: FITSHeader
+    ) {
+        self.width = width
+        self.height = height
+        self.depth = depth
+        self.bitpix = bitpix
+        self.dataType = dataType
+        self.storage = storage
+        self.storageOffset = storageOffset
+        self.rowStride = rowStride ?? width
+        self.planeStride = planeStride ?? (rowStride ?? width) * height
+        self.originalMinValue = originalMinValue
+        self.originalMaxValue = originalMaxValue
+        self.header = header
+    }
+    
+    /// Creates an image backed by an existing pixel store, with header cards built from a dictionary
+    public init(
+        width: Int,
+        height: Int,
+        depth: Int,
+        bitpix: Int32,
+        dataType: FITSDataType,
+        storage: FITSPixelStore,
+        originalMinValue: Float32,
+        originalMaxValue: Float32,
+        metadata: [String: FITSHeaderValue]
+    ) {
+        self.init(
+            width: width,
+            height: height,
+            depth: depth,
+            bitpix: bitpix,
+            dataType: dataType,
+            storage: storage,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            header: FITSHeader(dictionary: metadata)
+        )
+    }
+    
+    /// Creates an image from an array of normalized pixels
+    ///
+    /// The pixels are converted back to the range `originalMinValue...originalMaxValue` as
+    /// they are copied into a new store.
+    public init(
+        width: Int,
+        height: Int,
+        depth: Int,
+        bitpix: Int32,
+        dataType: FITSDataType,
+        pixelData: [Float32],
+        originalMinValue: Float32,
+        originalMaxValue: Float32,
+        metadata: [String: FITSHeaderValue]
+    ) {
+        let range = originalMaxValue - originalMinValue
+        let store: FITSPixelStore
+        if range > 0 {
+            store = FITSPixelStore(count: pixelData.count)
+            convertFloat32ToFloat32(pixelData, store.pointer, pixelData.count, Double(range), Double(originalMinValue))
+        } else {
+            store = pixelData.withUnsafeBufferPointer { FITSPixelStore(copying: $0) }
+        }
+        self.init(
+            width: width,
+            height: height,
+            depth: depth,
+            bitpix: bitpix,
+            dataType: dataType,
+            storage: store,
+            originalMinValue: originalMinValue,
+            originalMaxValue: originalMaxValue,
+            metadata: metadata
+        )
+    }
     
     /// Image dimensions as a vector
     public var dimensions: SIMD3<Int> {
         SIMD3<Int>(width, height, depth)
     }
+    
+    /// Zero-copy view of the normalized (0-1) pixels
+    ///
+    /// Pixels are mapped from `originalMinValue...originalMaxValue` onto 0-1 as they are read.
+    /// An image with a single value keeps it unchanged.
+    public var normalizedPixels: FITSPixelView {
+        let (scale, bias) = FITSImage.normalization(minValue: originalMinValue, maxValue: originalMaxValue)
+        return FITSPixelView(
+            store: storage,
+            offset: storageOffset,
+            width: width,
+            height: height,
+            depth: depth,
+            rowStride: rowStride,
+            planeStride: planeStride,
+            scale: scale,
+            bias: bias
+        )
+    }
+    
+    /// Zero-copy view of the pixels in their original value range
+    public var rawPixels: FITSPixelView {
+        FITSPixelView(
+            store: storage,
+            offset: storageOffset,
+            width: width,
+            height: height,
+            depth: depth,
+            rowStride: rowStride,
+            planeStride: planeStride
+        )
+    }
+    
+    /// Returns the transform `value * scale + bias` that maps a value range onto 0-1
+    /// - Parameters:
+    ///   - minValue: Smallest finite value
+    ///   - maxValue: Largest finite value
+    /// - Returns: The identity transform if the range is empty
+    static func normalization(minValue: Float32, maxValue: Float32) -> (scale: Float32, bias: Float32) {
+        let range = maxValue - minValue
+        guard range > 0 else {
+            return (1, 0)
+        }
+        return (1 / range, -minValue / range)
+    }
+    
+    /// Pixel data as Float32 array (normalized for Metal)
+    ///
+    /// Every access copies the whole image; use `normalizedPixels` for zero-copy access.
+    @available(*, deprecated, message: "Use normalizedPixels, or copyPixelData() for an array")
+    public var pixelData: [Float32] {
+        copyPixelData()
+    }
+    
+    /// Copies the normalized pixels into a packed array
+    ///
+    /// Use `normalizedPixels` to index pixels without copying.
+    public func copyPixelData() -> [Float32] {
+        return normalizedPixels.toArray()
+    }
+    
+    /// Raw pixel data (original Float32 values)
+    ///
+    /// Materializes an exact packed copy of the stored pixels; use `rawPixels` for zero-copy access.
+    public var rawData: Data {
+        let view = rawPixels
+        var data = Data(count: view.count * MemoryLayout<Float32>.size)
+        data.withUnsafeMutableBytes { bytes in
+            if let baseAddress = bytes.bindMemory(to: Float32.self).baseAddress {
+                view.copy(into: baseAddress)
+            }
+        }
+        return data
+    }
+    
+    /// Calls `body` with mutable access to the pixels in their original value range
+    ///
+    /// If the store is shared with another image it is first copied (copy-on-write),
+    /// so mutations never affect other images or regions. Values written outside
+    /// `originalMinValue...originalMaxValue` fall outside 0-1 in `normalizedPixels`.
+    /// - Parameter body: Closure receiving the first pixel, the row stride and the plane stride
+    public mutating func withUnsafeMutablePixels<R>(
+        _ body: (UnsafeMutablePointer<Float32>, _ rowStride: Int, _ planeStride: Int) throws -> R
+    ) rethrows -> R {
+        if !isKnownUniquelyReferenced(&storage) {
+            let view = rawPixels
+            let copy = FITSPixelStore(count: view.count)
+            view.copy(into: copy.pointer)
+            storage = copy
+            storageOffset = 0
+            rowStride = width
+            planeStride = width * height
+        }
+        return try body(storage.pointer + storageOffset, rowStride, planeStride)
+    }
+    
+    public static func == (lhs: FITSImage, rhs: FITSImage) -> Bool {
+        guard lhs.width == rhs.width,
+              lhs.height == rhs.height,
+              lhs.depth == rhs.depth,
+              lhs.bitpix == rhs.bitpix,
+              lhs.dataType == rhs.dataType,
+              lhs.originalMinValue == rhs.originalMinValue,
+              lhs.originalMaxValue == rhs.originalMaxValue,
+              lhs.header == rhs.header else {
+            return false
+        }
+        if lhs.storage === rhs.storage && lhs.storageOffset == rhs.storageOffset &&
+            lhs.rowStride == rhs.rowStride && lhs.planeStride == rhs.planeStride {
+            return true
+        }
+        return lhs.rawPixels.elementsEqual(rhs.rawPixels)
+    }
 }
 
 /// FITS data type enumeration
@@ -215,149 +444,137 @@ extension FITSFile {
         }
     }
     
+    /// Returns the number of the current HDU (0 = primary)
+    public func currentHDU() throws -> Int {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        
+        var hduNumber: Int32 = 0
+        _ = getCurrentHDUNumber(file, &hduNumber)
+        return Int(hduNumber) - 1  // CFITSIO uses 1-based indexing
+    }
+    
     /// Reads all header keywords from the current HDU
+    ///
+    /// The header is fetched in one call and parsed with `readKeywordTable()`; commentary
+    /// cards (COMMENT, HISTORY) are returned as `.comment` values.
     /// - Returns: Dictionary of header keywords and their values
     public func readHeader() throws -> [String: FITSHeaderValue] {
+        return try readKeywordTable().dictionary()
+    }
+    
+    /// Reads image data from the current HDU and converts it to a Float32 array
+    ///
+    /// Kept for source compatibility: the pixels are returned twice, as a normalized array
+    /// and as the original values in `rawData`.
+    /// - Returns: Tuple containing dimensions, normalized pixel data, raw data, bitpix, and original value range
+    @available(*, deprecated, message: "Use readNormalizedImage(), or FITSImage.rawPixels for the original values")
+    public func readImage() throws -> (width: Int, height: Int, depth: Int, pixels: [Float32], rawData: Data, bitpix: Int32, minVal: Float32, maxVal: Float32) {
+        let (width, height, depth, store, bitpix, minVal, maxVal) = try readImageStore()
+        let rawData = Data(bytes: store.pointer, count: store.byteCount)
+        let pixels = [Float32](unsafeUninitializedCapacity: store.count) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress {
+                normalizePixels(store.pointer, baseAddress, store.count, minVal, maxVal)
+            }
+            initializedCount = store.count
+        }
+        return (width, height, depth, pixels, rawData, bitpix, minVal, maxVal)
+    }
+    
+    /// Reads image data from the current HDU and converts it to a normalized Float32 array
+    /// - Returns: Tuple containing dimensions, normalized pixel data, bitpix, and original value range
+    public func readNormalizedImage() throws -> (width: Int, height: Int, depth: Int, pixels: [Float32], bitpix: Int32, minVal: Float32, maxVal: Float32) {
         guard let file = fitsfile else {
+            Logger.swiftfitsio.error("Attempted to read image from closed FITS file")
             throw FITSFileError.fileNotOpen
         }
         
-        var status: Int32 = 0
-        var metadata: [String: FITSHeaderValue] = [:]
-        
-        // Get number of keywords
-        var nkeys: Int32 = 0
-        var nmore: Int32 = 0
-        _ = getHeaderSpace(file, &nkeys, &nmore, &status)
-        guard status == 0 else {
-            var errorText = [CChar](repeating: 0, count: 81)
-            getFITSErrorStatus(status, &errorText)
-            errorText[80] = 0
-            let errorString = String(cString: errorText)
-            Logger.swiftfitsio.error("Error reading header space: status \(status), \(errorString)")
-            throw FITSFileError.readError(status: status, message: errorString)
-        }
+        let (width, height, depth, bitpix) = try readImageParameters()
+        let pixelCount = width * height * depth
         
-        // Read each keyword
-        for i in 1...nkeys {
-            var keyname = [CChar](repeating: 0, count: 9)  // FITS keyword names are 8 chars + null
-            var value = [CChar](repeating: 0, count: 71)   // FITS values can be up to 70 chars
-            var comment = [CChar](repeating: 0, count: 73) // Comments can be up to 72 chars
-            
-            _ = readKeyAtIndex(file, i, &keyname, &value, &comment, &status)
-            
-            if status == 0 {
-                let key = String(cString: keyname).trimmingCharacters(in: .whitespaces)
-                let valStr = String(cString: value).trimmingCharacters(in: .whitespaces)
-                _ = String(cString: comment).trimmingCharacters(in: .whitespaces)
-                
-                // Skip END keyword
-                if key == "END" { continue }
-                
-                // Try to parse the value
-                if valStr.hasPrefix("'") && valStr.hasSuffix("'") {
-                    // String value
-                    let str = String(valStr.dropFirst().dropLast())
-                    metadata[key] = .string(str)
-                } else if valStr.lowercased() == "t" {
-                    metadata[key] = .boolean(true)
-                } else if valStr.lowercased() == "f" {
-                    metadata[key] = .boolean(false)
-                } else if let intVal = Int64(valStr) {
-                    metadata[key] = .integer(intVal)
-                } else if let doubleVal = Double(valStr) {
-                    metadata[key] = .floatingPoint(doubleVal)
-                } else {
-                    metadata[key] = .string(valStr)
-                }
-            } else {
-                // Reset status for non-critical errors
-                status = 0
+        var range: (minVal: Float32, maxVal: Float32) = (0, 0)
+        let pixels = try [Float32](unsafeUninitializedCapacity: pixelCount) { buffer, initializedCount in
+            initializedCount = 0
+            if let baseAddress = buffer.baseAddress {
+                range = try readPixelValues(file: file, count: pixelCount, into: baseAddress)
+                // Normalize pixel values to 0-1 range for Metal (in place, blank pixels stay NaN)
+                normalizePixels(baseAddress, baseAddress, pixelCount, range.minVal, range.maxVal)
             }
+            initializedCount = pixelCount
         }
         
-        return metadata
+        return (width, height, depth, pixels, bitpix, range.minVal, range.maxVal)
     }
     
-    /// Reads image data from the current HDU and converts it to Float32 array
-    /// - Returns: Tuple containing dimensions, pixel data, raw data, bitpix, and original value range
-    public func readImage() throws -> (width: Int, height: Int, depth: Int, pixels: [Float32], rawData: Data, bitpix: Int32, minVal: Float32, maxVal: Float32) {
+    /// Reads image data from the current HDU into a new shared pixel store
+    /// - Returns: Tuple containing dimensions, the pixel store in the original value range, bitpix, and that range
+    func readImageStore() throws -> (width: Int, height: Int, depth: Int, store: FITSPixelStore, bitpix: Int32, minVal: Float32, maxVal: Float32) {
         guard let file = fitsfile else {
             Logger.swiftfitsio.error("Attempted to read image from closed FITS file")
             throw FITSFileError.fileNotOpen
         }
         
-        Logger.swiftfitsio.debug("Reading FITS image data")
-        var status: Int32 = 0
-        var bitpix: Int32 = 0
-        var naxis: Int32 = 0
-        var naxes = [Int64](repeating: 0, count: 3)
-        
-        // Get image parameters
-        let naxesLong = [Int](repeating: 0, count: 3)
-        var naxesArray = naxesLong.map { Int64($0) }
-        _ = getImageParameters(file, 3, &bitpix, &naxis, &naxesArray, &status)
-        naxes = naxesArray
-        guard status == 0 else {
-            var errorText = [CChar](repeating: 0, count: 81)
-            getFITSErrorStatus(status, &errorText)
-            errorText[80] = 0
-            let errorString = String(cString: errorText)
-            Logger.swiftfitsio.error("Error getting image parameters: status \(status), \(errorString)")
-            throw FITSFileError.readError(status: status, message: errorString)
-        }
-        
-        let width = Int(naxes[0])
-        let height = naxis > 1 ? Int(naxes[1]) : 1
-        let depth = naxis > 2 ? Int(naxes[2]) : 1
+        let (width, height, depth, bitpix) = try readImageParameters()
+        let store = FITSPixelStore(count: width * height * depth)
+        let (minVal, maxVal) = try readPixelValues(file: file, count: store.count, into: store.pointer)
         
-        Logger.swiftfitsio.debug("Image dimensions: \(width)x\(height)x\(depth), bitpix=\(bitpix), naxis=\(naxis)")
+        return (width, height, depth, store, bitpix, minVal, maxVal)
+    }
+    
+    /// Reads the dimensions and BITPIX of the image in the current HDU
+    ///
+    /// Axes beyond the third are folded into `depth`, and the whole image must fit within
+    /// `maxAllocationBytes` as Float32.
+    private func readImageParameters() throws -> (width: Int, height: Int, depth: Int, bitpix: Int32) {
+        let geometry = try readImageGeometry()
+        try checkAllocation(count: geometry.pixelCount, stride: MemoryLayout<Float32>.stride)
         
-        // Calculate total pixels
-        var totalPixels: Int64 = 1
-        for i in 0..<Int(naxis) {
-            totalPixels *= naxes[i]
-        }
+        Logger.swiftfitsio.debug("Image dimensions: \(geometry.axes.map(String.init).joined(separator: "x")), bitpix=\(geometry.bitpix), naxis=\(geometry.naxis)")
         
+        return (geometry.width, geometry.height, geometry.depth, geometry.bitpix)
+    }
+    
+    /// Reads `count` pixels of the current HDU into `destination` in their original value range
+    ///
+    /// The pixels are read straight into the destination in chunks, and the value range of each
+    /// chunk is accumulated while it is still in cache, so no intermediate copies of the image
+    /// are made.
+    /// - Returns: The value range of the finite pixels
+    func readPixelValues(file: OpaquePointer, count pixelCount: Int, into destination: UnsafeMutablePointer<Float32>) throws -> (minVal: Float32, maxVal: Float32) {
         // Read image data - always read as Float32 for Metal compatibility
-        // CFITSIO will handle type conversion automatically
-        var floatBuffer = [Float32](repeating: 0, count: Int(totalPixels))
-        var nullval: Float32 = 0
-        var anynull: Int32 = 0
-        
         // Use TFLOAT (42) to read as float - CFITSIO handles conversion
-        // CFITSIO expects firstPixel and numElements as arrays (one element per dimension)
-        // For 2D image: firstPixel = [1, 1], numElements = [width, height]
         let TFLOAT: Int32 = 42
-        var firstPixelArray = [Int64](repeating: 1, count: Int(naxis))  // Start at pixel 1,1,1... (1-based)
-        var numElementsArray = [Int64](repeating: 0, count: Int(naxis))
-        for i in 0..<Int(naxis) {
-            numElementsArray[i] = naxes[i]  // Read all pixels in each dimension
+        // Chunk size in pixels: small enough for the range scan to hit cache after the read
+        let chunkSize = 1 << 18
+        var status: Int32 = 0
+        var nullval: Float32 = 0
+        var anynull: Int32 = 0
+        var minVal = Float32.greatestFiniteMagnitude
+        var maxVal = -Float32.greatestFiniteMagnitude
+        var finiteCount = 0
+        
+        var offset = 0
+        while offset < pixelCount {
+            let count = min(chunkSize, pixelCount - offset)
+            _ = readImageElements(file, TFLOAT, Int64(offset) + 1, Int64(count), &nullval, destination + offset, &anynull, &status)
+            guard status == 0 else {
+                let errorString = FITSFile.errorMessage(for: status)
+                Logger.swiftfitsio.error("Error reading image data: status \(status), \(errorString)")
+                throw FITSFileError.readError(status: status, message: errorString)
+            }
+            finiteCount += accumulateRange(destination + offset, count, &minVal, &maxVal)
+            offset += count
         }
-        Logger.swiftfitsio.debug("Reading image: firstPixel=\(firstPixelArray), numElements=\(numElementsArray), naxis=\(naxis), totalPixels=\(totalPixels)")
-        _ = readImageData(file, TFLOAT, naxis, &firstPixelArray, &numElementsArray, &nullval, &floatBuffer, &anynull, &status)
         
-        guard status == 0 else {
-            var errorText = [CChar](repeating: 0, count: 81)
-            getFITSErrorStatus(status, &errorText)
-            errorText[80] = 0
-            let errorString = String(cString: errorText)
-            Logger.swiftfitsio.error("Error reading image data: status \(status), \(errorString)")
-            throw FITSFileError.readError(status: status, message: errorString)
+        if finiteCount == 0 {
+            minVal = 0
+            maxVal = 0
         }
         
-        // Store raw data for reference
-        let rawData = floatBuffer.withUnsafeBytes { Data($0) }
+        Logger.swiftfitsio.debug("Successfully read image: \(pixelCount) pixels, value range [\(minVal), \(maxVal)]")
         
-        // Normalize pixel values to 0-1 range for Metal
-        let minVal = floatBuffer.min() ?? 0
-        let maxVal = floatBuffer.max() ?? 1
-        let range = maxVal - minVal
-        let normalizedPixels = range > 0 ? floatBuffer.map { ($0 - minVal) / range } : floatBuffer
-        
-        Logger.swiftfitsio.debug("Successfully read image: \(normalizedPixels.count) pixels, value range [\(minVal), \(maxVal)]")
-        
-        return (width, height, depth, normalizedPixels, rawData, bitpix, minVal, maxVal)
+        return (minVal, maxVal)
     }
     
     /// Reads a complete FITS image with metadata
@@ -370,12 +587,12 @@ extension FITSFile {
             try moveToHDU(hdu)
         }
         
-        // Read metadata
-        let metadata = try readHeader()
-        Logger.swiftfitsio.debug("Read \(metadata.count) header keywords")
+        // Read the header cards; keywords are indexed and decoded on first access
+        let header = FITSHeader(table: try readKeywordTable())
+        Logger.swiftfitsio.debug("Read \(header.count) header cards")
         
         // Read image data
-        let (width, height, depth, pixels, rawData, bitpix, minVal, maxVal) = try readImage()
+        let (width, height, depth, store, bitpix, minVal, maxVal) = try readImageStore()
         
         let dataType = try FITSDataType(bitpix: bitpix)
         
@@ -387,11 +604,10 @@ extension FITSFile {
             depth: depth,
             bitpix: bitpix,
             dataType: dataType,
-            pixelData: pixels,
-            rawData: rawData,
+            storage: store,
             originalMinValue: minVal,
             originalMaxValue: maxVal,
-            metadata: metadata
+            header: header
         )
     }
     
@@ -420,9 +636,20 @@ extension FITSImage {
         let region = MTLRegion(origin: MTLOrigin(x: 0, y: 0, z: 0),
                               size: MTLSize(width: width, height: height, depth: 1))
         
-        pixelData.withUnsafeBytes { bytes in
-            texture.replace(region: region, mipmapLevel: 0, withBytes: bytes.baseAddress!, bytesPerRow: width * MemoryLayout<Float32>.size)
+        // The store holds the original values, so upload a normalized copy of the first plane
+        let view = normalizedPixels
+        var normalized = [Float32](repeating: 0, count: width * height)
+        normalized.withUnsafeMutableBufferPointer { buffer in
+            for y in 0..<height {
+                view.copyRow(y, into: buffer.baseAddress! + y * width)
+            }
         }
+        texture.replace(
+            region: region,
+            mipmapLevel: 0,
+            withBytes: normalized,
+            bytesPerRow: width * MemoryLayout<Float32>.size
+        )
         
         return texture
     }
@@ -431,8 +658,13 @@ extension FITSImage {
     /// - Parameter device: The Metal device
     /// - Returns: A Metal buffer containing the pixel data
     public func createMetalBuffer(device: MTLDevice) -> MTLBuffer? {
-        let dataSize = pixelData.count * MemoryLayout<Float32>.size
-        return device.makeBuffer(bytes: pixelData, length: dataSize, options: [])
+        let view = normalizedPixels
+        let dataSize = view.count * MemoryLayout<Float32>.size
+        guard let buffer = device.makeBuffer(length: dataSize, options: [.storageModeShared]) else {
+            return nil
+        }
+        view.copy(into: buffer.contents().bindMemory(to: Float32.self, capacity: view.count))
+        return buffer
     }
     
     /// Gets the pixel value at the specified image coordinates
@@ -445,19 +677,8 @@ extension FITSImage {
             return nil
         }
         
-        // Pixel data is stored row by row (y * width + x)
-        let index = y * width + x
-        
-        guard index < pixelData.count else {
-            return nil
-        }
-        
-        // Convert normalized pixel value back to original range
-        let normalizedValue = pixelData[index]
-        let range = originalMaxValue - originalMinValue
-        let originalValue = range > 0 ? normalizedValue * range + originalMinValue : originalMinValue
-        
-        return originalValue
+        // The store holds the original values, so this is exact
+        return rawPixels[x, y]
     }
     
     /// Extracts a region around the specified pixel coordinates
@@ -481,26 +702,7 @@ extension FITSImage {
             return nil
         }
         
-        // Extract pixel data for the region (keep normalized values)
-        var regionPixels: [Float32] = []
-        regionPixels.reserveCapacity(regionWidth * regionHeight)
-        
-        for y in startY..<endY {
-            for x in startX..<endX {
-                let index = y * width + x
-                if index < pixelData.count {
-                    regionPixels.append(pixelData[index])
-                } else {
-                    // Pad with zero if out of bounds
-                    regionPixels.append(0.0)
-                }
-            }
-        }
-        
-        // Create raw data
-        let regionRawData = regionPixels.withUnsafeBytes { Data($0) }
-        
-        // Create new FITSImage with the extracted region
+        // The region is a view into the same store: no pixels are copied
         // Use the same original min/max values as the parent image to maintain consistent normalization
         return FITSImage(
             width: regionWidth,
@@ -508,57 +710,46 @@ extension FITSImage {
             depth: depth,
             bitpix: bitpix,
             dataType: dataType,
-            pixelData: regionPixels,
-            rawData: regionRawData,
+            storage: storage,
+            storageOffset: storageOffset + startY * rowStride + startX,
+            rowStride: rowStride,
+            planeStride: planeStride,
             originalMinValue: originalMinValue,
             originalMaxValue: originalMaxValue,
-            metadata: metadata
+            header: header
         )
     }
     
     /// Gets cross-section data along the center X-axis (horizontal line through center)
-    /// - Returns: Array of pixel values along the center row, converted to original value range
+    /// - Returns: Array of pixel values along the center row, in the original value range
     public func getCenterXCrossSection() -> [Float] {
-        let centerY = height / 2
-        var values: [Float] = []
-        values.reserveCapacity(width)
-        
-        let range = originalMaxValue - originalMinValue
+        guard width > 0 && height > 0 else {
+            return []
+        }
         
-        for x in 0..<width {
-            let index = centerY * width + x
-            if index < pixelData.count {
-                let normalizedValue = pixelData[index]
-                // Convert to original value range
-                let originalValue = range > 0 ? Float(normalizedValue) * range + originalMinValue : originalMinValue
-                values.append(originalValue)
-            } else {
-                values.append(originalMinValue)
+        // Copy the center row straight out of the store
+        return [Float](unsafeUninitializedCapacity: width) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress {
+                rawPixels.copyRow(height / 2, into: baseAddress)
             }
+            initializedCount = width
         }
-        
-        return values
     }
     
     /// Gets cross-section data along the center Y-axis (vertical line through center)
-    /// - Returns: Array of pixel values along the center column, converted to original value range
+    /// - Returns: Array of pixel values along the center column, in the original value range
     public func getCenterYCrossSection() -> [Float] {
+        guard width > 0 else {
+            return []
+        }
+        
         let centerX = width / 2
+        let view = rawPixels
         var values: [Float] = []
         values.reserveCapacity(height)
         
-        let range = originalMaxValue - originalMinValue
-        
         for y in 0..<height {
-            let index = y * width + centerX
-            if index < pixelData.count {
-                let normalizedValue = pixelData[index]
-                // Convert to original value range
-                let originalValue = range > 0 ? Float(normalizedValue) * range + originalMinValue : originalMinValue
-                values.append(originalValue)
-            } else {
-                values.append(originalMinValue)
-            }
+            values.append(view[centerX, y])
         }
         
         return values
@@ -667,15 +858,10 @@ extension FITSImage {
         
         // Get pixel value
         Logger.swiftfitsio.debug("getPixelValue: x=\(pixelX), y=\(pixelY), imageSize=(\(width), \(height))")
-        let index = pixelY * width + pixelX
-        Logger.swiftfitsio.debug("index=\(index), pixelData.count=\(pixelData.count)")
-        
-        guard index < pixelData.count else {
-            Logger.swiftfitsio.error("Index out of range")
-            return
-        }
+        let index = storageOffset + pixelY * rowStride + pixelX
+        Logger.swiftfitsio.debug("index=\(index), storage.count=\(storage.count)")
         
-        let normalizedValue = pixelData[index]
+        let normalizedValue = normalizedPixels[pixelX, pixelY]
         let range = originalMaxValue - originalMinValue
         let originalValue = range > 0 ? normalizedValue * range + originalMinValue : originalMinValue
         Logger.swiftfitsio.debug("normalizedValue=\(normalizedValue), range=\(range)")
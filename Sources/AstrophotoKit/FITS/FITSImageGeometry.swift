@@ -0,0 +1,170 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_read_pixll_wrapper")
+func readPixelsAtCoordinates(_ fptr: OpaquePointer?, _ dataType: Int32, _ firstPixel: UnsafeMutablePointer<Int64>, _ numElements: Int64, _ nullValue: UnsafeMutableRawPointer?, _ array: UnsafeMutableRawPointer, _ anyNull: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+/// Dimensions and element type of the image in an HDU, for any number of axes
+///
+/// All axis lengths and the pixel count are 64-bit. Images with more than three axes are
+/// presented as a stack of `depth` planes, where `depth` is the product of all axes beyond
+/// the second; the original axes are kept in `axes`.
+public struct FITSImageGeometry: Equatable {
+    /// Maximum number of axes allowed by the FITS standard
+    public static let maxAxes = 999
+
+    /// BITPIX of the data unit
+    public let bitpix: Int32
+
+    /// Length of every axis (NAXIS1, NAXIS2, ...)
+    public let axes: [Int]
+
+    /// Total number of pixels
+    public let pixelCount: Int
+
+    /// Creates a geometry, checking that the pixel count fits in 64 bits
+    /// - Parameters:
+    ///   - bitpix: BITPIX of the data unit
+    ///   - axes: Axis lengths
+    /// - Throws: An error if the pixel count overflows
+    public init(bitpix: Int32, axes: [Int]) throws {
+        var pixelCount = axes.isEmpty ? 0 : 1
+        for length in axes {
+            let (product, overflow) = pixelCount.multipliedReportingOverflow(by: length)
+            guard !overflow, length >= 0 else {
+                throw FITSFileError.readError(status: -1, message: "Image dimensions \(axes) are out of range")
+            }
+            pixelCount = product
+        }
+        self.bitpix = bitpix
+        self.axes = axes
+        self.pixelCount = pixelCount
+    }
+
+    /// Number of axes (NAXIS)
+    public var naxis: Int {
+        axes.count
+    }
+
+    /// Image width in pixels (0 if the HDU has no image)
+    public var width: Int {
+        axes.first ?? 0
+    }
+
+    /// Image height in pixels
+    public var height: Int {
+        axes.count > 1 ? axes[1] : 1
+    }
+
+    /// Number of planes; all axes beyond the second are folded into planes
+    public var depth: Int {
+        axes.count > 2 ? axes[2...].reduce(1, *) : 1
+    }
+
+    /// Number of bytes per stored pixel
+    public var bytesPerPixel: Int {
+        Int(abs(bitpix)) / 8
+    }
+
+    /// Converts a plane index to coordinates along the axes beyond the second (0-based)
+    public func planeCoordinates(_ plane: Int) -> [Int] {
+        var remainder = plane
+        return axes.dropFirst(2).map { length in
+            defer { remainder /= length }
+            return remainder % length
+        }
+    }
+}
+
+/// Extension to FITSFile for image geometry and coordinate-addressed reads
+extension FITSFile {
+    /// Default for `maxAllocationBytes`: 16 GiB
+    public static let defaultMaxAllocationBytes = 1 << 34
+
+    /// Reads the dimensions and BITPIX of the image in the current HDU
+    /// - Returns: The image geometry with all axes
+    /// - Throws: An error if the image parameters cannot be read
+    public func readImageGeometry() throws -> FITSImageGeometry {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        var status: Int32 = 0
+        var bitpix: Int32 = 0
+        var naxis: Int32 = 0
+        var naxes = [Int64](repeating: 0, count: FITSImageGeometry.maxAxes)
+        _ = getImageParameters(file, Int32(FITSImageGeometry.maxAxes), &bitpix, &naxis, &naxes, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error getting image parameters: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+
+        return try FITSImageGeometry(bitpix: bitpix, axes: naxes.prefix(Int(naxis)).map { Int($0) })
+    }
+
+    /// Throws if an allocation of `byteCount` bytes would exceed `maxAllocationBytes`
+    func checkAllocation(byteCount: Int) throws {
+        guard byteCount <= maxAllocationBytes else {
+            Logger.swiftfitsio.error("Refusing to allocate \(byteCount) bytes (limit \(self.maxAllocationBytes))")
+            throw FITSFileError.allocationTooLarge(bytes: byteCount, limit: maxAllocationBytes)
+        }
+    }
+
+    /// Throws if an allocation of `count` elements of `stride` bytes would overflow or exceed `maxAllocationBytes`
+    /// - Returns: The allocation size in bytes
+    @discardableResult
+    func checkAllocation(count: Int, stride: Int) throws -> Int {
+        let (byteCount, overflow) = count.multipliedReportingOverflow(by: stride)
+        guard !overflow else {
+            Logger.swiftfitsio.error("Refusing to allocate \(count) elements of \(stride) bytes: size overflows")
+            throw FITSFileError.allocationTooLarge(bytes: .max, limit: maxAllocationBytes)
+        }
+        try checkAllocation(byteCount: byteCount)
+        return byteCount
+    }
+
+    /// Reads a run of pixels starting at the given coordinates, as physical Float32 values
+    ///
+    /// Pixels are read in storage order, so a run may continue across rows and planes.
+    /// - Parameters:
+    ///   - coordinates: 0-based coordinates of the first pixel, one per axis
+    ///   - count: Number of pixels to read
+    ///   - destination: Buffer receiving `count` values
+    /// - Throws: An error if the coordinates are invalid or the pixels cannot be read
+    public func readPixels(at coordinates: [Int], count: Int, into destination: UnsafeMutablePointer<Float32>) throws {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        let geometry = try readImageGeometry()
+        guard coordinates.count == geometry.naxis,
+              zip(coordinates, geometry.axes).allSatisfy({ $0 >= 0 && $0 < $1 }) else {
+            throw FITSFileError.readError(status: -1, message: "Coordinates \(coordinates) are outside image \(geometry.axes)")
+        }
+
+        // Linear index of the first pixel, to check that the run stays inside the image
+        var linear = 0
+        for (coordinate, length) in zip(coordinates, geometry.axes).reversed() {
+            linear = linear * length + coordinate
+        }
+        guard count >= 0, linear + count <= geometry.pixelCount else {
+            throw FITSFileError.readError(status: -1, message: "Pixel run exceeds image size")
+        }
+
+        // Use TFLOAT (42) so that CFITSIO applies BZERO/BSCALE while converting
+        let TFLOAT: Int32 = 42
+        var status: Int32 = 0
+        var nullval: Float32 = 0
+        var anynull: Int32 = 0
+        // CFITSIO coordinates are 1-based
+        var firstPixel = coordinates.map { Int64($0) + 1 }
+        _ = readPixelsAtCoordinates(file, TFLOAT, &firstPixel, Int64(count), &nullval, destination, &anynull, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error reading pixels at \(coordinates): status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+    }
+}
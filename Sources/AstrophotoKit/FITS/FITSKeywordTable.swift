@@ -0,0 +1,190 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_hdr2str_wrapper")
+func readHeaderString(_ fptr: OpaquePointer?, _ header: UnsafeMutablePointer<UnsafeMutablePointer<CChar>?>, _ numKeys: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_free_memory_wrapper")
+func freeFITSMemory(_ memory: UnsafeMutableRawPointer?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("apk_scan_header")
+func scanHeaderCards(_ header: UnsafePointer<UInt8>?, _ maxCards: Int, _ fields: UnsafeMutablePointer<Int32>?) -> Int
+
+/// The header cards of one HDU, parsed in a single pass into a compact table
+///
+/// The table keeps the raw header text and, per card, the byte ranges of the keyword,
+/// value and comment together with the value's lexical kind. Strings and
+/// `FITSHeaderValue`s are only created for the cards that are actually requested,
+/// so looking up a few keywords in a large header is cheap.
+public struct FITSKeywordTable {
+    /// Lexical kind of a card's value, as classified by the scanner
+    public enum ValueKind: Int32 {
+        /// Commentary card without a value (COMMENT, HISTORY, blank keyword, ...)
+        case none = 0
+        case string = 1
+        case integer = 2
+        case floatingPoint = 3
+        case logical = 4
+        /// Undefined or unrecognized value (e.g. complex numbers)
+        case other = 5
+    }
+
+    /// Number of int32 fields the scanner writes per card
+    static let fieldsPerCard = 7
+
+    /// Length of a header card in bytes
+    static let cardLength = 80
+
+    /// Raw header text, 80 bytes per card
+    private let text: [UInt8]
+
+    /// Per-card fields: keyword offset/length, kind, value offset/length, comment offset/length
+    private let fields: [Int32]
+
+    /// Number of cards in the table (the END card is not included)
+    public let count: Int
+
+    /// Parses header text consisting of consecutive 80-byte cards
+    /// - Parameter text: The header text; scanning stops at the END card
+    public init(text: [UInt8]) {
+        let maxCards = text.count / FITSKeywordTable.cardLength
+        var fields = [Int32](repeating: 0, count: maxCards * FITSKeywordTable.fieldsPerCard)
+        let count = text.withUnsafeBufferPointer { header in
+            fields.withUnsafeMutableBufferPointer { output in
+                scanHeaderCards(header.baseAddress, maxCards, output.baseAddress)
+            }
+        }
+        self.text = text
+        self.fields = Array(fields.prefix(count * FITSKeywordTable.fieldsPerCard))
+        self.count = count
+    }
+
+    /// Returns the raw 80-character text of a card
+    public func card(at index: Int) -> String {
+        let start = index * FITSKeywordTable.cardLength
+        return String(decoding: text[start..<(start + FITSKeywordTable.cardLength)], as: UTF8.self)
+    }
+
+    /// Returns the keyword of a card
+    public func keyword(at index: Int) -> String {
+        let base = index * FITSKeywordTable.fieldsPerCard
+        return string(offset: fields[base], length: fields[base + 1])
+    }
+
+    /// Returns the lexical kind of a card's value
+    public func valueKind(at index: Int) -> ValueKind {
+        return ValueKind(rawValue: fields[index * FITSKeywordTable.fieldsPerCard + 2]) ?? .other
+    }
+
+    /// Returns the comment of a card (the free text for commentary cards)
+    public func comment(at index: Int) -> String {
+        let base = index * FITSKeywordTable.fieldsPerCard
+        return string(offset: fields[base + 5], length: fields[base + 6])
+    }
+
+    /// Returns the value of a card
+    ///
+    /// Commentary cards are returned as `.comment` with their text. Values that are
+    /// neither strings, numbers nor logicals are returned verbatim as `.string`.
+    public func value(at index: Int) -> FITSHeaderValue {
+        let base = index * FITSKeywordTable.fieldsPerCard
+        let token = string(offset: fields[base + 3], length: fields[base + 4])
+
+        switch valueKind(at: index) {
+        case .none:
+            return .comment(comment(at: index))
+        case .string:
+            return .string(token.replacingOccurrences(of: "''", with: "'"))
+        case .integer:
+            if let value = Int64(token) {
+                return .integer(value)
+            }
+            // Integers beyond 64 bits are kept as floating point
+            return .floatingPoint(Double(token) ?? 0)
+        case .floatingPoint:
+            // FITS allows Fortran-style D exponents
+            let normalized = token.replacingOccurrences(of: "D", with: "E").replacingOccurrences(of: "d", with: "e")
+            return Double(normalized).map { .floatingPoint($0) } ?? .string(token)
+        case .logical:
+            return .boolean(token == "T")
+        case .other:
+            return .string(token)
+        }
+    }
+
+    /// Returns the index of the first card with the given keyword
+    /// - Parameter keyword: The keyword to look up (case sensitive, as stored)
+    /// - Returns: The card index, or nil if no card has that keyword
+    public func index(of keyword: String) -> Int? {
+        let key = Array(keyword.utf8)
+        return text.withUnsafeBufferPointer { header in
+            for index in 0..<count {
+                let base = index * FITSKeywordTable.fieldsPerCard
+                guard Int(fields[base + 1]) == key.count else {
+                    continue
+                }
+                let offset = Int(fields[base])
+                if memcmp(header.baseAddress! + offset, key, key.count) == 0 {
+                    return index
+                }
+            }
+            return nil
+        }
+    }
+
+    /// Returns the value of the first card with the given keyword
+    public func value(for keyword: String) -> FITSHeaderValue? {
+        return index(of: keyword).map { value(at: $0) }
+    }
+
+    /// Converts the table into a keyword dictionary
+    ///
+    /// Cards with a blank keyword are skipped; for repeated keywords the last card wins.
+    public func dictionary() -> [String: FITSHeaderValue] {
+        var metadata: [String: FITSHeaderValue] = [:]
+        metadata.reserveCapacity(count)
+        for index in 0..<count where fields[index * FITSKeywordTable.fieldsPerCard + 1] > 0 {
+            metadata[keyword(at: index)] = value(at: index)
+        }
+        return metadata
+    }
+
+    private func string(offset: Int32, length: Int32) -> String {
+        let start = Int(offset)
+        return String(decoding: text[start..<(start + Int(length))], as: UTF8.self)
+    }
+}
+
+/// Extension to FITSFile for bulk header access
+extension FITSFile {
+    /// Reads all header cards of the current HDU with a single CFITSIO call
+    /// - Returns: The parsed keyword table
+    /// - Throws: An error if the header cannot be read
+    public func readKeywordTable() throws -> FITSKeywordTable {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        var status: Int32 = 0
+        var header: UnsafeMutablePointer<CChar>?
+        var numKeys: Int32 = 0
+        _ = readHeaderString(file, &header, &numKeys, &status)
+        defer {
+            var freeStatus: Int32 = 0
+            _ = freeFITSMemory(header, &freeStatus)
+        }
+        guard status == 0, let header = header else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error reading header: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+
+        let byteCount = Int(numKeys) * FITSKeywordTable.cardLength
+        let text = header.withMemoryRebound(to: UInt8.self, capacity: byteCount) { bytes in
+            [UInt8](UnsafeBufferPointer(start: bytes, count: byteCount))
+        }
+        return FITSKeywordTable(text: text)
+    }
+}
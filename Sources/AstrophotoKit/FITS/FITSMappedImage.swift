@@ -0,0 +1,264 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_get_hduaddrll_wrapper")
+func getHDUAddress(_ fptr: OpaquePointer?, _ headStart: UnsafeMutablePointer<Int64>, _ dataStart: UnsafeMutablePointer<Int64>, _ dataEnd: UnsafeMutablePointer<Int64>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_is_compressed_image_wrapper")
+func isCompressedImage(_ fptr: OpaquePointer?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("apk_convert_be_i16_to_f32")
+func convertBigEndianInt16ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_be_i32_to_f32")
+func convertBigEndianInt32ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_be_i64_to_f32")
+func convertBigEndianInt64ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_be_f32_to_f32")
+func convertBigEndianFloat32ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_be_f64_to_f32")
+func convertBigEndianFloat64ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+/// Converts big-endian FITS pixels of any BITPIX to physical Float32 values
+/// - Parameters:
+///   - source: The stored pixels, as they appear in the data unit
+///   - bitpix: BITPIX of the data unit
+///   - count: Number of pixels to convert
+///   - scale: BSCALE of the data unit
+///   - zero: BZERO of the data unit
+///   - destination: Buffer receiving `count` values; must not overlap `source`
+func convertBigEndianPixels(_ source: UnsafeRawPointer, bitpix: Int32, count: Int, scale: Double, zero: Double, into destination: UnsafeMutablePointer<Float32>) {
+    switch bitpix {
+    case 8:
+        convertUInt8ToFloat32(source.assumingMemoryBound(to: UInt8.self), destination, count, scale, zero)
+    case 16:
+        convertBigEndianInt16ToFloat32(source, destination, count, scale, zero)
+    case 32:
+        convertBigEndianInt32ToFloat32(source, destination, count, scale, zero)
+    case 64:
+        convertBigEndianInt64ToFloat32(source, destination, count, scale, zero)
+    case -32:
+        convertBigEndianFloat32ToFloat32(source, destination, count, scale, zero)
+    case -64:
+        convertBigEndianFloat64ToFloat32(source, destination, count, scale, zero)
+    default:
+        preconditionFailure("Unsupported BITPIX \(bitpix)")
+    }
+}
+
+/// A read-only, memory-mapped view of an uncompressed FITS image data unit
+///
+/// The file is mapped with `mmap` and pixels are byte-swapped and scaled only when they are
+/// accessed, so opening even a multi-gigabyte cube costs nothing up front and previews or
+/// statistics only page in the parts of the file they touch.
+///
+/// Values are physical values (`BZERO + BSCALE * stored`). Integer BLANK values are not
+/// translated to NaN; use `FITSFile.readNormalizedImage()` when blank handling is needed.
+public final class FITSMappedImage {
+    /// Image dimensions
+    public let width: Int
+    public let height: Int
+    public let depth: Int
+
+    /// BITPIX of the data unit
+    public let bitpix: Int32
+
+    /// Scale factor applied to stored values (BSCALE)
+    public let bscale: Double
+
+    /// Offset applied to stored values (BZERO)
+    public let bzero: Double
+
+    /// Byte offset of the data unit in the file
+    public let dataOffset: Int
+
+    /// Number of pixels in the image
+    public var count: Int {
+        width * height * depth
+    }
+
+    /// Number of bytes per stored pixel
+    public var bytesPerPixel: Int {
+        Int(abs(bitpix)) / 8
+    }
+
+    private let mapping: UnsafeMutableRawPointer
+    private let mappingLength: Int
+    private let data: UnsafeRawPointer
+
+    /// Maps the data unit of an image in a file
+    /// - Parameters:
+    ///   - path: Path of the FITS file
+    ///   - dataOffset: Byte offset of the data unit, as reported by CFITSIO
+    ///   - width: Image width in pixels
+    ///   - height: Image height in pixels
+    ///   - depth: Number of image planes
+    ///   - bitpix: BITPIX of the data unit
+    ///   - bscale: BSCALE of the data unit
+    ///   - bzero: BZERO of the data unit
+    /// - Throws: An error if the file cannot be mapped or is too short for the data unit
+    init(path: String, dataOffset: Int, width: Int, height: Int, depth: Int, bitpix: Int32, bscale: Double, bzero: Double) throws {
+        let descriptor = open(path, O_RDONLY)
+        guard descriptor >= 0 else {
+            let message = String(cString: strerror(errno))
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: message)
+        }
+        defer { close(descriptor) }
+
+        var fileStatus = stat()
+        guard fstat(descriptor, &fileStatus) == 0 else {
+            let message = String(cString: strerror(errno))
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: message)
+        }
+
+        let dataLength = width * height * depth * (Int(abs(bitpix)) / 8)
+        let mappingLength = dataOffset + dataLength
+        guard dataLength > 0, mappingLength <= Int(fileStatus.st_size) else {
+            throw FITSFileError.readError(status: -1, message: "Data unit of \(dataLength) bytes at offset \(dataOffset) exceeds file size \(fileStatus.st_size)")
+        }
+
+        // Map from the start of the file so that the mapping offset is page aligned
+        guard let mapping = mmap(nil, mappingLength, PROT_READ, MAP_PRIVATE, descriptor, 0),
+              mapping != UnsafeMutableRawPointer(bitPattern: -1) else {
+            let message = String(cString: strerror(errno))
+            Logger.swiftfitsio.error("Failed to map FITS file at \(path): \(message)")
+            throw FITSFileError.readError(status: -1, message: message)
+        }
+
+        // A gzip-compressed file opened through CFITSIO reports offsets into the
+        // decompressed stream, which do not match the file on disk
+        guard mappingLength >= 6, memcmp(mapping, "SIMPLE", 6) == 0 else {
+            munmap(mapping, mappingLength)
+            throw FITSFileError.readError(status: -1, message: "File is not an uncompressed FITS file")
+        }
+
+        self.mapping = mapping
+        self.mappingLength = mappingLength
+        self.data = UnsafeRawPointer(mapping + dataOffset)
+        self.dataOffset = dataOffset
+        self.width = width
+        self.height = height
+        self.depth = depth
+        self.bitpix = bitpix
+        self.bscale = bscale
+        self.bzero = bzero
+
+        Logger.swiftfitsio.debug("Mapped \(width)x\(height)x\(depth) image (bitpix=\(bitpix)) at offset \(dataOffset) of \(path)")
+    }
+
+    deinit {
+        munmap(mapping, mappingLength)
+    }
+
+    /// Converts a range of pixels to physical Float32 values
+    /// - Parameters:
+    ///   - range: Range of linear pixel indices to convert
+    ///   - destination: Buffer receiving `range.count` values
+    public func convertToFloat32(range: Range<Int>, into destination: UnsafeMutablePointer<Float32>) {
+        precondition(range.lowerBound >= 0 && range.upperBound <= count, "Pixel range out of bounds")
+        convertBigEndianPixels(data + range.lowerBound * bytesPerPixel, bitpix: bitpix, count: range.count, scale: bscale, zero: bzero, into: destination)
+    }
+
+    /// Returns the physical value of a single pixel
+    public subscript(x: Int, y: Int, z: Int = 0) -> Float32 {
+        precondition(x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth, "Pixel coordinates out of range")
+        let index = (z * height + y) * width + x
+        var value: Float32 = 0
+        convertToFloat32(range: index..<(index + 1), into: &value)
+        return value
+    }
+
+    /// Converts one row to physical Float32 values
+    /// - Parameters:
+    ///   - y: Row index
+    ///   - z: Plane index
+    ///   - destination: Buffer receiving `width` values
+    public func copyRow(_ y: Int, plane z: Int = 0, into destination: UnsafeMutablePointer<Float32>) {
+        precondition(y >= 0 && y < height && z >= 0 && z < depth, "Row out of range")
+        let start = (z * height + y) * width
+        convertToFloat32(range: start..<(start + width), into: destination)
+    }
+
+    /// Returns all pixels as physical Float32 values
+    public func float32Pixels() -> [Float32] {
+        return [Float32](unsafeUninitializedCapacity: count) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress {
+                convertToFloat32(range: 0..<count, into: baseAddress)
+            }
+            initializedCount = count
+        }
+    }
+
+    /// Computes statistics of the image, converting at most `rowsPerChunk` rows at a time
+    /// - Parameter rowsPerChunk: Number of rows converted per band (default: 256)
+    /// - Returns: Statistics of the physical pixel values
+    public func statistics(rowsPerChunk: Int = 256) -> FITSImageStatistics {
+        let bandSize = max(1, rowsPerChunk) * width
+        let buffer = UnsafeMutableBufferPointer<Float32>.allocate(capacity: bandSize)
+        defer { buffer.deallocate() }
+
+        var accumulator = FITSStatisticsAccumulator()
+        var start = 0
+        while start < count {
+            let end = min(start + bandSize, count)
+            convertToFloat32(range: start..<end, into: buffer.baseAddress!)
+            accumulator.add(UnsafeBufferPointer(rebasing: buffer[0..<(end - start)]))
+            start = end
+        }
+        return accumulator.statistics
+    }
+}
+
+/// Extension to FITSFile for memory-mapped image access
+extension FITSFile {
+    /// Maps the image data unit of the current HDU directly from disk
+    ///
+    /// Only uncompressed images in plain disk files can be mapped; tile-compressed images,
+    /// gzip-compressed files and files opened from memory must be read through `readNormalizedImage()`.
+    /// - Returns: A lazily converted view of the image pixels
+    /// - Throws: An error if the HDU cannot be mapped
+    public func mapImage() throws -> FITSMappedImage {
+        guard let file = fitsfile else {
+            Logger.swiftfitsio.error("Attempted to map image from closed FITS file")
+            throw FITSFileError.fileNotOpen
+        }
+
+        let geometry = try readImageGeometry()
+        var status: Int32 = 0
+        let compressed = isCompressedImage(file, &status)
+        var headStart: Int64 = 0
+        var dataStart: Int64 = 0
+        var dataEnd: Int64 = 0
+        _ = getHDUAddress(file, &headStart, &dataStart, &dataEnd, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error getting image layout: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+        guard geometry.naxis > 0 else {
+            throw FITSFileError.readError(status: -1, message: "HDU contains no image data")
+        }
+        guard compressed == 0 else {
+            throw FITSFileError.readError(status: -1, message: "Tile-compressed images cannot be mapped")
+        }
+        guard memoryBuffer == nil else {
+            throw FITSFileError.readError(status: -1, message: "Files opened from memory cannot be mapped")
+        }
+
+        return try FITSMappedImage(
+            path: path,
+            dataOffset: Int(dataStart),
+            width: geometry.width,
+            height: geometry.height,
+            depth: geometry.depth,
+            bitpix: geometry.bitpix,
+            bscale: try readDoubleKeyword("BSCALE") ?? 1.0,
+            bzero: try readDoubleKeyword("BZERO") ?? 0.0
+        )
+    }
+}
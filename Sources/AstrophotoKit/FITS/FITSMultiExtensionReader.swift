@@ -0,0 +1,146 @@
+import Foundation
+import Metal
+import os
+
+/// Extension to FITSFile for loading the HDUs of multi-extension files (MEF) concurrently
+extension FITSFile {
+    /// Reads several image HDUs concurrently, e.g. the CCDs of a mosaic exposure
+    ///
+    /// Headers and geometries are read first and the pixel stores of all HDUs are allocated
+    /// up front. Workers, each with its own CFITSIO handle, then read whole HDUs
+    /// straight into their stores, largest first. The current HDU of this handle is not
+    /// changed.
+    /// - Parameters:
+    ///   - hduNumbers: HDUs to read (nil = every HDU that contains an image)
+    ///   - maxConcurrency: Maximum number of HDUs read at the same time (default: number of active cores)
+    /// - Returns: The images, in the order of `hduNumbers` (or file order)
+    /// - Throws: An error if an HDU has no image, the stores together would exceed
+    ///   `maxAllocationBytes`, or an HDU cannot be read
+    public func readFITSImages(hduNumbers: [Int]? = nil, maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws -> [FITSImage] {
+        return try readImageHDUs(hduNumbers: hduNumbers, maxConcurrency: maxConcurrency).map { $0.image }
+    }
+
+    /// Reads several image HDUs concurrently into one container of processed images
+    ///
+    /// Each image holds its normalized pixels in a buffer and is named after its EXTNAME, or
+    /// its HDU number if it has none. Textures are only created if a device is given;
+    /// otherwise `metalTexture(device:)` creates them on first use.
+    /// - Parameters:
+    ///   - hduNumbers: HDUs to read (nil = every HDU that contains an image)
+    ///   - device: The Metal device for the image textures (nil = no textures)
+    ///   - maxConcurrency: Maximum number of HDUs read at the same time (default: number of active cores)
+    /// - Returns: A container with one image per HDU, in the order of `hduNumbers` (or file order)
+    /// - Throws: An error if an HDU cannot be read or a texture cannot be created
+    public func readProcessedImages(hduNumbers: [Int]? = nil, device: MTLDevice? = nil, maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws -> ProcessedDataContainer {
+        let images = try readImageHDUs(hduNumbers: hduNumbers, maxConcurrency: maxConcurrency).map { hdu, fitsImage -> ProcessedImage in
+            let image = ProcessedImage(
+                buffer: ImageBuffer(fitsImage: fitsImage),
+                imageType: .grayscale,
+                originalMinValue: fitsImage.originalMinValue,
+                originalMaxValue: fitsImage.originalMaxValue,
+                fitsImage: fitsImage,
+                name: fitsImage.header["EXTNAME"]?.stringValue ?? "HDU \(hdu)"
+            )
+            if let device = device {
+                _ = try image.metalTexture(device: device)
+            }
+            return image
+        }
+
+        return ProcessedDataContainer(images: images, name: (path as NSString).lastPathComponent)
+    }
+
+    /// Reads the selected image HDUs concurrently, returning each image with its HDU number
+    private func readImageHDUs(hduNumbers: [Int]?, maxConcurrency: Int) throws -> [(hdu: Int, image: FITSImage)] {
+        let planner = try openAnotherHandle()
+        var selected: [(hdu: Int, geometry: FITSImageGeometry, header: FITSHeader)] = []
+
+        for hdu in try hduNumbers ?? Array(0..<numberOfHDUs()) {
+            try planner.moveToHDU(hdu)
+            // Tables have no image parameters; they are skipped when scanning the whole file
+            guard let geometry = try? planner.readImageGeometry(), geometry.naxis > 0 else {
+                if hduNumbers != nil {
+                    throw FITSFileError.readError(status: -1, message: "HDU \(hdu) contains no image data")
+                }
+                continue
+            }
+            selected.append((hdu, geometry, FITSHeader(table: try planner.readKeywordTable())))
+        }
+        try planner.close()
+
+        var totalBytes = 0
+        for entry in selected {
+            let byteCount = try checkAllocation(count: entry.geometry.pixelCount, stride: MemoryLayout<Float32>.stride)
+            let (sum, overflow) = totalBytes.addingReportingOverflow(byteCount)
+            guard !overflow else {
+                throw FITSFileError.allocationTooLarge(bytes: .max, limit: maxAllocationBytes)
+            }
+            totalBytes = sum
+        }
+        try checkAllocation(byteCount: totalBytes)
+
+        let stores = selected.map { FITSPixelStore(count: $0.geometry.pixelCount) }
+        var ranges = [(minVal: Float32, maxVal: Float32)](repeating: (0, 0), count: selected.count)
+        let order = selected.indices.sorted { selected[$0].geometry.pixelCount > selected[$1].geometry.pixelCount }
+        let workerCount = max(1, min(maxConcurrency, selected.count))
+
+        let lock = NSLock()
+        var nextItem = 0
+        var firstError: Error?
+
+        Logger.swiftfitsio.debug("Reading \(selected.count) HDUs (\(totalBytes) bytes) from \(self.path) on \(workerCount) workers")
+
+        DispatchQueue.concurrentPerform(iterations: workerCount) { _ in
+            do {
+                let worker = try self.openAnotherHandle()
+                guard let workerFile = worker.fitsfile else {
+                    throw FITSFileError.fileNotOpen
+                }
+
+                while true {
+                    lock.lock()
+                    let item = nextItem
+                    nextItem += 1
+                    let failed = firstError != nil
+                    lock.unlock()
+                    guard item < order.count, !failed else {
+                        break
+                    }
+
+                    let index = order[item]
+                    try worker.moveToHDU(selected[index].hdu)
+                    let range = try worker.readPixelValues(file: workerFile, count: stores[index].count, into: stores[index].pointer)
+
+                    lock.lock()
+                    ranges[index] = range
+                    lock.unlock()
+                }
+            } catch {
+                lock.lock()
+                if firstError == nil {
+                    firstError = error
+                }
+                lock.unlock()
+            }
+        }
+
+        if let error = firstError {
+            throw error
+        }
+
+        return try selected.indices.map { index in
+            let (hdu, geometry, header) = selected[index]
+            return (hdu, FITSImage(
+                width: geometry.width,
+                height: geometry.height,
+                depth: geometry.depth,
+                bitpix: geometry.bitpix,
+                dataType: try FITSDataType(bitpix: geometry.bitpix),
+                storage: stores[index],
+                originalMinValue: ranges[index].minVal,
+                originalMaxValue: ranges[index].maxVal,
+                header: header
+            ))
+        }
+    }
+}
@@ -0,0 +1,140 @@
+import Foundation
+import os
+
+/// Extension to FITSFile for decompressing tile-compressed images on multiple cores
+extension FITSFile {
+    /// Reads a tile-compressed image (e.g. fpack'd `.fits.fz`) by decompressing its tiles in parallel
+    ///
+    /// CFITSIO decompresses tiles serially on a single handle. Here the image is split into bands
+    /// of whole tile rows (ZTILE2) and every worker opens its own CFITSIO handle on the file,
+    /// so bands are decompressed concurrently straight into the final pixel store. The value
+    /// range is accumulated per band.
+    ///
+    /// Uncompressed images are read with `readFITSImage(hduNumber:)`.
+    /// - Parameters:
+    ///   - hduNumber: Optional HDU number (nil = current HDU)
+    ///   - maxConcurrency: Maximum number of worker handles (default: number of active cores)
+    /// - Returns: FITSImage structure
+    public func readFITSImageParallel(hduNumber: Int? = nil, maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount) throws -> FITSImage {
+        guard let file = fitsfile else {
+            Logger.swiftfitsio.error("Attempted to read image from closed FITS file")
+            throw FITSFileError.fileNotOpen
+        }
+
+        if let hdu = hduNumber {
+            try moveToHDU(hdu)
+        }
+
+        var status: Int32 = 0
+        let compressed = isCompressedImage(file, &status) != 0
+        guard compressed, maxConcurrency > 1 else {
+            return try readFITSImage()
+        }
+
+        let hdu = try currentHDU()
+        let header = FITSHeader(table: try readKeywordTable())
+        let geometry = try readImageGeometry()
+        try checkAllocation(count: geometry.pixelCount, stride: MemoryLayout<Float32>.stride)
+
+        // Bands are whole tile rows, so no tile is decompressed by two workers. Tile rows restart
+        // in every plane, so if they do not divide the plane height, or tiles span several
+        // planes, bands are made of whole tile planes instead.
+        let rowCount = geometry.height * geometry.depth
+        var tileRows = max(1, Int(try readDoubleKeyword("ZTILE2") ?? 1))
+        let tilePlanes = max(1, Int(try readDoubleKeyword("ZTILE3") ?? 1))
+        if geometry.depth > 1 && (tilePlanes > 1 || geometry.height % tileRows != 0) {
+            tileRows = geometry.height * tilePlanes
+        }
+        let targetBands = maxConcurrency * 4
+        let rowsPerBand = max(tileRows, (rowCount / targetBands) / tileRows * tileRows)
+        let bandCount = (rowCount + rowsPerBand - 1) / rowsPerBand
+        let workerCount = min(maxConcurrency, bandCount)
+
+        let store = FITSPixelStore(count: geometry.pixelCount)
+        let width = geometry.width
+
+        let lock = NSLock()
+        var nextBand = 0
+        var firstError: Error?
+        var minVal = Float32.greatestFiniteMagnitude
+        var maxVal = -Float32.greatestFiniteMagnitude
+        var finiteCount = 0
+
+        Logger.swiftfitsio.debug("Decompressing \(geometry.axes) image in \(bandCount) bands of \(rowsPerBand) rows on \(workerCount) workers")
+
+        DispatchQueue.concurrentPerform(iterations: workerCount) { _ in
+            var bandMin = Float32.greatestFiniteMagnitude
+            var bandMax = -Float32.greatestFiniteMagnitude
+            var bandFinite = 0
+
+            do {
+                let worker = try self.openAnotherHandle()
+                try worker.moveToHDU(hdu)
+                guard let workerFile = worker.fitsfile else {
+                    throw FITSFileError.fileNotOpen
+                }
+
+                while true {
+                    lock.lock()
+                    let band = nextBand
+                    nextBand += 1
+                    let failed = firstError != nil
+                    lock.unlock()
+                    guard band < bandCount, !failed else {
+                        break
+                    }
+
+                    let firstRow = band * rowsPerBand
+                    let rows = min(rowsPerBand, rowCount - firstRow)
+                    let offset = firstRow * width
+                    let count = rows * width
+
+                    // Use TFLOAT (42) so that CFITSIO applies BZERO/BSCALE while converting
+                    let TFLOAT: Int32 = 42
+                    var readStatus: Int32 = 0
+                    var nullval: Float32 = 0
+                    var anynull: Int32 = 0
+                    _ = readImageElements(workerFile, TFLOAT, Int64(offset) + 1, Int64(count), &nullval, store.pointer + offset, &anynull, &readStatus)
+                    guard readStatus == 0 else {
+                        let errorString = FITSFile.errorMessage(for: readStatus)
+                        Logger.swiftfitsio.error("Error decompressing rows \(firstRow)..<\(firstRow + rows): status \(readStatus), \(errorString)")
+                        throw FITSFileError.readError(status: readStatus, message: errorString)
+                    }
+                    bandFinite += accumulateRange(store.pointer + offset, count, &bandMin, &bandMax)
+                }
+            } catch {
+                lock.lock()
+                if firstError == nil {
+                    firstError = error
+                }
+                lock.unlock()
+            }
+
+            lock.lock()
+            minVal = min(minVal, bandMin)
+            maxVal = max(maxVal, bandMax)
+            finiteCount += bandFinite
+            lock.unlock()
+        }
+
+        if let error = firstError {
+            throw error
+        }
+        if finiteCount == 0 {
+            minVal = 0
+            maxVal = 0
+        }
+
+        return FITSImage(
+            width: geometry.width,
+            height: geometry.height,
+            depth: geometry.depth,
+            bitpix: geometry.bitpix,
+            dataType: try FITSDataType(bitpix: geometry.bitpix),
+            storage: store,
+            originalMinValue: minVal,
+            originalMaxValue: maxVal,
+            header: header
+        )
+    }
+}
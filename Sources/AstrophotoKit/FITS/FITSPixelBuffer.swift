@@ -0,0 +1,373 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_get_img_equivtype_wrapper")
+func getImageEquivalentType(_ fptr: OpaquePointer?, _ equivType: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_set_bscale_wrapper")
+func setScaling(_ fptr: OpaquePointer?, _ scale: Double, _ zero: Double, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_read_key_dbl_wrapper")
+func readDoubleKey(_ fptr: OpaquePointer?, _ keyName: UnsafePointer<CChar>?, _ value: UnsafeMutablePointer<Double>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("apk_convert_u8_to_f32")
+func convertUInt8ToFloat32(_ src: UnsafePointer<UInt8>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_i16_to_f32")
+func convertInt16ToFloat32(_ src: UnsafePointer<Int16>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_u16_to_f32")
+func convertUInt16ToFloat32(_ src: UnsafePointer<UInt16>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_i32_to_f32")
+func convertInt32ToFloat32(_ src: UnsafePointer<Int32>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_i64_to_f32")
+func convertInt64ToFloat32(_ src: UnsafePointer<Int64>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_f32_to_f32")
+func convertFloat32ToFloat32(_ src: UnsafePointer<Float32>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+@_silgen_name("apk_convert_f64_to_f32")
+func convertFloat64ToFloat32(_ src: UnsafePointer<Float64>?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+/// Element types that can be stored natively in a `FITSPixelBuffer`
+public protocol FITSPixel {
+    /// The CFITSIO datatype code used to read this element type (TBYTE, TSHORT, ...)
+    static var cfitsioDataType: Int32 { get }
+
+    /// Converts stored values to physical Float32 values (`zero + scale * value`)
+    static func convertToFloat32(_ source: UnsafeBufferPointer<Self>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double)
+}
+
+extension UInt8: FITSPixel {
+    public static let cfitsioDataType: Int32 = 11  // TBYTE
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<UInt8>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertUInt8ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension Int16: FITSPixel {
+    public static let cfitsioDataType: Int32 = 21  // TSHORT
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<Int16>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertInt16ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension UInt16: FITSPixel {
+    public static let cfitsioDataType: Int32 = 20  // TUSHORT
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<UInt16>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertUInt16ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension Int32: FITSPixel {
+    public static let cfitsioDataType: Int32 = 31  // TINT
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<Int32>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertInt32ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension Int64: FITSPixel {
+    public static let cfitsioDataType: Int32 = 81  // TLONGLONG
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<Int64>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertInt64ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension Float32: FITSPixel {
+    public static let cfitsioDataType: Int32 = 42  // TFLOAT
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<Float32>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertFloat32ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+extension Float64: FITSPixel {
+    public static let cfitsioDataType: Int32 = 82  // TDOUBLE
+
+    public static func convertToFloat32(_ source: UnsafeBufferPointer<Float64>, into destination: UnsafeMutablePointer<Float32>, scale: Double, zero: Double) {
+        convertFloat64ToFloat32(source.baseAddress, destination, source.count, scale, zero)
+    }
+}
+
+/// Image pixels kept in the element type they are stored with in the file
+///
+/// BZERO/BSCALE are not applied when the pixels are read. They are kept alongside the
+/// stored values and applied only when physical values are requested, so a 16-bit frame
+/// occupies 2 bytes per pixel until a step actually needs floats.
+public struct FITSPixelBuffer<Element: FITSPixel> {
+    /// Image dimensions
+    public let width: Int
+    public let height: Int
+    public let depth: Int
+
+    /// Stored pixel values, row by row
+    public let pixels: [Element]
+
+    /// Scale factor applied to stored values (BSCALE)
+    public let bscale: Double
+
+    /// Offset applied to stored values (BZERO)
+    public let bzero: Double
+
+    public init(width: Int, height: Int, depth: Int, pixels: [Element], bscale: Double = 1.0, bzero: Double = 0.0) {
+        precondition(pixels.count == width * height * depth, "Pixel count does not match dimensions")
+        self.width = width
+        self.height = height
+        self.depth = depth
+        self.pixels = pixels
+        self.bscale = bscale
+        self.bzero = bzero
+    }
+
+    /// Number of bytes used by the stored pixels
+    public var byteCount: Int {
+        pixels.count * MemoryLayout<Element>.stride
+    }
+
+    /// Converts a range of stored pixels to physical Float32 values
+    /// - Parameters:
+    ///   - range: Range of linear pixel indices to convert
+    ///   - destination: Buffer receiving `range.count` values
+    public func convertToFloat32(range: Range<Int>, into destination: UnsafeMutablePointer<Float32>) {
+        pixels.withUnsafeBufferPointer { source in
+            Element.convertToFloat32(UnsafeBufferPointer(rebasing: source[range]), into: destination, scale: bscale, zero: bzero)
+        }
+    }
+
+    /// Returns all pixels as physical Float32 values
+    public func float32Pixels() -> [Float32] {
+        return [Float32](unsafeUninitializedCapacity: pixels.count) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress {
+                convertToFloat32(range: 0..<pixels.count, into: baseAddress)
+            }
+            initializedCount = pixels.count
+        }
+    }
+}
+
+/// A native-typed FITS image, tagged with the element type selected from BITPIX
+public enum FITSNativePixels {
+    case uint8(FITSPixelBuffer<UInt8>)
+    case int16(FITSPixelBuffer<Int16>)
+    case uint16(FITSPixelBuffer<UInt16>)
+    case int32(FITSPixelBuffer<Int32>)
+    case int64(FITSPixelBuffer<Int64>)
+    case float32(FITSPixelBuffer<Float32>)
+    case float64(FITSPixelBuffer<Float64>)
+
+    /// Image dimensions
+    public var width: Int {
+        switch self {
+        case .uint8(let b): return b.width
+        case .int16(let b): return b.width
+        case .uint16(let b): return b.width
+        case .int32(let b): return b.width
+        case .int64(let b): return b.width
+        case .float32(let b): return b.width
+        case .float64(let b): return b.width
+        }
+    }
+
+    public var height: Int {
+        switch self {
+        case .uint8(let b): return b.height
+        case .int16(let b): return b.height
+        case .uint16(let b): return b.height
+        case .int32(let b): return b.height
+        case .int64(let b): return b.height
+        case .float32(let b): return b.height
+        case .float64(let b): return b.height
+        }
+    }
+
+    public var depth: Int {
+        switch self {
+        case .uint8(let b): return b.depth
+        case .int16(let b): return b.depth
+        case .uint16(let b): return b.depth
+        case .int32(let b): return b.depth
+        case .int64(let b): return b.depth
+        case .float32(let b): return b.depth
+        case .float64(let b): return b.depth
+        }
+    }
+
+    /// Number of bytes used by the stored pixels
+    public var byteCount: Int {
+        switch self {
+        case .uint8(let b): return b.byteCount
+        case .int16(let b): return b.byteCount
+        case .uint16(let b): return b.byteCount
+        case .int32(let b): return b.byteCount
+        case .int64(let b): return b.byteCount
+        case .float32(let b): return b.byteCount
+        case .float64(let b): return b.byteCount
+        }
+    }
+
+    /// Converts a range of pixels to physical Float32 values
+    /// - Parameters:
+    ///   - range: Range of linear pixel indices to convert
+    ///   - destination: Buffer receiving `range.count` values
+    public func convertToFloat32(range: Range<Int>, into destination: UnsafeMutablePointer<Float32>) {
+        switch self {
+        case .uint8(let b): b.convertToFloat32(range: range, into: destination)
+        case .int16(let b): b.convertToFloat32(range: range, into: destination)
+        case .uint16(let b): b.convertToFloat32(range: range, into: destination)
+        case .int32(let b): b.convertToFloat32(range: range, into: destination)
+        case .int64(let b): b.convertToFloat32(range: range, into: destination)
+        case .float32(let b): b.convertToFloat32(range: range, into: destination)
+        case .float64(let b): b.convertToFloat32(range: range, into: destination)
+        }
+    }
+
+    /// Returns all pixels as physical Float32 values
+    public func float32Pixels() -> [Float32] {
+        switch self {
+        case .uint8(let b): return b.float32Pixels()
+        case .int16(let b): return b.float32Pixels()
+        case .uint16(let b): return b.float32Pixels()
+        case .int32(let b): return b.float32Pixels()
+        case .int64(let b): return b.float32Pixels()
+        case .float32(let b): return b.float32Pixels()
+        case .float64(let b): return b.float32Pixels()
+        }
+    }
+}
+
+/// Extension to FITSFile for reading pixels in their native type
+extension FITSFile {
+    /// Reads a double-valued keyword from the current HDU
+    /// - Parameter keyword: The keyword name
+    /// - Returns: The value, or nil if the keyword is not present
+    func readDoubleKeyword(_ keyword: String) throws -> Double? {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        var status: Int32 = 0
+        var value: Double = 0
+        _ = readDoubleKey(file, keyword, &value, &status)
+
+        // KEY_NO_EXIST (202)
+        if status == 202 {
+            return nil
+        }
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+        return value
+    }
+
+    /// Reads image data from the current HDU without converting it to floating point
+    ///
+    /// The element type follows BITPIX. Unsigned 16-bit frames (BITPIX = 16, BZERO = 32768)
+    /// are read as `UInt16`; for all other images BZERO/BSCALE are left unapplied and stored in
+    /// the returned buffer so they can be applied lazily.
+    /// - Returns: The pixels in their native element type
+    public func readNativeImage() throws -> FITSNativePixels {
+        guard let file = fitsfile else {
+            Logger.swiftfitsio.error("Attempted to read image from closed FITS file")
+            throw FITSFileError.fileNotOpen
+        }
+
+        let geometry = try readImageGeometry()
+        guard geometry.naxis > 0 else {
+            throw FITSFileError.readError(status: -1, message: "HDU contains no image data")
+        }
+        try checkAllocation(count: geometry.pixelCount, stride: max(geometry.bytesPerPixel, 1))
+
+        var status: Int32 = 0
+        var equivType: Int32 = 0
+        _ = getImageEquivalentType(file, &equivType, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error getting image type: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+
+        let bitpix = geometry.bitpix
+        let width = geometry.width
+        let height = geometry.height
+        let depth = geometry.depth
+        let totalPixels = geometry.pixelCount
+
+        let bscale = try readDoubleKeyword("BSCALE") ?? 1.0
+        let bzero = try readDoubleKeyword("BZERO") ?? 0.0
+
+        Logger.swiftfitsio.debug("Reading native image: \(width)x\(height)x\(depth), bitpix=\(bitpix), equivtype=\(equivType)")
+
+        // USHORT_IMG (20): BITPIX = 16 with BZERO = 32768 maps exactly onto UInt16
+        if equivType == 20 {
+            let pixels: [UInt16] = try readNativePixels(file: file, count: totalPixels)
+            return .uint16(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels))
+        }
+
+        // Read stored values unscaled and keep BZERO/BSCALE for lazy conversion
+        _ = setScaling(file, 1.0, 0.0, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error disabling image scaling: status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+        defer {
+            var restoreStatus: Int32 = 0
+            _ = setScaling(file, bscale, bzero, &restoreStatus)
+        }
+
+        switch bitpix {
+        case 8:
+            let pixels: [UInt8] = try readNativePixels(file: file, count: totalPixels)
+            return .uint8(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        case 16:
+            let pixels: [Int16] = try readNativePixels(file: file, count: totalPixels)
+            return .int16(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        case 32:
+            let pixels: [Int32] = try readNativePixels(file: file, count: totalPixels)
+            return .int32(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        case 64:
+            let pixels: [Int64] = try readNativePixels(file: file, count: totalPixels)
+            return .int64(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        case -32:
+            let pixels: [Float32] = try readNativePixels(file: file, count: totalPixels)
+            return .float32(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        case -64:
+            let pixels: [Float64] = try readNativePixels(file: file, count: totalPixels)
+            return .float64(FITSPixelBuffer(width: width, height: height, depth: depth, pixels: pixels, bscale: bscale, bzero: bzero))
+        default:
+            throw FITSFileError.unsupportedDataType(bitpix: bitpix)
+        }
+    }
+
+    /// Reads `count` pixels of the current HDU as the given element type
+    private func readNativePixels<Element: FITSPixel>(file: OpaquePointer, count: Int) throws -> [Element] {
+        var status: Int32 = 0
+        var anynull: Int32 = 0
+
+        let pixels = try [Element](unsafeUninitializedCapacity: count) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress, count > 0 {
+                // A nil null value disables checking for undefined pixels
+                _ = readImageElements(file, Element.cfitsioDataType, 1, Int64(count), nil, baseAddress, &anynull, &status)
+            }
+            guard status == 0 else {
+                initializedCount = 0
+                let errorString = FITSFile.errorMessage(for: status)
+                Logger.swiftfitsio.error("Error reading native image data: status \(status), \(errorString)")
+                throw FITSFileError.readError(status: status, message: errorString)
+            }
+            initializedCount = count
+        }
+
+        return pixels
+    }
+}
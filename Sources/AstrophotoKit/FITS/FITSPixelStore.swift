@@ -0,0 +1,239 @@
+import Foundation
+
+/// Reference-counted Float32 pixel storage shared between `FITSImage` values
+public typealias FITSPixelStore = AlignedPixelStore<Float32>
+
+/// Reference-counted, aligned pixel storage of any element type
+///
+/// Allocations are at least 64-byte aligned (cache line / widest SIMD register), so rows that
+/// start at the beginning of the store can be handed to vectorized kernels and Metal directly.
+/// Allocations of a page or more are page aligned and padded to whole pages, which lets Metal
+/// wrap them in a buffer without copying on devices with unified memory.
+/// Stores are never mutated while shared: `FITSImage` copies its store before writing
+/// unless it holds the only reference.
+///
+/// A store can also borrow memory owned by something else, such as a memory-mapped file or a
+/// Metal buffer; it then keeps the owner alive instead of freeing the memory.
+public final class AlignedPixelStore<Element> {
+    /// Minimum alignment of the pixel allocation in bytes
+    public static var alignment: Int { 64 }
+
+    /// Number of elements in the store
+    public let count: Int
+
+    /// Base address of the pixel allocation
+    let pointer: UnsafeMutablePointer<Element>
+
+    /// Number of bytes that may be addressed from `pointer`, including the padding
+    public let allocatedByteCount: Int
+
+    /// Object that owns borrowed memory (nil if the store owns its memory)
+    private let owner: AnyObject?
+
+    /// True if the memory was allocated by and is freed with this store
+    public let ownsMemory: Bool
+
+    /// Allocates uninitialized storage for `count` pixels
+    /// - Parameter count: Number of elements
+    public init(count: Int) {
+        let byteCount = max(count, 1) * MemoryLayout<Element>.stride
+        let pageSize = Int(getpagesize())
+        let alignment = byteCount >= pageSize ? pageSize : AlignedPixelStore.alignment
+        self.count = count
+        self.allocatedByteCount = (byteCount + alignment - 1) / alignment * alignment
+        let raw = UnsafeMutableRawPointer.allocate(byteCount: allocatedByteCount, alignment: alignment)
+        self.pointer = raw.bindMemory(to: Element.self, capacity: max(count, 1))
+        self.owner = nil
+        self.ownsMemory = true
+    }
+
+    /// Allocates storage holding a copy of the given pixels
+    /// - Parameter pixels: The pixel values to copy
+    public convenience init(copying pixels: UnsafeBufferPointer<Element>) {
+        self.init(count: pixels.count)
+        if let source = pixels.baseAddress {
+            pointer.initialize(from: source, count: pixels.count)
+        }
+    }
+
+    /// Wraps memory owned by another object (no copy)
+    /// - Parameters:
+    ///   - pointer: Start of the memory; must stay valid while `owner` is alive
+    ///   - count: Number of elements
+    ///   - owner: Object that keeps the memory alive (nil if it is never freed)
+    public init(borrowing pointer: UnsafeMutablePointer<Element>, count: Int, owner: AnyObject?) {
+        self.count = count
+        self.pointer = pointer
+        self.allocatedByteCount = count * MemoryLayout<Element>.stride
+        self.owner = owner
+        self.ownsMemory = false
+    }
+
+    deinit {
+        if ownsMemory {
+            UnsafeMutableRawPointer(pointer).deallocate()
+        }
+    }
+
+    /// Number of bytes used by the store
+    public var byteCount: Int {
+        count * MemoryLayout<Element>.stride
+    }
+
+    /// Calls `body` with a read-only view of the whole store
+    public func withUnsafeBufferPointer<R>(_ body: (UnsafeBufferPointer<Element>) throws -> R) rethrows -> R {
+        return try body(UnsafeBufferPointer(start: pointer, count: count))
+    }
+
+    /// Calls `body` with a mutable view of the whole store
+    ///
+    /// Only safe when the caller holds the only reference to the store.
+    public func withUnsafeMutableBufferPointer<R>(_ body: (UnsafeMutableBufferPointer<Element>) throws -> R) rethrows -> R {
+        return try body(UnsafeMutableBufferPointer(start: pointer, count: count))
+    }
+}
+
+/// A read-only, zero-copy strided view of pixels in a `FITSPixelStore`
+///
+/// Each element is presented as `stored * scale + bias`, which lets the same store serve
+/// both the normalized (0-1) and the original value range. Regions are views with an
+/// offset and the parent's row/plane strides.
+public struct FITSPixelView: RandomAccessCollection {
+    /// The backing store
+    public let store: FITSPixelStore
+
+    /// Index of the first pixel in the store
+    public let offset: Int
+
+    /// View dimensions
+    public let width: Int
+    public let height: Int
+    public let depth: Int
+
+    /// Distance between the starts of consecutive rows, in pixels
+    public let rowStride: Int
+
+    /// Distance between the starts of consecutive planes, in pixels
+    public let planeStride: Int
+
+    /// Linear transform applied to stored values
+    public let scale: Float32
+    public let bias: Float32
+
+    public init(
+        store: FITSPixelStore,
+        offset: Int = 0,
+        width: Int,
+        height: Int,
+        depth: Int = 1,
+        rowStride: Int? = nil,
+        planeStride: Int? = nil,
+        scale: Float32 = 1,
+        bias: Float32 = 0
+    ) {
+        let rowStride = rowStride ?? width
+        let planeStride = planeStride ?? rowStride * height
+        precondition(
+            width == 0 || height == 0 || depth == 0 ||
+                offset + (depth - 1) * planeStride + (height - 1) * rowStride + width <= store.count,
+            "View exceeds pixel store"
+        )
+        self.store = store
+        self.offset = offset
+        self.width = width
+        self.height = height
+        self.depth = depth
+        self.rowStride = rowStride
+        self.planeStride = planeStride
+        self.scale = scale
+        self.bias = bias
+    }
+
+    public var startIndex: Int { 0 }
+    public var endIndex: Int { width * height * depth }
+
+    /// True if the view's rows are packed back to back in the store
+    public var isContiguous: Bool {
+        rowStride == width && (depth == 1 || planeStride == width * height)
+    }
+
+    /// True if the view presents stored values unchanged
+    public var isIdentity: Bool {
+        scale == 1 && bias == 0
+    }
+
+    public subscript(position: Int) -> Float32 {
+        let planeSize = width * height
+        let z = position / planeSize
+        let inPlane = position - z * planeSize
+        let y = inPlane / width
+        let x = inPlane - y * width
+        return self[x, y, z]
+    }
+
+    /// Returns the pixel at the given coordinates
+    public subscript(x: Int, y: Int, z: Int = 0) -> Float32 {
+        precondition(x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth, "Pixel coordinates out of range")
+        return store.pointer[offset + z * planeStride + y * rowStride + x] * scale + bias
+    }
+
+    /// Returns a view of a rectangular region of this view, sharing the same store
+    public func region(x: Int, y: Int, width: Int, height: Int) -> FITSPixelView {
+        precondition(x >= 0 && y >= 0 && x + width <= self.width && y + height <= self.height, "Region out of range")
+        return FITSPixelView(
+            store: store,
+            offset: offset + y * rowStride + x,
+            width: width,
+            height: height,
+            depth: depth,
+            rowStride: rowStride,
+            planeStride: planeStride,
+            scale: scale,
+            bias: bias
+        )
+    }
+
+    /// Copies one row into a destination buffer, applying the view's transform
+    /// - Parameters:
+    ///   - y: Row index
+    ///   - z: Plane index
+    ///   - destination: Buffer receiving `width` values
+    public func copyRow(_ y: Int, plane z: Int = 0, into destination: UnsafeMutablePointer<Float32>) {
+        let source = store.pointer + offset + z * planeStride + y * rowStride
+        convertFloat32ToFloat32(source, destination, width, Double(scale), Double(bias))
+    }
+
+    /// Copies the whole view into a packed destination buffer of `count` values
+    public func copy(into destination: UnsafeMutablePointer<Float32>) {
+        if isContiguous {
+            let source = store.pointer + offset
+            convertFloat32ToFloat32(source, destination, count, Double(scale), Double(bias))
+            return
+        }
+        var target = destination
+        for z in 0..<depth {
+            for y in 0..<height {
+                copyRow(y, plane: z, into: target)
+                target += width
+            }
+        }
+    }
+
+    /// Returns the view's values as a packed array
+    public func toArray() -> [Float32] {
+        return [Float32](unsafeUninitializedCapacity: count) { buffer, initializedCount in
+            if let baseAddress = buffer.baseAddress {
+                copy(into: baseAddress)
+            }
+            initializedCount = count
+        }
+    }
+
+    /// Calls `body` with the stored values of one row, without copying
+    ///
+    /// The values are the raw store contents; the view's transform is not applied.
+    public func withStoredRow<R>(_ y: Int, plane z: Int = 0, _ body: (UnsafeBufferPointer<Float32>) throws -> R) rethrows -> R {
+        precondition(y >= 0 && y < height && z >= 0 && z < depth, "Row out of range")
+        return try body(UnsafeBufferPointer(start: store.pointer + offset + z * planeStride + y * rowStride, count: width))
+    }
+}
@@ -0,0 +1,123 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_read_subset_wrapper")
+func readImageSubset(_ fptr: OpaquePointer?, _ dataType: Int32, _ naxis: Int32, _ firstPixel: UnsafeMutablePointer<Int64>, _ lastPixel: UnsafeMutablePointer<Int64>, _ nullValue: UnsafeMutableRawPointer?, _ array: UnsafeMutableRawPointer, _ anyNull: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+/// Extension to FITSFile for reading rectangular regions without loading the whole image
+extension FITSFile {
+    /// Reads a rectangular region of the image in the current HDU
+    ///
+    /// Only the rows and columns of the region are read. For tile-compressed images CFITSIO
+    /// decompresses just the tiles that intersect the region. The returned image has the
+    /// value range of its own pixels and carries the HDU's header.
+    /// - Parameters:
+    ///   - x: Left column of the region (0-based)
+    ///   - y: Bottom row of the region (0-based)
+    ///   - width: Region width in pixels
+    ///   - height: Region height in pixels
+    ///   - plane: Image plane to read from (default: 0)
+    /// - Returns: The region as an image
+    /// - Throws: An error if the region lies outside the image or cannot be read
+    public func readRegion(x: Int, y: Int, width: Int, height: Int, plane: Int = 0) throws -> FITSImage {
+        let geometry = try readImageGeometry()
+        let header = FITSHeader(table: try readKeywordTable())
+        return try readRegion(geometry: geometry, header: header, x: x, y: y, width: width, height: height, plane: plane)
+    }
+
+    /// Reads square cutouts centered on a list of positions, e.g. a star list
+    ///
+    /// The geometry and header are read once for the whole batch and cutouts are read in row
+    /// order so that CFITSIO's buffers and tile cache are reused between neighboring stamps.
+    /// Like `FITSImage.extractRegion(centerX:centerY:size:)`, cutouts are clipped at the image
+    /// edges.
+    /// - Parameters:
+    ///   - centers: Cutout centers in pixel coordinates
+    ///   - size: Edge length of each cutout in pixels
+    ///   - plane: Image plane to read from (default: 0)
+    /// - Returns: One cutout per center, in input order; nil where the clipped cutout is empty
+    /// - Throws: An error if a cutout cannot be read
+    public func readCutouts(centers: [(x: Int, y: Int)], size: Int, plane: Int = 0) throws -> [FITSImage?] {
+        let geometry = try readImageGeometry()
+        let header = FITSHeader(table: try readKeywordTable())
+        var cutouts = [FITSImage?](repeating: nil, count: centers.count)
+
+        let halfSize = size / 2
+        let order = centers.indices.sorted { (centers[$0].y, centers[$0].x) < (centers[$1].y, centers[$1].x) }
+        for index in order {
+            let center = centers[index]
+            let startX = max(0, center.x - halfSize)
+            let startY = max(0, center.y - halfSize)
+            let endX = min(geometry.width, center.x - halfSize + size)
+            let endY = min(geometry.height, center.y - halfSize + size)
+            guard endX > startX && endY > startY else {
+                continue
+            }
+            cutouts[index] = try readRegion(
+                geometry: geometry,
+                header: header,
+                x: startX,
+                y: startY,
+                width: endX - startX,
+                height: endY - startY,
+                plane: plane
+            )
+        }
+
+        Logger.swiftfitsio.debug("Read \(centers.count) cutouts of size \(size) from \(self.path)")
+
+        return cutouts
+    }
+
+    /// Reads a region of the image, given its already known geometry and header
+    private func readRegion(geometry: FITSImageGeometry, header: FITSHeader, x: Int, y: Int, width: Int, height: Int, plane: Int) throws -> FITSImage {
+        guard let file = fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        guard geometry.naxis > 0,
+              width > 0, height > 0,
+              x >= 0, y >= 0, x + width <= geometry.width, y + height <= geometry.height,
+              plane >= 0, plane < geometry.depth else {
+            throw FITSFileError.readError(status: -1, message: "Region \(width)x\(height) at (\(x), \(y)), plane \(plane) is outside image \(geometry.axes)")
+        }
+
+        // CFITSIO coordinates are 1-based and inclusive; axes beyond the second select the plane
+        let planeCoordinates = geometry.planeCoordinates(plane).map { Int64($0) + 1 }
+        var firstPixel = Array([Int64(x + 1), Int64(y + 1)].prefix(geometry.naxis)) + planeCoordinates
+        var lastPixel = Array([Int64(x + width), Int64(y + height)].prefix(geometry.naxis)) + planeCoordinates
+
+        // Use TFLOAT (42) so that CFITSIO applies BZERO/BSCALE while converting
+        let TFLOAT: Int32 = 42
+        let store = FITSPixelStore(count: width * height)
+        var status: Int32 = 0
+        var nullval: Float32 = 0
+        var anynull: Int32 = 0
+        _ = readImageSubset(file, TFLOAT, Int32(geometry.naxis), &firstPixel, &lastPixel, &nullval, store.pointer, &anynull, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error reading region at (\(x), \(y)): status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+
+        var minVal = Float32.greatestFiniteMagnitude
+        var maxVal = -Float32.greatestFiniteMagnitude
+        if accumulateRange(store.pointer, store.count, &minVal, &maxVal) == 0 {
+            minVal = 0
+            maxVal = 0
+        }
+
+        return FITSImage(
+            width: width,
+            height: height,
+            depth: 1,
+            bitpix: geometry.bitpix,
+            dataType: try FITSDataType(bitpix: geometry.bitpix),
+            storage: store,
+            originalMinValue: minVal,
+            originalMaxValue: maxVal,
+            header: header
+        )
+    }
+}
@@ -0,0 +1,251 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_read_img_elements_wrapper")
+func readImageElements(_ fptr: OpaquePointer?, _ dataType: Int32, _ firstElement: Int64, _ numElements: Int64, _ nullValue: UnsafeMutableRawPointer?, _ array: UnsafeMutableRawPointer, _ anyNull: UnsafeMutablePointer<Int32>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+/// A band of consecutive image rows produced by `FITSRowChunkIterator`
+///
+/// The pixels are borrowed from the caller-supplied buffer and are only valid until the
+/// next call to `FITSRowChunkIterator.next(into:)`. Copy out anything that must outlive the chunk.
+public struct FITSRowChunk {
+    /// Index of the image plane this band belongs to (0 for 2D images)
+    public let plane: Int
+
+    /// Index of the first row in the band (0-based, within the plane)
+    public let firstRow: Int
+
+    /// Number of rows in the band
+    public let rowCount: Int
+
+    /// Number of pixels per row
+    public let width: Int
+
+    /// Original (unnormalized) pixel values, stored row by row
+    public let pixels: UnsafeBufferPointer<Float32>
+
+    /// Returns the pixels of a single row in the band
+    /// - Parameter index: Row index relative to the band (0 to rowCount-1)
+    /// - Returns: The pixel values of that row
+    public func row(_ index: Int) -> UnsafeBufferPointer<Float32> {
+        precondition(index >= 0 && index < rowCount, "Row index out of range")
+        return UnsafeBufferPointer(rebasing: pixels[(index * width)..<((index + 1) * width)])
+    }
+}
+
+/// Streams the image in the current HDU as bands of rows through a caller-supplied buffer
+///
+/// Peak memory is bounded by `chunkCapacity` pixels regardless of the image size, so
+/// statistics, histograms and background estimates can be computed on frames that are
+/// too large to hold in memory as a whole.
+public final class FITSRowChunkIterator {
+    /// Image width in pixels
+    public let width: Int
+
+    /// Image height in pixels
+    public let height: Int
+
+    /// Number of image planes
+    public let depth: Int
+
+    /// BITPIX of the data unit
+    public let bitpix: Int32
+
+    /// Maximum number of rows returned per chunk
+    public let rowsPerChunk: Int
+
+    /// Minimum number of pixels a buffer passed to `next(into:)` must be able to hold
+    public var chunkCapacity: Int {
+        rowsPerChunk * width
+    }
+
+    private let file: FITSFile
+    private var nextPlane = 0
+    private var nextRow = 0
+
+    /// Creates an iterator over the image in the current HDU of a FITS file
+    /// - Parameters:
+    ///   - file: The FITS file, positioned at the HDU to read
+    ///   - rowsPerChunk: Maximum number of rows per chunk; reduced if a chunk would exceed `file.maxAllocationBytes`
+    /// - Throws: An error if the image parameters cannot be read
+    public init(file: FITSFile, rowsPerChunk: Int = 256) throws {
+        guard file.fitsfile != nil else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        let geometry = try file.readImageGeometry()
+        guard geometry.naxis > 0 else {
+            throw FITSFileError.readError(status: -1, message: "HDU contains no image data")
+        }
+
+        self.file = file
+        self.bitpix = geometry.bitpix
+        self.width = geometry.width
+        self.height = geometry.height
+        // Axes beyond the third are folded into planes
+        self.depth = geometry.depth
+        // Keep the chunk buffer within the file's allocation limit
+        let rowBytes = max(1, geometry.width * MemoryLayout<Float32>.stride)
+        self.rowsPerChunk = max(1, min(rowsPerChunk, geometry.height, file.maxAllocationBytes / rowBytes))
+    }
+
+    /// Reads the next band of rows into the supplied buffer
+    ///
+    /// Bands never straddle two planes, so the last band of a plane may be shorter than `rowsPerChunk`.
+    /// - Parameter buffer: Reusable buffer holding at least `chunkCapacity` pixels
+    /// - Returns: The chunk that was read, or nil when the whole image has been consumed
+    /// - Throws: An error if the buffer is too small or the pixels cannot be read
+    public func next(into buffer: UnsafeMutableBufferPointer<Float32>) throws -> FITSRowChunk? {
+        guard nextPlane < depth else {
+            return nil
+        }
+        guard let fptr = file.fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        guard let baseAddress = buffer.baseAddress, buffer.count >= chunkCapacity else {
+            throw FITSFileError.readError(status: -1, message: "Chunk buffer holds \(buffer.count) pixels, \(chunkCapacity) required")
+        }
+
+        let rowCount = min(rowsPerChunk, height - nextRow)
+        let numElements = Int64(rowCount) * Int64(width)
+        // CFITSIO element indices are 1-based and run through rows and planes contiguously
+        let firstElement = (Int64(nextPlane) * Int64(height) + Int64(nextRow)) * Int64(width) + 1
+
+        // Use TFLOAT (42) so that CFITSIO applies BZERO/BSCALE while converting
+        let TFLOAT: Int32 = 42
+        var status: Int32 = 0
+        var nullval: Float32 = 0
+        var anynull: Int32 = 0
+        _ = readImageElements(fptr, TFLOAT, firstElement, numElements, &nullval, baseAddress, &anynull, &status)
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error reading rows \(self.nextRow)..<\(self.nextRow + rowCount) of plane \(self.nextPlane): status \(status), \(errorString)")
+            throw FITSFileError.readError(status: status, message: errorString)
+        }
+
+        let chunk = FITSRowChunk(
+            plane: nextPlane,
+            firstRow: nextRow,
+            rowCount: rowCount,
+            width: width,
+            pixels: UnsafeBufferPointer(start: baseAddress, count: Int(numElements))
+        )
+
+        nextRow += rowCount
+        if nextRow >= height {
+            nextRow = 0
+            nextPlane += 1
+        }
+
+        return chunk
+    }
+
+    /// Restarts iteration at the first row of the first plane
+    public func reset() {
+        nextPlane = 0
+        nextRow = 0
+    }
+}
+
+/// Summary statistics of the original pixel values of an image
+public struct FITSImageStatistics: Equatable {
+    /// Number of finite pixels
+    public let count: Int
+
+    /// Number of NaN or infinite pixels (blank values)
+    public let blankCount: Int
+
+    /// Minimum finite pixel value
+    public let minValue: Float32
+
+    /// Maximum finite pixel value
+    public let maxValue: Float32
+
+    /// Mean of the finite pixel values
+    public let mean: Double
+
+    /// Population standard deviation of the finite pixel values
+    public let standardDeviation: Double
+}
+
+/// Accumulates `FITSImageStatistics` over pixels supplied band by band
+struct FITSStatisticsAccumulator {
+    private var count = 0
+    private var blankCount = 0
+    private var minValue = Float32.greatestFiniteMagnitude
+    private var maxValue = -Float32.greatestFiniteMagnitude
+    private var sum: Double = 0
+    private var sumOfSquares: Double = 0
+
+    /// Adds a band of original pixel values
+    mutating func add(_ pixels: UnsafeBufferPointer<Float32>) {
+        for value in pixels {
+            guard value.isFinite else {
+                blankCount += 1
+                continue
+            }
+            count += 1
+            minValue = min(minValue, value)
+            maxValue = max(maxValue, value)
+            let v = Double(value)
+            sum += v
+            sumOfSquares += v * v
+        }
+    }
+
+    /// Statistics of all pixels added so far
+    var statistics: FITSImageStatistics {
+        guard count > 0 else {
+            return FITSImageStatistics(count: 0, blankCount: blankCount, minValue: 0, maxValue: 0, mean: 0, standardDeviation: 0)
+        }
+
+        let mean = sum / Double(count)
+        let variance = max(0, sumOfSquares / Double(count) - mean * mean)
+
+        return FITSImageStatistics(
+            count: count,
+            blankCount: blankCount,
+            minValue: minValue,
+            maxValue: maxValue,
+            mean: mean,
+            standardDeviation: variance.squareRoot()
+        )
+    }
+}
+
+/// Extension to FITSFile for streaming image access
+extension FITSFile {
+    /// Creates a row-chunk iterator over the image in the current HDU
+    /// - Parameter rowsPerChunk: Maximum number of rows per chunk (default: 256)
+    /// - Returns: An iterator that reads the image band by band into a caller-supplied buffer
+    public func rowChunks(rowsPerChunk: Int = 256) throws -> FITSRowChunkIterator {
+        return try FITSRowChunkIterator(file: self, rowsPerChunk: rowsPerChunk)
+    }
+
+    /// Calls `body` for every band of rows in the current HDU, reusing a single buffer
+    /// - Parameters:
+    ///   - rowsPerChunk: Maximum number of rows per chunk (default: 256)
+    ///   - body: Closure receiving each chunk; the chunk's pixels are only valid during the call
+    public func forEachRowChunk(rowsPerChunk: Int = 256, _ body: (FITSRowChunk) throws -> Void) throws {
+        let iterator = try rowChunks(rowsPerChunk: rowsPerChunk)
+        let buffer = UnsafeMutableBufferPointer<Float32>.allocate(capacity: iterator.chunkCapacity)
+        defer { buffer.deallocate() }
+
+        while let chunk = try iterator.next(into: buffer) {
+            try body(chunk)
+        }
+    }
+
+    /// Computes statistics of the image in the current HDU in bounded memory
+    /// - Parameter rowsPerChunk: Maximum number of rows held in memory at once (default: 256)
+    /// - Returns: Statistics of the original (unnormalized) pixel values
+    public func readImageStatistics(rowsPerChunk: Int = 256) throws -> FITSImageStatistics {
+        var accumulator = FITSStatisticsAccumulator()
+        try forEachRowChunk(rowsPerChunk: rowsPerChunk) { chunk in
+            accumulator.add(chunk.pixels)
+        }
+        return accumulator.statistics
+    }
+}
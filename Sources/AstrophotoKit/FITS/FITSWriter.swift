@@ -0,0 +1,374 @@
+import Foundation
+import Metal
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("fits_create_img_wrapper")
+func createImage(_ fptr: OpaquePointer?, _ bitpix: Int32, _ naxis: Int32, _ naxes: UnsafeMutablePointer<Int64>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_set_compression_type_wrapper")
+func setCompressionType(_ fptr: OpaquePointer?, _ compressionType: Int32, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_set_tile_dim_wrapper")
+func setTileDimensions(_ fptr: OpaquePointer?, _ naxis: Int32, _ tileSize: UnsafeMutablePointer<Int64>, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_set_quantize_level_wrapper")
+func setQuantizeLevel(_ fptr: OpaquePointer?, _ level: Float32, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_write_img_wrapper")
+func writeImageElements(_ fptr: OpaquePointer?, _ dataType: Int32, _ firstElement: Int64, _ numElements: Int64, _ array: UnsafeMutableRawPointer, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+@_silgen_name("fits_write_record_wrapper")
+func writeRecord(_ fptr: OpaquePointer?, _ card: UnsafePointer<CChar>?, _ status: UnsafeMutablePointer<Int32>) -> Int32
+
+/// Writes images to a new FITS file, optionally tile-compressed with Rice or GZIP
+///
+/// Pixels are streamed row by row, so an image never has to be held in memory in its output
+/// format. For compressed images CFITSIO collects rows until a tile is complete and then
+/// compresses it; tiles are `tileRows` full rows, which keeps them readable in parallel
+/// by `FITSFile.readFITSImageParallel(hduNumber:maxConcurrency:)`.
+public final class FITSWriter {
+    /// Compression applied to the data unit
+    public enum Compression: Equatable {
+        /// Plain, uncompressed image HDU
+        case none
+        /// Rice tile compression (fpack's default); lossless for integer pixels
+        case rice
+        /// GZIP tile compression
+        case gzip
+
+        /// The CFITSIO compression type code
+        var cfitsioType: Int32 {
+            switch self {
+            case .none: return 0    // NOCOMPRESS
+            case .rice: return 11   // RICE_1
+            case .gzip: return 21   // GZIP_1
+            }
+        }
+    }
+
+    /// Pixel format of the data unit
+    public enum PixelFormat: Equatable {
+        case uint8
+        case int16
+        case uint16
+        case int32
+        case float32
+
+        /// The CFITSIO image type code (BITPIX, or USHORT_IMG for unsigned 16-bit)
+        var imageType: Int32 {
+            switch self {
+            case .uint8: return 8
+            case .int16: return 16
+            case .uint16: return 20
+            case .int32: return 32
+            case .float32: return -32
+            }
+        }
+    }
+
+    /// Options controlling the layout of a written image
+    public struct Options {
+        /// Pixel format of the data unit (default: 32-bit float)
+        public var pixelFormat: PixelFormat
+
+        /// Compression of the data unit (default: none)
+        public var compression: Compression
+
+        /// Number of image rows per compression tile (default: 16)
+        public var tileRows: Int
+
+        /// Quantization level for compressed floating-point pixels
+        ///
+        /// 0 stores floating-point pixels without quantization, which is lossless only with
+        /// `.gzip`; Rice compression always quantizes floating-point pixels. nil keeps CFITSIO's
+        /// default (noise / 4). Ignored for integer formats, which are always compressed losslessly.
+        public var quantizeLevel: Float32?
+
+        /// Whether DATASUM and CHECKSUM keywords are written for the HDU when the file is closed
+        public var checksum: Bool
+
+        public init(pixelFormat: PixelFormat = .float32, compression: Compression = .none, tileRows: Int = 16, quantizeLevel: Float32? = nil, checksum: Bool = false) {
+            self.pixelFormat = pixelFormat
+            self.compression = compression
+            self.tileRows = tileRows
+            self.quantizeLevel = quantizeLevel
+            self.checksum = checksum
+        }
+    }
+
+    /// The file being written
+    public let file: FITSFile
+
+    /// Pixels of the current image and the number already written
+    private var imagePixelCount = 0
+    private var writtenPixelCount = 0
+    private var imageWidth = 0
+    private var imagePixelFormat = PixelFormat.float32
+
+    /// HDUs that get checksum keywords when the file is closed
+    private var checksumHDUs: [Int] = []
+
+    /// Creates a new FITS file for writing
+    /// - Parameters:
+    ///   - path: The file path of the new FITS file
+    ///   - overwrite: Whether an existing file at `path` is replaced (default: true)
+    /// - Throws: An error if the file cannot be created
+    public init(path: String, overwrite: Bool = true) throws {
+        self.file = try FITSFile(creating: path, overwrite: overwrite)
+    }
+
+    /// Closes the file, flushing all pending tiles
+    ///
+    /// Checksums requested with `Options.checksum` are computed in parallel from the
+    /// finished file and written to the HDUs' headers.
+    /// - Throws: An error if pending data cannot be flushed or the checksums cannot be written
+    public func close() throws {
+        if writtenPixelCount != imagePixelCount {
+            Logger.swiftfitsio.warning("Closing \(self.file.path) with \(self.imagePixelCount - self.writtenPixelCount) pixels of the last image unwritten")
+        }
+        try file.close()
+
+        guard !checksumHDUs.isEmpty else {
+            return
+        }
+        let hdus = checksumHDUs
+        checksumHDUs = []
+        let checksumFile = try FITSFile(path: file.path, mode: "READWRITE")
+        try checksumFile.writeChecksums(hduNumbers: hdus)
+        try checksumFile.close()
+    }
+
+    /// Starts a new image HDU
+    ///
+    /// Header cards are copied from `header` except for the structural keywords that describe
+    /// the data unit (BITPIX, NAXISn, BZERO, BSCALE, compression keywords, checksums, ...),
+    /// which CFITSIO writes for the new layout.
+    /// - Parameters:
+    ///   - width: Image width in pixels
+    ///   - height: Image height in pixels
+    ///   - depth: Number of image planes (default: 1)
+    ///   - options: Pixel format and compression
+    ///   - header: Header whose cards are copied to the new HDU (default: none)
+    /// - Throws: An error if the HDU cannot be created or the previous image is incomplete
+    public func beginImage(width: Int, height: Int, depth: Int = 1, options: Options = Options(), header: FITSHeader? = nil) throws {
+        guard let fptr = file.fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        guard writtenPixelCount == imagePixelCount else {
+            throw FITSFileError.writeError(status: -1, message: "Previous image has \(imagePixelCount - writtenPixelCount) pixels left to write")
+        }
+        guard width > 0, height > 0, depth > 0 else {
+            throw FITSFileError.writeError(status: -1, message: "Invalid image size \(width)x\(height)x\(depth)")
+        }
+
+        var status: Int32 = 0
+        var naxes = depth > 1 ? [Int64(width), Int64(height), Int64(depth)] : [Int64(width), Int64(height)]
+
+        // Compression settings apply to the next image HDU that is created
+        _ = setCompressionType(fptr, options.compression.cfitsioType, &status)
+        if options.compression != .none {
+            var tileSize = [Int64(width), Int64(max(1, min(options.tileRows, height)))] + (depth > 1 ? [1] : [])
+            _ = setTileDimensions(fptr, Int32(tileSize.count), &tileSize, &status)
+            if let level = options.quantizeLevel, options.pixelFormat == .float32 {
+                _ = setQuantizeLevel(fptr, level, &status)
+            }
+        }
+        _ = createImage(fptr, options.pixelFormat.imageType, Int32(naxes.count), &naxes, &status)
+        try checkWrite(status, "creating \(width)x\(height)x\(depth) image")
+
+        if let header = header {
+            try writeHeaderCards(header)
+        }
+
+        if options.checksum {
+            checksumHDUs.append(try file.currentHDU())
+        }
+
+        imageWidth = width
+        imagePixelFormat = options.pixelFormat
+        imagePixelCount = width * height * depth
+        writtenPixelCount = 0
+
+        Logger.swiftfitsio.debug("Started \(width)x\(height)x\(depth) image in \(self.file.path) (format: \(String(describing: options.pixelFormat)), compression: \(String(describing: options.compression)))")
+    }
+
+    /// Appends whole rows to the current image
+    ///
+    /// Rows are written in storage order: all rows of the first plane, then the next plane.
+    /// Values are physical values. For integer formats they are rounded to the nearest integer
+    /// here, since CFITSIO truncates values that it writes without scaling.
+    /// - Parameter pixels: A multiple of `width` values
+    /// - Throws: An error if the rows do not fit the image or cannot be written
+    public func writeRows(_ pixels: UnsafeBufferPointer<Float32>) throws {
+        guard let fptr = file.fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+        guard imageWidth > 0, pixels.count % imageWidth == 0, writtenPixelCount + pixels.count <= imagePixelCount else {
+            throw FITSFileError.writeError(status: -1, message: "\(pixels.count) values are not whole rows of the remaining image")
+        }
+        guard let baseAddress = pixels.baseAddress, !pixels.isEmpty else {
+            return
+        }
+
+        // Use TFLOAT (42); CFITSIO converts to the pixel format of the HDU
+        let TFLOAT: Int32 = 42
+        var status: Int32 = 0
+        if imagePixelFormat == .float32 {
+            _ = writeImageElements(fptr, TFLOAT, Int64(writtenPixelCount) + 1, Int64(pixels.count), UnsafeMutableRawPointer(mutating: baseAddress), &status)
+        } else {
+            var rounded = pixels.map { $0.rounded() }
+            _ = writeImageElements(fptr, TFLOAT, Int64(writtenPixelCount) + 1, Int64(pixels.count), &rounded, &status)
+        }
+        try checkWrite(status, "writing rows at pixel \(writtenPixelCount)")
+
+        writtenPixelCount += pixels.count
+    }
+
+    /// Writes a complete image with its original values and header
+    /// - Parameters:
+    ///   - image: The image to write
+    ///   - options: Pixel format and compression
+    /// - Throws: An error if the image cannot be written
+    public func write(_ image: FITSImage, options: Options = Options()) throws {
+        try beginImage(width: image.width, height: image.height, depth: image.depth, options: options, header: image.header)
+
+        // Copy a band of rows at a time out of the store, which holds the original values
+        let pixels = image.rawPixels
+        let bandRows = max(options.tileRows, 64)
+        let band = UnsafeMutableBufferPointer<Float32>.allocate(capacity: bandRows * image.width)
+        defer { band.deallocate() }
+
+        for z in 0..<image.depth {
+            var y = 0
+            while y < image.height {
+                let rows = min(bandRows, image.height - y)
+                for row in 0..<rows {
+                    pixels.copyRow(y + row, plane: z, into: band.baseAddress! + row * image.width)
+                }
+                try writeRows(UnsafeBufferPointer(rebasing: band[0..<(rows * image.width)]))
+                y += rows
+            }
+        }
+    }
+
+    /// Writes a processed grayscale image, restoring its original value range
+    ///
+    /// The pixels are taken from the image's buffer or, for Metal images, read back from its
+    /// texture, mapped from 0-1 back to `originalMinValue...originalMaxValue` and written with the
+    /// header of the FITS image it originated from, if any.
+    /// - Parameters:
+    ///   - image: The processed image; a single-channel buffer or an `.r32Float` texture
+    ///   - commandQueue: Command queue used to read back the texture (default: a new queue on the texture's device)
+    ///   - options: Pixel format and compression
+    /// - Throws: An error if the texture cannot be read back or the image cannot be written
+    public func write(_ image: ProcessedImage, commandQueue: MTLCommandQueue? = nil, options: Options = Options()) throws {
+        if let texture = image.existingTexture, image.buffer == nil, texture.pixelFormat != .r32Float {
+            throw FITSFileError.writeError(status: -1, message: "Unsupported texture pixel format \(texture.pixelFormat.rawValue)")
+        }
+
+        let pixels: ImageBuffer
+        do {
+            pixels = try image.pixelBuffer(commandQueue: commandQueue)
+        } catch {
+            throw FITSFileError.writeError(status: -1, message: "Could not read back texture: \(error)")
+        }
+        guard pixels.channels == 1 else {
+            throw FITSFileError.writeError(status: -1, message: "Unsupported image with \(pixels.channels) channels")
+        }
+
+        // Binary masks keep their 0/1 values; grayscale images get their original range back
+        let width = pixels.width
+        let height = pixels.height
+        let range = image.imageType == .grayscale ? image.originalMaxValue - image.originalMinValue : 1
+        let bias = image.imageType == .grayscale ? image.originalMinValue : 0
+
+        try beginImage(width: width, height: height, options: options, header: image.fitsImage?.header)
+
+        let bandRows = max(options.tileRows, 64)
+        let band = UnsafeMutableBufferPointer<Float32>.allocate(capacity: bandRows * width)
+        defer { band.deallocate() }
+
+        var y = 0
+        while y < height {
+            let rows = min(bandRows, height - y)
+            if pixels.isContiguous {
+                convertFloat32ToFloat32(pixels.row(y), band.baseAddress!, rows * width, Double(range), Double(bias))
+            } else {
+                for row in 0..<rows {
+                    convertFloat32ToFloat32(pixels.row(y + row), band.baseAddress! + row * width, width, Double(range), Double(bias))
+                }
+            }
+            try writeRows(UnsafeBufferPointer(rebasing: band[0..<(rows * width)]))
+            y += rows
+        }
+    }
+
+    /// Writes an image to a new file
+    /// - Parameters:
+    ///   - image: The image to write
+    ///   - path: The file path of the new FITS file
+    ///   - options: Pixel format and compression
+    /// - Throws: An error if the file cannot be written
+    public static func write(_ image: FITSImage, to path: String, options: Options = Options()) throws {
+        let writer = try FITSWriter(path: path)
+        try writer.write(image, options: options)
+        try writer.close()
+    }
+
+    /// Writes the cards of a header that do not describe the data layout
+    private func writeHeaderCards(_ header: FITSHeader) throws {
+        guard let fptr = file.fitsfile else {
+            throw FITSFileError.fileNotOpen
+        }
+
+        var status: Int32 = 0
+        var copied = 0
+        for index in 0..<header.table.count {
+            let keyword = header.table.keyword(at: index)
+            guard !FITSWriter.isStructuralKeyword(keyword) else {
+                continue
+            }
+            _ = writeRecord(fptr, header.table.card(at: index), &status)
+            try checkWrite(status, "writing header card \(keyword)")
+            copied += 1
+        }
+
+        Logger.swiftfitsio.debug("Copied \(copied) of \(header.count) header cards")
+    }
+
+    /// Returns true for keywords that CFITSIO derives from the data layout
+    static func isStructuralKeyword(_ keyword: String) -> Bool {
+        switch keyword {
+        case "SIMPLE", "XTENSION", "BITPIX", "NAXIS", "EXTEND", "PCOUNT", "GCOUNT",
+             "BZERO", "BSCALE", "BLANK", "DATAMIN", "DATAMAX", "TFIELDS", "CHECKSUM", "DATASUM", "END":
+            return true
+        default:
+            break
+        }
+        // Axis lengths and the tile-compression keywords of a compressed source (ZBITPIX,
+        // ZNAXISn, ZTILEn, ZCMPTYPE, TTYPEn, TFORMn, ...)
+        for prefix in ["NAXIS", "TTYPE", "TFORM", "TUNIT"] where keyword.hasPrefix(prefix) {
+            return Int(keyword.dropFirst(prefix.count)) != nil
+        }
+        return keyword.hasPrefix("Z") && FITSWriter.compressionKeywords.contains(where: { keyword.hasPrefix($0) })
+    }
+
+    /// Prefixes of the keywords defined by the tiled image compression convention
+    private static let compressionKeywords = [
+        "ZIMAGE", "ZCMPTYPE", "ZBITPIX", "ZNAXIS", "ZTILE", "ZNAME", "ZVAL",
+        "ZMASKCMP", "ZSIMPLE", "ZTENSION", "ZEXTEND", "ZBLOCKED", "ZPCOUNT",
+        "ZGCOUNT", "ZHECKSUM", "ZDATASUM", "ZQUANTIZ", "ZDITHER0", "ZBLANK",
+        "ZSCALE", "ZZERO"
+    ]
+
+    /// Throws a write error for a nonzero CFITSIO status
+    private func checkWrite(_ status: Int32, _ action: String) throws {
+        guard status == 0 else {
+            let errorString = FITSFile.errorMessage(for: status)
+            Logger.swiftfitsio.error("Error \(action) in \(self.file.path): status \(status), \(errorString)")
+            throw FITSFileError.writeError(status: status, message: errorString)
+        }
+    }
+}
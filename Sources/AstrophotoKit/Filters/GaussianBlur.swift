@@ -222,26 +222,28 @@ public class GaussianBlur {
             throw GaussianBlurError.computeError(error)
         }
         
-        // Copy data from buffer to array
+        // Copy data from buffer into a new pixel store, back in the original value range
         let pixelPointer = readBuffer.contents().bindMemory(to: Float32.self, capacity: width * height)
-        let pixelData = Array(UnsafeBufferPointer(start: pixelPointer, count: width * height))
-        
-        // Create raw data
-        let rawData = pixelData.withUnsafeBytes { Data($0) }
+        let store = FITSPixelStore(count: width * height)
+        let range = fitsImage.originalMaxValue - fitsImage.originalMinValue
+        if range > 0 {
+            convertFloat32ToFloat32(pixelPointer, store.pointer, store.count, Double(range), Double(fitsImage.originalMinValue))
+        } else {
+            convertFloat32ToFloat32(pixelPointer, store.pointer, store.count, 1, 0)
+        }
         
-        // Create new FITSImage with blurred data
+        // Create new FITSImage with blurred data (only the first plane is blurred)
         // Keep the same metadata and value range as the original
         return FITSImage(
             width: width,
             height: height,
-            depth: fitsImage.depth,
+            depth: 1,
             bitpix: fitsImage.bitpix,
             dataType: fitsImage.dataType,
-            pixelData: pixelData,
-            rawData: rawData,
+            storage: store,
             originalMinValue: fitsImage.originalMinValue,
             originalMaxValue: fitsImage.originalMaxValue,
-            metadata: fitsImage.metadata
+            header: fitsImage.header
         )
     }
 }
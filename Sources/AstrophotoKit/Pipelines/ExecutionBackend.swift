@@ -0,0 +1,114 @@
+import Foundation
+import Metal
+
+/// The hardware a pipeline executor runs its steps on
+public enum ExecutionBackend {
+    /// Steps run as Metal compute shaders and pass images as textures
+    case metal(device: MTLDevice, commandQueue: MTLCommandQueue)
+
+    /// Steps run on all CPU cores and pass images as `ImageBuffer`s
+    case cpu(CPUComputeContext)
+
+    /// Metal on the default device if there is one, otherwise the CPU
+    public static func systemDefault() -> ExecutionBackend {
+        if let device = MTLCreateSystemDefaultDevice(),
+           let commandQueue = device.makeCommandQueue() {
+            return .metal(device: device, commandQueue: commandQueue)
+        }
+        return .cpu(CPUComputeContext())
+    }
+}
+
+/// Splits CPU image kernels into bands of rows that run concurrently
+///
+/// A context holds no per-image state, so one context can be shared by any number of
+/// executors and threads. Kernels take their output buffers from `bufferPool` if it is set.
+public final class CPUComputeContext {
+    /// Maximum number of bands processed at the same time
+    public let maxConcurrency: Int
+
+    /// Minimum number of rows per band, so that small images are not split into tiny tasks
+    public let minimumRowsPerBand: Int
+
+    /// Pool that output buffers are taken from, or nil to allocate every buffer
+    public let bufferPool: PixelBufferPool?
+
+    /// Creates a compute context
+    /// - Parameters:
+    ///   - maxConcurrency: Maximum number of bands processed at the same time (default: number of active cores)
+    ///   - minimumRowsPerBand: Minimum number of rows per band (default: 16)
+    ///   - bufferPool: Pool for output buffers (default: none)
+    public init(
+        maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount,
+        minimumRowsPerBand: Int = 16,
+        bufferPool: PixelBufferPool? = nil
+    ) {
+        self.maxConcurrency = max(1, maxConcurrency)
+        self.minimumRowsPerBand = max(1, minimumRowsPerBand)
+        self.bufferPool = bufferPool
+    }
+
+    /// Returns an uninitialized output buffer, from the pool if there is one
+    func makeBuffer<Element>(width: Int, height: Int, channels: Int = 1) -> PixelBuffer<Element> {
+        if let bufferPool = bufferPool {
+            return bufferPool.makeBuffer(width: width, height: height, channels: channels)
+        }
+        return PixelBuffer(width: width, height: height, channels: channels)
+    }
+
+    /// Calls `body` for consecutive bands of rows covering `0..<height`, concurrently
+    ///
+    /// There are up to four bands per core so that cores finishing early pick up more work.
+    /// `body` must only write to rows of its own band.
+    /// - Parameters:
+    ///   - height: Number of rows
+    ///   - body: Closure called with the row range of one band
+    public func forEachRowBand(height: Int, _ body: (Range<Int>) -> Void) {
+        guard height > 0 else {
+            return
+        }
+        let bandCount = min(maxConcurrency * 4, (height + minimumRowsPerBand - 1) / minimumRowsPerBand)
+        guard bandCount > 1, maxConcurrency > 1 else {
+            body(0..<height)
+            return
+        }
+
+        let rowsPerBand = (height + bandCount - 1) / bandCount
+        DispatchQueue.concurrentPerform(iterations: bandCount) { band in
+            let start = band * rowsPerBand
+            let end = min(height, start + rowsPerBand)
+            if start < end {
+                body(start..<end)
+            }
+        }
+    }
+
+    /// Calls `partial` for each band of rows concurrently and merges the band results in row order
+    /// - Parameters:
+    ///   - height: Number of rows
+    ///   - initial: The result for no rows
+    ///   - partial: Closure computing the result of one band
+    ///   - combine: Closure merging the result of a band into the accumulated result
+    /// - Returns: The merged result of all bands
+    public func reduceRowBands<Partial, Total>(
+        height: Int,
+        initial: Total,
+        _ partial: (Range<Int>) -> Partial,
+        combine: (inout Total, Partial) -> Void
+    ) -> Total {
+        let lock = NSLock()
+        var results: [(start: Int, value: Partial)] = []
+        forEachRowBand(height: height) { rows in
+            let value = partial(rows)
+            lock.lock()
+            results.append((rows.lowerBound, value))
+            lock.unlock()
+        }
+
+        var result = initial
+        for (_, value) in results.sorted(by: { $0.start < $1.start }) {
+            combine(&result, value)
+        }
+        return result
+    }
+}
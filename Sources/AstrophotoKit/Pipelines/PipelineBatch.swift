@@ -0,0 +1,284 @@
+import Foundation
+import os
+
+/// A frame processed by `PipelineBatch`
+public struct PipelineBatchResult {
+    /// Position of the frame in the batch's input list
+    public let index: Int
+
+    /// The pipeline outputs, or the error that stopped the pipeline for this frame
+    public let result: Result<[String: PipelineData], Error>
+}
+
+/// An asynchronous sequence of pipeline results for many frames processed in parallel
+///
+/// Frames are split into contiguous runs, one per worker; a worker that runs out of frames
+/// steals from the end of the longest remaining run, so slow frames do not hold up the rest
+/// of the batch. At most `maxConcurrentFrames` frames are processed at the same time, and a
+/// frame only starts while the estimated bytes of frames in progress and of results waiting
+/// for the consumer stay within `memoryBudget`; a single frame larger than the budget still
+/// runs once nothing else is in flight.
+///
+/// Results are delivered in completion order with the index of their frame. A frame whose
+/// pipeline fails yields a failed `result` and does not end the batch. The sequence can be
+/// iterated once.
+public final class PipelineBatch: AsyncSequence {
+    public typealias Element = PipelineBatchResult
+
+    /// Progress counters of a batch
+    public struct Metrics: Equatable {
+        /// Frames whose pipeline has finished, including failed ones
+        public var framesCompleted = 0
+        /// Frames whose pipeline failed
+        public var framesFailed = 0
+        /// Frames a worker took from another worker's run
+        public var framesStolen = 0
+        /// Largest number of frames processed at the same time
+        public var peakRunningFrames = 0
+        /// Largest estimate of bytes in flight at the same time
+        public var peakBytesInFlight = 0
+        /// Times a worker waited for room in the memory budget
+        public var budgetWaits = 0
+    }
+
+    /// The executor running the pipeline
+    public let executor: PipelineExecutor
+
+    /// The pipeline run on every frame
+    public let pipeline: Pipeline
+
+    /// Pipeline inputs of every frame
+    public let imageInputs: [[String: PipelineData]]
+
+    /// Maximum number of frames processed at the same time
+    public let maxConcurrentFrames: Int
+
+    /// Maximum estimated bytes of frames in progress and of results not yet consumed
+    public let memoryBudget: Int
+
+    private let condition = NSCondition()
+    private var runs: [[Int]]
+    private var queue: [PipelineBatchResult] = []
+    private var queuedBytes: [Int] = []
+    private var waitingConsumer: CheckedContinuation<PipelineBatchResult?, Never>?
+    private var started = false
+    private var finished = false
+    private var cancelled = false
+    private var runningFrames = 0
+    private var bytesInFlight = 0
+    private var counters = Metrics()
+
+    /// Creates a batch; processing starts when the sequence is first iterated
+    /// - Parameters:
+    ///   - executor: The executor running the pipeline
+    ///   - pipeline: The pipeline run on every frame
+    ///   - imageInputs: Pipeline inputs of every frame
+    ///   - maxConcurrentFrames: Maximum number of frames processed at the same time (default: number of active cores)
+    ///   - memoryBudget: Maximum estimated bytes in flight (default: 4 GiB)
+    public init(
+        executor: PipelineExecutor,
+        pipeline: Pipeline,
+        imageInputs: [[String: PipelineData]],
+        maxConcurrentFrames: Int = ProcessInfo.processInfo.activeProcessorCount,
+        memoryBudget: Int = 4 << 30
+    ) {
+        self.executor = executor
+        self.pipeline = pipeline
+        self.imageInputs = imageInputs
+        self.maxConcurrentFrames = max(1, min(maxConcurrentFrames, imageInputs.count))
+        self.memoryBudget = memoryBudget
+
+        // Contiguous runs of frames, one per worker
+        let workerCount = self.maxConcurrentFrames
+        let runLength = (imageInputs.count + workerCount - 1) / workerCount
+        self.runs = (0..<workerCount).map { worker in
+            let start = min(imageInputs.count, worker * runLength)
+            return Array(start..<min(imageInputs.count, start + runLength))
+        }
+    }
+
+    deinit {
+        cancel()
+    }
+
+    /// Current progress counters
+    public var metrics: Metrics {
+        condition.lock()
+        defer { condition.unlock() }
+        return counters
+    }
+
+    /// Stops starting new frames; frames in progress still finish and are delivered
+    ///
+    /// Called automatically when the iterator is discarded before the sequence ends, and when
+    /// the task waiting for the next result is cancelled.
+    public func cancel() {
+        condition.lock()
+        cancelled = true
+        condition.broadcast()
+        condition.unlock()
+    }
+
+    public struct Iterator: AsyncIteratorProtocol {
+        /// Cancels the batch when the last copy of the iterator goes away
+        final class Lifetime {
+            let batch: PipelineBatch
+
+            init(batch: PipelineBatch) {
+                self.batch = batch
+            }
+
+            deinit {
+                batch.cancel()
+            }
+        }
+
+        let lifetime: Lifetime
+
+        public mutating func next() async -> PipelineBatchResult? {
+            return await lifetime.batch.nextResult()
+        }
+    }
+
+    public func makeAsyncIterator() -> Iterator {
+        return Iterator(lifetime: Iterator.Lifetime(batch: self))
+    }
+
+    /// Returns the next finished frame, waiting for the workers if none is ready yet
+    ///
+    /// Cancelling the waiting task cancels the batch; the frames still in progress are delivered
+    /// and the sequence then ends.
+    private func nextResult() async -> PipelineBatchResult? {
+        return await withTaskCancellationHandler {
+            await waitForResult()
+        } onCancel: {
+            cancel()
+        }
+    }
+
+    private func waitForResult() async -> PipelineBatchResult? {
+        return await withCheckedContinuation { continuation in
+            condition.lock()
+            if !started {
+                started = true
+                Thread.detachNewThread { [self] in
+                    self.process()
+                }
+            }
+            if !queue.isEmpty {
+                let result = queue.removeFirst()
+                bytesInFlight -= queuedBytes.removeFirst()
+                condition.broadcast()
+                condition.unlock()
+                continuation.resume(returning: result)
+            } else if finished {
+                condition.unlock()
+                continuation.resume(returning: nil)
+            } else {
+                waitingConsumer = continuation
+                condition.unlock()
+            }
+        }
+    }
+
+    /// Runs the workers until every frame is done or the batch is cancelled
+    private func process() {
+        DispatchQueue.concurrentPerform(iterations: maxConcurrentFrames) { worker in
+            while let frame = takeFrame(worker: worker) {
+                let result = Result { try executor.execute(pipeline: pipeline, inputs: imageInputs[frame.index]) }
+                if case .failure(let error) = result {
+                    Logger.pipeline.error("Batch item \(frame.index) failed: \(error.localizedDescription)")
+                }
+                deliver(PipelineBatchResult(index: frame.index, result: result), byteCount: frame.byteCount)
+            }
+        }
+
+        condition.lock()
+        finished = true
+        let consumer = waitingConsumer
+        waitingConsumer = nil
+        condition.unlock()
+        consumer?.resume(returning: nil)
+
+        Logger.pipeline.debug("Batch finished \(self.metrics.framesCompleted) of \(self.imageInputs.count) frames, \(self.metrics.framesFailed) failed")
+    }
+
+    /// Takes the next frame of a worker's run, or steals one, once the memory budget has room for it
+    private func takeFrame(worker: Int) -> (index: Int, byteCount: Int)? {
+        condition.lock()
+        defer { condition.unlock() }
+
+        var waited = false
+        while !cancelled {
+            let index: Int
+            if !runs[worker].isEmpty {
+                index = runs[worker][0]
+            } else if let victim = runs.indices.max(by: { runs[$0].count < runs[$1].count }), !runs[victim].isEmpty {
+                index = runs[victim].last!
+            } else {
+                return nil
+            }
+
+            let byteCount = estimatedByteCount(of: index)
+            guard bytesInFlight == 0 || bytesInFlight + byteCount <= memoryBudget else {
+                if !waited {
+                    counters.budgetWaits += 1
+                    waited = true
+                }
+                condition.wait()
+                continue
+            }
+
+            if runs[worker].first == index {
+                runs[worker].removeFirst()
+            } else if let victim = runs.firstIndex(where: { $0.last == index }) {
+                runs[victim].removeLast()
+                counters.framesStolen += 1
+            }
+            runningFrames += 1
+            bytesInFlight += byteCount
+            counters.peakRunningFrames = max(counters.peakRunningFrames, runningFrames)
+            counters.peakBytesInFlight = max(counters.peakBytesInFlight, bytesInFlight)
+            return (index, byteCount)
+        }
+        return nil
+    }
+
+    /// Hands a finished frame to the waiting consumer or queues it
+    ///
+    /// The frame's bytes stay reserved until the consumer takes the result.
+    private func deliver(_ result: PipelineBatchResult, byteCount: Int) {
+        condition.lock()
+        runningFrames -= 1
+        counters.framesCompleted += 1
+        if case .failure = result.result {
+            counters.framesFailed += 1
+        }
+        if let consumer = waitingConsumer {
+            waitingConsumer = nil
+            bytesInFlight -= byteCount
+            condition.broadcast()
+            condition.unlock()
+            consumer.resume(returning: result)
+        } else {
+            queue.append(result)
+            queuedBytes.append(byteCount)
+            condition.unlock()
+        }
+    }
+
+    /// Estimated bytes of one frame: its input images plus an image of the same size per step
+    private func estimatedByteCount(of index: Int) -> Int {
+        var inputBytes = 0
+        for data in imageInputs[index].values {
+            if let image = data.fitsImage {
+                inputBytes += image.width * image.height * image.depth * MemoryLayout<Float32>.stride
+            } else if let buffer = data.processedImage?.buffer {
+                inputBytes += buffer.width * buffer.height * buffer.channels * MemoryLayout<Float32>.stride
+            } else if let texture = data.texture ?? data.processedImage?.existingTexture {
+                inputBytes += texture.width * texture.height * 4 * MemoryLayout<Float32>.stride
+            }
+        }
+        return inputBytes * (pipeline.steps.count + 1)
+    }
+}
@@ -4,26 +4,73 @@ import os
 
 /// Executes pipelines on images or sets of images
 public class PipelineExecutor {
-    private let device: MTLDevice
-    private let commandQueue: MTLCommandQueue
+    /// The hardware the pipeline steps run on
+    public let backend: ExecutionBackend
+    
+    /// Pool the steps take their intermediate images from, shared by all runs of this executor
+    public let bufferPool: PixelBufferPool
+    
+    /// Maximum number of independent steps of one pipeline run executed at the same time
+    public let maxConcurrentSteps: Int
     
     /// Cache of processed images to enable reuse across pipelines
     /// Key: A string identifier based on processing history
     /// Value: The ProcessedImage
     private var processedImageCache: [String: ProcessedImage] = [:]
     
-    /// Initialize the pipeline executor
-    /// - Parameter device: Optional Metal device (uses default if nil)
-    public init(device: MTLDevice? = nil) throws {
+    /// Initialize the pipeline executor on Metal
+    /// - Parameters:
+    ///   - device: Optional Metal device (uses default if nil)
+    ///   - bufferPool: Pool for intermediate images (default: a new pool)
+    ///   - maxConcurrentSteps: Maximum number of independent steps run at the same time (default: number of active cores)
+    public init(
+        device: MTLDevice? = nil,
+        bufferPool: PixelBufferPool? = nil,
+        maxConcurrentSteps: Int = ProcessInfo.processInfo.activeProcessorCount
+    ) throws {
         guard let device = device ?? MTLCreateSystemDefaultDevice() else {
             throw PipelineError.metalNotAvailable
         }
-        self.device = device
         
         guard let commandQueue = device.makeCommandQueue() else {
             throw PipelineError.couldNotCreateCommandQueue
         }
-        self.commandQueue = commandQueue
+        self.backend = .metal(device: device, commandQueue: commandQueue)
+        self.bufferPool = bufferPool ?? PixelBufferPool()
+        self.maxConcurrentSteps = max(1, maxConcurrentSteps)
+    }
+    
+    /// Initialize the pipeline executor on a given backend
+    ///
+    /// On the CPU the pool of the compute context is used if it has one; otherwise the context
+    /// is replaced by one with the same settings that takes its buffers from `bufferPool`.
+    /// - Parameters:
+    ///   - backend: The backend to run the steps on, e.g. `.cpu(CPUComputeContext())` on machines without Metal
+    ///   - bufferPool: Pool for intermediate images (default: a new pool)
+    ///   - maxConcurrentSteps: Maximum number of independent steps run at the same time (default: number of active cores)
+    public init(
+        backend: ExecutionBackend,
+        bufferPool: PixelBufferPool? = nil,
+        maxConcurrentSteps: Int = ProcessInfo.processInfo.activeProcessorCount
+    ) {
+        self.maxConcurrentSteps = max(1, maxConcurrentSteps)
+        switch backend {
+        case .metal:
+            self.backend = backend
+            self.bufferPool = bufferPool ?? PixelBufferPool()
+        case .cpu(let context):
+            let pool = bufferPool ?? context.bufferPool ?? PixelBufferPool()
+            if context.bufferPool === pool {
+                self.backend = backend
+            } else {
+                self.backend = .cpu(CPUComputeContext(
+                    maxConcurrency: context.maxConcurrency,
+                    minimumRowsPerBand: context.minimumRowsPerBand,
+                    bufferPool: pool
+                ))
+            }
+            self.bufferPool = pool
+        }
     }
     
     /// Clear the processed image cache
@@ -96,14 +143,21 @@ public class PipelineExecutor {
     }
     
     /// Callback type for incremental pipeline execution
-    /// Called after each step completes with the step's outputs
+    /// Called after each step completes with the step's index and outputs. Independent steps may
+    /// complete out of order and on other threads, but calls never overlap.
     public typealias StepOutputCallback = (Int, PipelineStep, [String: PipelineData]) -> Void
     
     /// Execute a pipeline on a single image
+    ///
+    /// A step runs as soon as the steps producing its inputs have finished, so independent
+    /// branches of the pipeline (see `PipelineGraph`) run concurrently, up to `maxConcurrentSteps`
+    /// at a time. Every step reads the same outputs as in a run in array order, and each output
+    /// keeps its name, so the results are the same whatever the order in which steps finish.
     /// - Parameters:
     ///   - pipeline: The pipeline to execute
     ///   - inputs: Dictionary of input name to PipelineData
-    ///   - stepOutputCallback: Optional callback called after each step completes with its outputs
+    ///   - stepOutputCallback: Optional callback called after each step completes with its outputs;
+    ///     calls are made one at a time, in completion order, while other steps keep running
     /// - Returns: Dictionary of output name to PipelineData
     /// - Throws: PipelineError if execution fails
     public func execute(
@@ -134,7 +188,13 @@ public class PipelineExecutor {
                 // Convert FITSImage or texture to ProcessedImage
                 if let fitsImage = inputImage.fitsImage {
                     do {
-                        let processedImage = try ProcessedImage.fromFITSImage(fitsImage, device: device)
+                        let processedImage: ProcessedImage
+                        switch backend {
+                        case .metal(let device, _):
+                            processedImage = try ProcessedImage.fromFITSImage(fitsImage, device: device)
+                        case .cpu:
+                            processedImage = ProcessedImage.fromFITSImage(fitsImage)
+                        }
                         availableData["input_image"] = .processedImage(processedImage)
                     } catch {
                         // If conversion fails, keep original input
@@ -156,131 +216,96 @@ public class PipelineExecutor {
             }
         }
         
-        // Execute each step in order
-        for (stepIndex, step) in pipeline.steps.enumerated() {
-            // Build inputs for this step
-            var stepInputs: [String: PipelineStepInput] = [:]
-            
-            // Add required inputs
-            for inputName in step.requiredInputs {
-                guard let data = availableData[inputName] else {
-                    throw PipelineError.missingRequiredInput(inputName)
+        // Run the steps as their inputs become available; independent steps run concurrently
+        let graph = PipelineGraph(pipeline: pipeline)
+        let stepCount = pipeline.steps.count
+        let workerCount = graph.isChain ? 1 : min(maxConcurrentSteps, stepCount)
+        let condition = NSCondition()
+        let callbackLock = NSLock()
+        var stepResults = [[String: PipelineData]?](repeating: nil, count: stepCount)
+        var remainingDependencies = graph.dependencies.map(\.count)
+        var readySteps = (0..<stepCount).filter { remainingDependencies[$0] == 0 }
+        var runningSteps = 0
+        var firstFailure: (index: Int, error: Error)?
+        let initialData = availableData
+        
+        DispatchQueue.concurrentPerform(iterations: max(1, workerCount)) { _ in
+            while true {
+                condition.lock()
+                while readySteps.isEmpty && runningSteps > 0 && firstFailure == nil {
+                    condition.wait()
                 }
-                stepInputs[inputName] = PipelineStepInput(name: inputName, data: data)
-            }
-            
-            // Add optional inputs if available
-            for inputName in step.optionalInputs {
-                if let data = availableData[inputName] {
-                    stepInputs[inputName] = PipelineStepInput(name: inputName, data: data)
+                guard firstFailure == nil, !readySteps.isEmpty else {
+                    condition.broadcast()
+                    condition.unlock()
+                    return
                 }
-            }
-            
-            // Add pipeline context so steps can build history from the pipeline structure
-            // Pass information about previous steps and their outputs
-            let previousSteps = Array(pipeline.steps.prefix(stepIndex))
-            
-            // Collect all ProcessedImage and ProcessedTable outputs from previous steps
-            // Steps can use these to build complete history
-            var previousStepOutputs: [[String: Any]] = []
-            for (idx, previousStep) in previousSteps.enumerated() {
-                var stepOutputInfo: [String: Any] = [
-                    "step_id": previousStep.id,
-                    "step_name": previousStep.name,
-                    "step_index": idx
-                ]
+                // Lowest index first, so a chain of steps keeps the order of the pipeline
+                let stepIndex = readySteps.removeFirst()
+                let step = pipeline.steps[stepIndex]
+                let stepInputs = Result {
+                    try self.inputs(
+                        forStep: stepIndex,
+                        of: pipeline,
+                        graph: graph,
+                        initialData: initialData,
+                        stepResults: stepResults
+                    )
+                }
+                runningSteps += 1
+                condition.unlock()
                 
-                // Find ProcessedDataContainer, ProcessedImage, or ProcessedTable outputs from this step
-                var processedOutputs: [String: Any] = [:]
-                for outputName in previousStep.outputs {
-                    if let data = availableData[outputName] {
-                        // Check for ProcessedDataContainer first (most generic)
-                        if let processedData = data.processedData {
-                            processedOutputs[outputName] = [
-                                "type": "processedData",
-                                "dataType": String(describing: processedData.dataType),
-                                "processing_history": processedData.processingHistory.map { step in
-                                    [
-                                        "step_id": step.stepID,
-                                        "step_name": step.stepName,
-                                        "parameters": step.parameters,
-                                        "order": step.order
-                                    ]
-                                }
-                            ]
-                        } else if let processedImage = data.processedImage {
-                            processedOutputs[outputName] = [
-                                "type": "processedImage",
-                                "processing_history": processedImage.processingHistory.map { step in
-                                    [
-                                        "step_id": step.stepID,
-                                        "step_name": step.stepName,
-                                        "parameters": step.parameters,
-                                        "order": step.order
-                                    ]
-                                }
-                            ]
-                        } else if let processedTable = data.processedTable {
-                            processedOutputs[outputName] = [
-                                "type": "processedTable",
-                                "processing_history": processedTable.processingHistory.map { step in
-                                    [
-                                        "step_id": step.stepID,
-                                        "step_name": step.stepName,
-                                        "parameters": step.parameters,
-                                        "order": step.order
-                                    ]
-                                }
-                            ]
+                let result = stepInputs.flatMap { inputs in
+                    Result { try self.run(step, inputs: inputs) }
+                }
+                
+                var completedOutputs: [String: PipelineData]?
+                condition.lock()
+                runningSteps -= 1
+                switch result {
+                case .success(let stepOutputs):
+                    var stepOutputData: [String: PipelineData] = [:]
+                    for (outputName, output) in stepOutputs {
+                        stepOutputData[outputName] = output.data
+                    }
+                    stepResults[stepIndex] = stepOutputData
+                    completedOutputs = stepOutputData
+                    
+                    for dependent in graph.dependents[stepIndex] {
+                        remainingDependencies[dependent] -= 1
+                        if remainingDependencies[dependent] == 0 {
+                            let position = readySteps.firstIndex { $0 > dependent } ?? readySteps.endIndex
+                            readySteps.insert(dependent, at: position)
                         }
                     }
+                case .failure(let error):
+                    // Report the failure of the earliest step, whatever finished first
+                    if firstFailure.map({ stepIndex < $0.index }) ?? true {
+                        firstFailure = (stepIndex, error)
+                    }
                 }
+                condition.broadcast()
+                condition.unlock()
                 
-                if !processedOutputs.isEmpty {
-                    stepOutputInfo["outputs"] = processedOutputs
+                // The callback runs outside the scheduler lock, so a slow callback does not hold
+                // up other steps; its own lock keeps calls from overlapping
+                if let outputs = completedOutputs, let callback = stepOutputCallback {
+                    callbackLock.lock()
+                    callback(stepIndex, step, outputs)
+                    callbackLock.unlock()
                 }
-                
-                previousStepOutputs.append(stepOutputInfo)
             }
-            
-            stepInputs["_pipeline_context"] = PipelineStepInput(
-                name: "_pipeline_context",
-                data: .metadata([
-                    "previous_steps": previousStepOutputs,
-                    "current_step_index": stepIndex,
-                    "total_steps": pipeline.steps.count
-                ])
-            )
-            
-            // Execute the step
-            let stepOutputs: [String: PipelineStepOutput]
-            do {
-                stepOutputs = try step.execute(
-                    inputs: stepInputs,
-                    device: device,
-                    commandQueue: commandQueue
-                )
-            } catch let error as PipelineStepError {
-                throw PipelineError.stepExecutionFailed(step.name, error)
-            } catch {
-                throw PipelineError.stepExecutionFailed(step.name, .executionFailed(error.localizedDescription))
-            }
-            
-            // Add step outputs to available data
-            var stepOutputData: [String: PipelineData] = [:]
-            for (outputName, output) in stepOutputs {
-                availableData[outputName] = output.data
-                stepOutputData[outputName] = output.data
-            }
-            
-            // Call callback with step outputs if provided
-            stepOutputCallback?(stepIndex, step, stepOutputData)
         }
         
-        // Return only the final outputs specified by the pipeline
+        if let failure = firstFailure {
+            throw failure.error
+        }
+        
+        // Return only the final outputs specified by the pipeline, from the last step producing each
         var finalOutputs: [String: PipelineData] = [:]
         for outputName in pipeline.outputs {
-            if let data = availableData[outputName] {
+            let producer = stepResults.lastIndex { $0?[outputName] != nil }
+            if let data = producer.flatMap({ stepResults[$0]?[outputName] }) ?? initialData[outputName] {
                 finalOutputs[outputName] = data
             }
         }
@@ -288,6 +313,143 @@ public class PipelineExecutor {
         return finalOutputs
     }
     
+    /// Collects the inputs of a step from the pipeline inputs and the outputs of the steps it depends on
+    ///
+    /// An input written by several earlier steps is taken from the last of them, as in a run in
+    /// array order. The pipeline context lists the steps the step depends on directly or
+    /// indirectly, with their indices in the pipeline.
+    private func inputs(
+        forStep stepIndex: Int,
+        of pipeline: Pipeline,
+        graph: PipelineGraph,
+        initialData: [String: PipelineData],
+        stepResults: [[String: PipelineData]?]
+    ) throws -> [String: PipelineStepInput] {
+        let step = pipeline.steps[stepIndex]
+        func data(for inputName: String) -> PipelineData? {
+            for producer in (graph.producers[stepIndex][inputName] ?? []).reversed() {
+                if let data = stepResults[producer]?[inputName] {
+                    return data
+                }
+            }
+            return initialData[inputName]
+        }
+        
+        var stepInputs: [String: PipelineStepInput] = [:]
+        
+        // Add required inputs
+        for inputName in step.requiredInputs {
+            guard let inputData = data(for: inputName) else {
+                throw PipelineError.missingRequiredInput(inputName)
+            }
+            stepInputs[inputName] = PipelineStepInput(name: inputName, data: inputData)
+        }
+        
+        // Add optional inputs if available
+        for inputName in step.optionalInputs {
+            if let inputData = data(for: inputName) {
+                stepInputs[inputName] = PipelineStepInput(name: inputName, data: inputData)
+            }
+        }
+        
+        // Add pipeline context so steps can build history from the pipeline structure
+        // Collect all ProcessedImage and ProcessedTable outputs from the steps this one depends on
+        var previousStepOutputs: [[String: Any]] = []
+        for index in graph.ancestors[stepIndex] {
+            previousStepOutputs.append(stepOutputInfo(
+                for: pipeline.steps[index],
+                index: index,
+                outputs: stepResults[index] ?? [:]
+            ))
+        }
+        
+        stepInputs["_pipeline_context"] = PipelineStepInput(
+            name: "_pipeline_context",
+            data: .metadata([
+                "previous_steps": previousStepOutputs,
+                "current_step_index": stepIndex,
+                "total_steps": pipeline.steps.count,
+                "buffer_pool": bufferPool
+            ])
+        )
+        return stepInputs
+    }
+    
+    /// Describes a completed step and the processing history of its outputs for the pipeline context
+    private func stepOutputInfo(
+        for step: PipelineStep,
+        index: Int,
+        outputs: [String: PipelineData]
+    ) -> [String: Any] {
+        var stepOutputInfo: [String: Any] = [
+            "step_id": step.id,
+            "step_name": step.name,
+            "step_index": index
+        ]
+        
+        func historyInfo(_ history: [ProcessingStep]) -> [[String: Any]] {
+            return history.map { step in
+                [
+                    "step_id": step.stepID,
+                    "step_name": step.stepName,
+                    "parameters": step.parameters,
+                    "order": step.order
+                ]
+            }
+        }
+        
+        // Find ProcessedDataContainer, ProcessedImage, or ProcessedTable outputs from this step
+        var processedOutputs: [String: Any] = [:]
+        for outputName in step.outputs {
+            guard let data = outputs[outputName] else {
+                continue
+            }
+            // Check for ProcessedDataContainer first (most generic)
+            if let processedData = data.processedData {
+                processedOutputs[outputName] = [
+                    "type": "processedData",
+                    "dataType": String(describing: processedData.dataType),
+                    "processing_history": historyInfo(processedData.processingHistory)
+                ]
+            } else if let processedImage = data.processedImage {
+                processedOutputs[outputName] = [
+                    "type": "processedImage",
+                    "processing_history": historyInfo(processedImage.processingHistory)
+                ]
+            } else if let processedTable = data.processedTable {
+                processedOutputs[outputName] = [
+                    "type": "processedTable",
+                    "processing_history": historyInfo(processedTable.processingHistory)
+                ]
+            }
+        }
+        
+        if !processedOutputs.isEmpty {
+            stepOutputInfo["outputs"] = processedOutputs
+        }
+        return stepOutputInfo
+    }
+    
+    /// Runs one step on the executor's backend
+    private func run(_ step: PipelineStep, inputs: [String: PipelineStepInput]) throws -> [String: PipelineStepOutput] {
+        do {
+            switch backend {
+            case .metal(let device, let commandQueue):
+                return try step.execute(
+                    inputs: inputs,
+                    device: device,
+                    commandQueue: commandQueue
+                )
+            case .cpu(let context):
+                return try step.execute(inputs: inputs, context: context)
+            }
+        } catch let error as PipelineStepError {
+            throw PipelineError.stepExecutionFailed(step.name, error)
+        } catch {
+            throw PipelineError.stepExecutionFailed(step.name, .executionFailed(error.localizedDescription))
+        }
+    }
+    
     /// Execute a pipeline on multiple images (batch processing)
     /// - Parameters:
     ///   - pipeline: The pipeline to execute
@@ -314,5 +476,89 @@ public class PipelineExecutor {
         
         return results
     }
+    
+    /// Execute a pipeline on multiple images in parallel (batch processing)
+    ///
+    /// Frames are spread over up to `maxConcurrentFrames` workers that steal work from each
+    /// other, and results stream back in completion order with the index of their frame. A
+    /// frame that fails yields a failed result instead of ending the batch.
+    /// - Parameters:
+    ///   - pipeline: The pipeline to execute
+    ///   - imageInputs: Array of input dictionaries, one per image
+    ///   - maxConcurrentFrames: Maximum number of frames processed at the same time (default: number of active cores)
+    ///   - memoryBudget: Maximum estimated bytes of frames in flight and unconsumed results (default: 4 GiB)
+    /// - Returns: The batch, which starts processing when it is first iterated
+    public func executeBatchInParallel(
+        pipeline: Pipeline,
+        imageInputs: [[String: PipelineData]],
+        maxConcurrentFrames: Int = ProcessInfo.processInfo.activeProcessorCount,
+        memoryBudget: Int = 4 << 30
+    ) -> PipelineBatch {
+        return PipelineBatch(
+            executor: self,
+            pipeline: pipeline,
+            imageInputs: imageInputs,
+            maxConcurrentFrames: maxConcurrentFrames,
+            memoryBudget: memoryBudget
+        )
+    }
+    
+    /// Execute a pipeline on frames read ahead by a frame loader (batch processing)
+    ///
+    /// Each frame is passed to the pipeline as `inputName` when the consumer asks for its
+    /// result, while the loader reads the next frames in the background, so reading overlaps
+    /// with processing. Results stream back one at a time instead of being collected, so the
+    /// loader can reuse the pixel stores of frames whose results have been released. A frame
+    /// that cannot be read or whose pipeline fails is logged and yields a failed result; the
+    /// remaining frames are still processed.
+    /// - Parameters:
+    ///   - pipeline: The pipeline to execute
+    ///   - frames: The loader producing the input frames
+    ///   - inputName: The pipeline input that receives each frame (default: "input_image")
+    /// - Returns: The batch, which yields one result per frame, in frame order
+    public func executeBatch(
+        pipeline: Pipeline,
+        frames: FITSFrameLoader,
+        inputName: String = "input_image"
+    ) -> PipelineFrameBatch {
+        return PipelineFrameBatch(executor: self, pipeline: pipeline, frames: frames, inputName: inputName)
+    }
+    
+    /// Execute a pipeline on the frames of a SER video (batch processing)
+    ///
+    /// Frames are converted from the mapped file in parallel chunks, without opening a file
+    /// per frame, and each frame is then passed to the pipeline as `inputName` in order. A frame
+    /// whose pipeline fails is logged and yields a failed result; the remaining frames are
+    /// still processed.
+    /// - Parameters:
+    ///   - pipeline: The pipeline to execute
+    ///   - serFile: The SER file providing the frames
+    ///   - frameRange: Frames to process (nil = all frames)
+    ///   - chunkSize: Number of frames converted together (default: twice the number of active cores)
+    ///   - inputName: The pipeline input that receives each frame (default: "input_image")
+    /// - Returns: One result per frame, in frame order, with the frame number in the file as index
+    public func executeBatch(
+        pipeline: Pipeline,
+        serFile: SERFile,
+        frameRange: Range<Int>? = nil,
+        chunkSize: Int = 2 * ProcessInfo.processInfo.activeProcessorCount,
+        inputName: String = "input_image"
+    ) -> [PipelineBatchResult] {
+        var results: [PipelineBatchResult] = []
+        
+        serFile.forEachFrameChunk(in: frameRange, chunkSize: chunkSize) { firstFrame, images in
+            for (offset, image) in images.enumerated() {
+                let index = firstFrame + offset
+                let result = Result { () throws -> [String: PipelineData] in
+                    try execute(pipeline: pipeline, inputs: [inputName: .fitsImage(image)])
+                }
+                if case .failure(let error) = result {
+                    Logger.pipeline.error("Batch item \(index) (frame of \(serFile.path)) failed: \(error.localizedDescription)")
+                }
+                results.append(PipelineBatchResult(index: index, result: result))
+            }
+        }
+        
+        return results
+    }
 }
-
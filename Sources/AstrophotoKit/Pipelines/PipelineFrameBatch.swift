@@ -0,0 +1,56 @@
+import Foundation
+import os
+
+/// An asynchronous sequence of pipeline results for frames read ahead by a `FITSFrameLoader`
+///
+/// Each frame is processed when the consumer asks for the next result, while the loader reads
+/// the following frames in the background. Results are not collected: once the consumer has
+/// released a result, the loader can reuse the pixel store of its frame for a later one.
+///
+/// Results are delivered in frame order. A frame that cannot be read or whose pipeline fails
+/// is logged and yields a failed `result`; the remaining frames are still processed.
+/// Cancelling the consuming task cancels the loader and ends the sequence. The sequence can
+/// be iterated once.
+public struct PipelineFrameBatch: AsyncSequence {
+    public typealias Element = PipelineBatchResult
+
+    /// The executor running the pipeline
+    public let executor: PipelineExecutor
+
+    /// The pipeline run on every frame
+    public let pipeline: Pipeline
+
+    /// The loader producing the input frames
+    public let frames: FITSFrameLoader
+
+    /// The pipeline input that receives each frame
+    public let inputName: String
+
+    public struct Iterator: AsyncIteratorProtocol {
+        let batch: PipelineFrameBatch
+        var frames: FITSFrameLoader.Iterator
+
+        public mutating func next() async -> PipelineBatchResult? {
+            guard let frame = await frames.next() else {
+                return nil
+            }
+            if Task.isCancelled {
+                batch.frames.cancel()
+                return nil
+            }
+
+            let result = Result { () throws -> [String: PipelineData] in
+                let image = try frame.result.get()
+                return try batch.executor.execute(pipeline: batch.pipeline, inputs: [batch.inputName: .fitsImage(image)])
+            }
+            if case .failure(let error) = result {
+                Logger.pipeline.error("Batch item \(frame.index) (\(frame.path)) failed: \(error.localizedDescription)")
+            }
+            return PipelineBatchResult(index: frame.index, result: result)
+        }
+    }
+
+    public func makeAsyncIterator() -> Iterator {
+        return Iterator(batch: self, frames: frames.makeAsyncIterator())
+    }
+}
@@ -0,0 +1,87 @@
+import Foundation
+
+/// The data dependencies between the steps of a pipeline
+///
+/// A step depends on every earlier step that declares one of its required or optional inputs
+/// as an output. Steps without a path between them are independent and may run at the same
+/// time. Each step still reads the outputs of the same earlier steps as it would in a run in
+/// array order, so the results do not depend on which independent step finishes first.
+public struct PipelineGraph {
+    /// For each step, the indices of the steps it reads outputs from (ascending)
+    public let dependencies: [[Int]]
+
+    /// For each step, the indices of the steps that read its outputs (ascending)
+    public let dependents: [[Int]]
+
+    /// For each step, the indices of all steps it depends on directly or indirectly (ascending)
+    public let ancestors: [[Int]]
+
+    /// Steps grouped by the length of their longest dependency chain
+    ///
+    /// The steps of a level do not depend on each other; level 0 holds the steps that only
+    /// read pipeline inputs.
+    public let levels: [[Int]]
+
+    /// For each step and input name, the earlier steps declaring that name as an output (ascending)
+    let producers: [[String: [Int]]]
+
+    /// Builds the graph of a pipeline
+    /// - Parameter pipeline: The pipeline
+    public init(pipeline: Pipeline) {
+        self.init(steps: pipeline.steps)
+    }
+
+    /// Builds the graph of steps listed in execution order
+    /// - Parameter steps: The steps
+    public init(steps: [PipelineStep]) {
+        var writers: [String: [Int]] = [:]
+        var producers: [[String: [Int]]] = []
+        var dependencies: [[Int]] = []
+        var dependents = [[Int]](repeating: [], count: steps.count)
+        var ancestors: [[Int]] = []
+        var depths: [Int] = []
+
+        for (index, step) in steps.enumerated() {
+            var stepProducers: [String: [Int]] = [:]
+            var stepDependencies = Set<Int>()
+            for inputName in step.requiredInputs + step.optionalInputs {
+                if let inputWriters = writers[inputName] {
+                    stepProducers[inputName] = inputWriters
+                    stepDependencies.formUnion(inputWriters)
+                }
+            }
+
+            let sortedDependencies = stepDependencies.sorted()
+            var stepAncestors = stepDependencies
+            for dependency in sortedDependencies {
+                stepAncestors.formUnion(ancestors[dependency])
+                dependents[dependency].append(index)
+            }
+
+            producers.append(stepProducers)
+            dependencies.append(sortedDependencies)
+            ancestors.append(stepAncestors.sorted())
+            depths.append((sortedDependencies.map { depths[$0] }.max() ?? -1) + 1)
+
+            for outputName in step.outputs {
+                writers[outputName, default: []].append(index)
+            }
+        }
+
+        var levels = [[Int]](repeating: [], count: (depths.max() ?? -1) + 1)
+        for (index, depth) in depths.enumerated() {
+            levels[depth].append(index)
+        }
+
+        self.producers = producers
+        self.dependencies = dependencies
+        self.dependents = dependents
+        self.ancestors = ancestors
+        self.levels = levels
+    }
+
+    /// True if every step depends on the one before it, so no two steps can run at the same time
+    public var isChain: Bool {
+        levels.allSatisfy { $0.count <= 1 }
+    }
+}
@@ -111,6 +111,65 @@ public protocol PipelineStep {
         device: MTLDevice,
         commandQueue: MTLCommandQueue
     ) throws -> [String: PipelineStepOutput]
+    
+    /// Execute this step on the CPU, without Metal
+    /// - Parameters:
+    ///   - inputs: Dictionary of input name to PipelineStepInput
+    ///   - context: CPU compute context that spreads the work over all cores
+    /// - Returns: Dictionary of output name to PipelineStepOutput
+    /// - Throws: PipelineStepError if execution fails or the step has no CPU implementation
+    func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput]
+}
+
+public extension PipelineStep {
+    /// Default for steps that only run with Metal
+    func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        throw PipelineStepError.executionFailed("'\(name)' has no CPU implementation")
+    }
+}
+
+extension PipelineStep {
+    /// Resolves an image input for CPU execution
+    ///
+    /// FITS images are wrapped without copying; images computed with Metal are read back.
+    /// - Parameter input: The image input
+    /// - Returns: The input as a ProcessedImage and its single-channel pixels
+    /// - Throws: PipelineStepError if the input is not a grayscale or binary image
+    func cpuInputImage(_ input: PipelineStepInput) throws -> (image: ProcessedImage, pixels: ImageBuffer) {
+        let processedImage: ProcessedImage
+        if let image = input.data.processedImage {
+            processedImage = image
+        } else if let fitsImage = input.data.fitsImage {
+            processedImage = ProcessedImage.fromFITSImage(fitsImage)
+        } else if let texture = input.data.texture {
+            processedImage = ProcessedImage(
+                texture: texture,
+                imageType: ProcessedImage.imageType(from: texture.pixelFormat),
+                name: input.name
+            )
+        } else {
+            throw PipelineStepError.invalidInputType(input.name, expected: "processedImage, texture, or fitsImage")
+        }
+        
+        let pixels = try processedImage.pixelBuffer()
+        guard pixels.channels == 1 else {
+            throw PipelineStepError.invalidInputType(input.name, expected: "single-channel image")
+        }
+        return (processedImage, pixels)
+    }
+    
+    /// The executor's pool for intermediate images, if the step runs in a pipeline
+    ///
+    /// Steps take CPU buffers, and textures that the CPU reads back, from it.
+    func bufferPool(in inputs: [String: PipelineStepInput]) -> PixelBufferPool? {
+        return inputs["_pipeline_context"]?.data.metadata?["buffer_pool"] as? PixelBufferPool
+    }
 }
 
 /// Errors that can occur during pipeline step execution
@@ -155,8 +214,8 @@ public extension PipelineData {
     /// Extract texture if this is a texture, processed image, or processed data container with image
     var texture: MTLTexture? {
         if case .texture(let tex) = self { return tex }
-        if case .processedImage(let img) = self { return img.texture }
-        if case .processedData(let container) = self { return container.image?.texture }
+        if case .processedImage(let img) = self { return img.existingTexture }
+        if case .processedData(let container) = self { return container.image?.existingTexture }
         return nil
     }
     
@@ -40,30 +40,7 @@ public class BackgroundEstimationStep: PipelineStep {
             throw PipelineStepError.missingRequiredInput("blurred_image or input_image")
         }
         
-        // Get method (optional)
-        let method: BackgroundEstimationMethod
-        if let methodInput = inputs["method"] {
-            if let methodString = methodInput.data.metadata?["method"] as? String,
-               let methodValue = BackgroundEstimationMethod(rawValue: methodString) {
-                method = methodValue
-            } else {
-                method = defaultMethod
-            }
-        } else {
-            method = defaultMethod
-        }
-        
-        // Get window size (optional)
-        let windowSize: Int
-        if let windowSizeInput = inputs["window_size"] {
-            if let windowSizeValue = windowSizeInput.data.scalar.map({ Int($0) }) {
-                windowSize = windowSizeValue
-            } else {
-                windowSize = defaultWindowSize
-            }
-        } else {
-            windowSize = defaultWindowSize
-        }
+        let (method, windowSize) = resolveParameters(inputs: inputs)
         
         // Get input ProcessedImage or create one from texture/FITSImage
         let inputProcessedImage: ProcessedImage
@@ -87,7 +64,7 @@ public class BackgroundEstimationStep: PipelineStep {
             throw PipelineStepError.invalidInputType("input_image", expected: "processedImage, texture, or fitsImage")
         }
         
-        let inputTexture = inputProcessedImage.texture
+        let inputTexture = try inputProcessedImage.metalTexture(device: device)
         
         // Use GPU-based local median estimation
         let backgroundTexture = try estimateLocalBackground(
@@ -115,22 +92,10 @@ public class BackgroundEstimationStep: PipelineStep {
         
         // Create output ProcessedImages with processing history
         // Use different parameters to distinguish the two outputs
-        let backgroundParameters: [String: String] = [
-            "method": method.rawValue,
-            "window_size": "\(windowSize)",
-            "output": "background_image"
-        ]
-        
-        let backgroundSubtractedParameters: [String: String] = [
-            "method": method.rawValue,
-            "window_size": "\(windowSize)",
-            "output": "background_subtracted_image"
-        ]
-        
         let backgroundProcessedImage = inputProcessedImage.withProcessingStep(
             stepID: id,
             stepName: "\(name) (Background)",
-            parameters: backgroundParameters,
+            parameters: outputParameters(method: method, windowSize: windowSize, output: "background_image"),
             newTexture: backgroundTexture,
             newImageType: inputProcessedImage.imageType, // Background preserves image type
             newName: "Background Image"
@@ -139,19 +104,120 @@ public class BackgroundEstimationStep: PipelineStep {
         let backgroundSubtractedProcessedImage = inputProcessedImage.withProcessingStep(
             stepID: id,
             stepName: "\(name) (Subtracted)",
-            parameters: backgroundSubtractedParameters,
+            parameters: outputParameters(method: method, windowSize: windowSize, output: "background_subtracted_image"),
             newTexture: backgroundSubtractedTexture,
             newImageType: inputProcessedImage.imageType, // Background subtraction preserves image type
             newName: "Background Subtracted Image"
         )
         
-        // Create ProcessedScalar with processing history from input image
-        let backgroundLevelParameters: [String: String] = [
+        return makeOutputs(
+            inputProcessedImage: inputProcessedImage,
+            background: backgroundProcessedImage,
+            backgroundSubtracted: backgroundSubtractedProcessedImage,
+            backgroundLevel: backgroundLevel,
+            method: method,
+            windowSize: windowSize
+        )
+    }
+    
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["blurred_image"] ?? inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput("blurred_image or input_image")
+        }
+        let (method, windowSize) = resolveParameters(inputs: inputs)
+        let (inputProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+        
+        // Local median for the median method; mean and percentile are global levels, as on the GPU
+        let background: ImageBuffer
+        switch method {
+        case .median:
+            background = context.localMedian(pixels, windowSize: windowSize)
+        case .mean:
+            let level = context.meanAndStandardDeviation(pixels).mean
+            background = context.uniformImage(width: pixels.width, height: pixels.height, value: level)
+        case .percentile:
+            let sorted = pixels.toArray().sorted()
+            guard !sorted.isEmpty else {
+                throw PipelineStepError.executionFailed("Cannot estimate a percentile background of an empty image")
+            }
+            background = context.uniformImage(width: pixels.width, height: pixels.height, value: sorted[sorted.count / 4])
+        }
+        let backgroundSubtracted = context.subtract(background, from: pixels)
+        
+        // Mean of the top-left tenth of the background, the region the GPU path samples
+        let sample = ImageBuffer(
+            store: background.store,
+            offset: background.offset,
+            width: background.width / 10,
+            height: background.height / 10,
+            channels: 1,
+            rowStride: background.rowStride
+        )
+        let backgroundLevel = context.meanAndStandardDeviation(sample).mean
+        
+        let backgroundProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: "\(name) (Background)",
+            parameters: outputParameters(method: method, windowSize: windowSize, output: "background_image"),
+            newBuffer: background,
+            newImageType: inputProcessedImage.imageType,
+            newName: "Background Image"
+        )
+        
+        let backgroundSubtractedProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: "\(name) (Subtracted)",
+            parameters: outputParameters(method: method, windowSize: windowSize, output: "background_subtracted_image"),
+            newBuffer: backgroundSubtracted,
+            newImageType: inputProcessedImage.imageType,
+            newName: "Background Subtracted Image"
+        )
+        
+        return makeOutputs(
+            inputProcessedImage: inputProcessedImage,
+            background: backgroundProcessedImage,
+            backgroundSubtracted: backgroundSubtractedProcessedImage,
+            backgroundLevel: backgroundLevel,
+            method: method,
+            windowSize: windowSize
+        )
+    }
+    
+    // MARK: - Private Helper Methods
+    
+    /// Returns the method and window_size inputs, or their defaults
+    private func resolveParameters(inputs: [String: PipelineStepInput]) -> (BackgroundEstimationMethod, Int) {
+        var method = defaultMethod
+        if let methodString = inputs["method"]?.data.metadata?["method"] as? String,
+           let methodValue = BackgroundEstimationMethod(rawValue: methodString) {
+            method = methodValue
+        }
+        let windowSize = inputs["window_size"]?.data.scalar.map { Int($0) } ?? defaultWindowSize
+        return (method, windowSize)
+    }
+    
+    /// Parameters recorded in the history of one output
+    private func outputParameters(method: BackgroundEstimationMethod, windowSize: Int, output: String) -> [String: String] {
+        return [
             "method": method.rawValue,
             "window_size": "\(windowSize)",
-            "output": "background_level"
+            "output": output
         ]
-        
+    }
+    
+    /// Builds the step outputs from the two images and the background level
+    private func makeOutputs(
+        inputProcessedImage: ProcessedImage,
+        background: ProcessedImage,
+        backgroundSubtracted: ProcessedImage,
+        backgroundLevel: Float,
+        method: BackgroundEstimationMethod,
+        windowSize: Int
+    ) -> [String: PipelineStepOutput] {
+        // Create ProcessedScalar with processing history from input image
         let baseProcessedScalar = ProcessedScalar(
             value: backgroundLevel,
             processingHistory: inputProcessedImage.processingHistory,
@@ -161,7 +227,7 @@ public class BackgroundEstimationStep: PipelineStep {
         let backgroundLevelProcessedScalar = baseProcessedScalar.withProcessingStep(
             stepID: id,
             stepName: name,
-            parameters: backgroundLevelParameters,
+            parameters: outputParameters(method: method, windowSize: windowSize, output: "background_level"),
             newValue: backgroundLevel,
             newName: "Background Level",
             newUnit: "ADU"
@@ -170,12 +236,12 @@ public class BackgroundEstimationStep: PipelineStep {
         return [
             "background_image": PipelineStepOutput(
                 name: "background_image",
-                data: .processedImage(backgroundProcessedImage),
+                data: .processedImage(background),
                 description: "The estimated background image"
             ),
             "background_subtracted_image": PipelineStepOutput(
                 name: "background_subtracted_image",
-                data: .processedImage(backgroundSubtractedProcessedImage),
+                data: .processedImage(backgroundSubtracted),
                 description: "The image with background subtracted"
             ),
             "background_level": PipelineStepOutput(
@@ -186,8 +252,6 @@ public class BackgroundEstimationStep: PipelineStep {
         ]
     }
     
-    // MARK: - Private Helper Methods
-    
     /// Estimate local background using GPU-based local median
     private func estimateLocalBackground(
         texture: MTLTexture,
@@ -73,10 +73,17 @@ public class ConnectedComponentsStep: PipelineStep {
             )
         }
 
+        // Pixels already in main memory are scanned in place instead of uploading them
+        if let pixels = inputImageInput.data.processedImage?.buffer, pixels.channels == 1 {
+            return try execute(inputs: inputs, context: CPUComputeContext(bufferPool: bufferPool(in: inputs)))
+        }
+
         // Get input texture
         let inputTexture: MTLTexture
         if let texture = inputImageInput.data.texture {
             inputTexture = texture
+        } else if let processedImage = inputImageInput.data.processedImage {
+            inputTexture = try processedImage.metalTexture(device: device)
         } else if let fitsImage = inputImageInput.data.fitsImage {
             inputTexture = try fitsImage.createMetalTexture(device: device, pixelFormat: .r32Float)
         } else {
@@ -99,10 +106,56 @@ public class ConnectedComponentsStep: PipelineStep {
         let findTime = CFAbsoluteTimeGetCurrent() - findStartTime
         Logger.pipeline.debug("[ConnectedComponents] Component finding: \(String(format: "%.3f", findTime))s (\(components.count) components)")
 
-        // Calculate properties for each component
+        // Outputs inherit the processing history of the input ProcessedImage, if any
+        return makeOutputs(components: components, inputProcessedImage: inputImageInput.data.processedImage)
+    }
+
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["dilated_image"] ??
+            inputs["eroded_image"] ??
+            inputs["thresholded_image"] ??
+            inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput(
+                "dilated_image, eroded_image, thresholded_image, or input_image"
+            )
+        }
+        let (inputProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+
+        // Row bands collect their set pixels concurrently; the bands are merged in row order
+        let collectStartTime = CFAbsoluteTimeGetCurrent()
+        let allCoordinates = context.setPixelCoordinates(pixels)
+        let collectTime = CFAbsoluteTimeGetCurrent() - collectStartTime
+        Logger.pipeline.debug("[ConnectedComponents] Coordinate collection: \(String(format: "%.3f", collectTime))s (\(allCoordinates.count) pixels)")
+
+        let findStartTime = CFAbsoluteTimeGetCurrent()
+        let components = findConnectedComponentsFromCoordinates(allCoordinates)
+        let findTime = CFAbsoluteTimeGetCurrent() - findStartTime
+        Logger.pipeline.debug("[ConnectedComponents] Component finding: \(String(format: "%.3f", findTime))s (\(components.count) components)")
+
+        return makeOutputs(components: components, inputProcessedImage: inputProcessedImage)
+    }
+
+    // MARK: - Private Helper Methods
+
+    /// Calculates the component properties and builds the table and count outputs
+    /// - Parameters:
+    ///   - components: The connected components
+    ///   - inputProcessedImage: The input image whose processing history the outputs inherit
+    /// - Returns: The step outputs
+    private func makeOutputs(
+        components: [[PixelCoordinate]],
+        inputProcessedImage: ProcessedImage?
+    ) -> [String: PipelineStepOutput] {
+        // Calculate properties for each component (components are independent, so concurrently)
         let calcStartTime = CFAbsoluteTimeGetCurrent()
-        let componentProperties = components.map { component in
-            calculateComponentProperties(component)
+        let componentProperties = [ComponentProperties](unsafeUninitializedCapacity: components.count) { buffer, initialized in
+            DispatchQueue.concurrentPerform(iterations: components.count) { index in
+                (buffer.baseAddress! + index).initialize(to: calculateComponentProperties(components[index]))
+            }
+            initialized = components.count
         }
         let calcTime = CFAbsoluteTimeGetCurrent() - calcStartTime
         Logger.pipeline.debug("[ConnectedComponents] Property calculation: \(String(format: "%.3f", calcTime))s")
@@ -123,14 +176,6 @@ public class ConnectedComponentsStep: PipelineStep {
             "total_pixels": components.reduce(0) { $0 + $1.count }
         ]
         
-        // Get input ProcessedImage to inherit its processing history
-        let inputProcessedImage: ProcessedImage?
-        if let processedImage = inputImageInput.data.processedImage {
-            inputProcessedImage = processedImage
-        } else {
-            inputProcessedImage = nil
-        }
-        
         // Create ProcessedTable with processing history
         // Start with empty history, then add this step
         let baseProcessedTable = ProcessedTable(
@@ -183,8 +228,6 @@ public class ConnectedComponentsStep: PipelineStep {
         ]
     }
 
-    // MARK: - Private Helper Methods
-
     /// Collects all non-zero pixel coordinates from GPU
     private func collectNonZeroCoordinates(
         texture: MTLTexture,
@@ -29,21 +29,7 @@ public class ErosionStep: PipelineStep {
             throw PipelineStepError.missingRequiredInput("thresholded_image or input_image")
         }
         
-        // Get kernel size (optional)
-        let kernelSize: Int
-        if let kernelSizeInput = inputs["kernel_size"] {
-            guard let kernelSizeValue = kernelSizeInput.data.scalar else {
-                throw PipelineStepError.invalidInputType("kernel_size", expected: "scalar")
-            }
-            kernelSize = Int(kernelSizeValue)
-        } else {
-            kernelSize = defaultKernelSize
-        }
-        
-        // Validate kernel size
-        guard kernelSize > 0 && kernelSize % 2 == 1 else {
-            throw PipelineStepError.invalidInputType("kernel_size", expected: "positive odd integer")
-        }
+        let kernelSize = try resolveKernelSize(inputs: inputs)
         
         // Get input ProcessedImage or create one from texture/FITSImage
         let inputProcessedImage: ProcessedImage
@@ -69,7 +55,7 @@ public class ErosionStep: PipelineStep {
         
         // Apply erosion
         let erodedTexture = try applyErosion(
-            texture: inputProcessedImage.texture,
+            texture: inputProcessedImage.metalTexture(device: device),
             kernelSize: kernelSize,
             device: device,
             commandQueue: commandQueue
@@ -94,8 +80,55 @@ public class ErosionStep: PipelineStep {
         ]
     }
     
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["thresholded_image"] ?? inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput("thresholded_image or input_image")
+        }
+        let kernelSize = try resolveKernelSize(inputs: inputs)
+        let (inputProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+        
+        let outputProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: name,
+            parameters: ["kernel_size": "\(kernelSize)"],
+            newBuffer: context.binaryMorphology(pixels, kernelSize: kernelSize, erode: true),
+            newImageType: .binary,
+            newName: "Eroded Image"
+        )
+        
+        return [
+            "eroded_image": PipelineStepOutput(
+                name: "eroded_image",
+                data: .processedImage(outputProcessedImage),
+                description: "The eroded binary mask"
+            )
+        ]
+    }
+    
     // MARK: - Private Helper Methods
     
+    /// Returns the kernel_size input, or the default kernel size if there is none
+    private func resolveKernelSize(inputs: [String: PipelineStepInput]) throws -> Int {
+        let kernelSize: Int
+        if let kernelSizeInput = inputs["kernel_size"] {
+            guard let kernelSizeValue = kernelSizeInput.data.scalar else {
+                throw PipelineStepError.invalidInputType("kernel_size", expected: "scalar")
+            }
+            kernelSize = Int(kernelSizeValue)
+        } else {
+            kernelSize = defaultKernelSize
+        }
+        
+        // Validate kernel size
+        guard kernelSize > 0 && kernelSize % 2 == 1 else {
+            throw PipelineStepError.invalidInputType("kernel_size", expected: "positive odd integer")
+        }
+        return kernelSize
+    }
+    
     private func applyErosion(
         texture: MTLTexture,
         kernelSize: Int,
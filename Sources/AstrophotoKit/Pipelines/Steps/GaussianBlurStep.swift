@@ -29,16 +29,7 @@ public class GaussianBlurStep: PipelineStep {
             throw PipelineStepError.missingRequiredInput("input_image")
         }
         
-        // Get radius (optional)
-        let radius: Float
-        if let radiusInput = inputs["radius"] {
-            guard let radiusValue = radiusInput.data.scalar else {
-                throw PipelineStepError.invalidInputType("radius", expected: "scalar")
-            }
-            radius = radiusValue
-        } else {
-            radius = defaultRadius
-        }
+        let radius = try blurRadius(inputs: inputs)
         
         // Get input ProcessedImage or create one from texture/FITSImage
         let inputProcessedImage: ProcessedImage
@@ -64,7 +55,7 @@ public class GaussianBlurStep: PipelineStep {
         
         // Apply blur
         let blur = try GaussianBlur(device: device)
-        let blurredTexture = try blur.applyBlur(to: inputProcessedImage.texture, radius: radius)
+        let blurredTexture = try blur.applyBlur(to: inputProcessedImage.metalTexture(device: device), radius: radius)
         
         // Create output ProcessedImage with processing history
         let outputProcessedImage = inputProcessedImage.withProcessingStep(
@@ -84,5 +75,44 @@ public class GaussianBlurStep: PipelineStep {
             )
         ]
     }
+    
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput("input_image")
+        }
+        let radius = try blurRadius(inputs: inputs)
+        let (inputProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+        
+        let outputProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: name,
+            parameters: ["radius": "\(radius)"],
+            newBuffer: context.gaussianBlur(pixels, radius: radius),
+            newImageType: inputProcessedImage.imageType,
+            newName: "Blurred Image"
+        )
+        
+        return [
+            "blurred_image": PipelineStepOutput(
+                name: "blurred_image",
+                data: .processedImage(outputProcessedImage),
+                description: "The blurred output image"
+            )
+        ]
+    }
+    
+    /// Returns the radius input, or the default radius if there is none
+    private func blurRadius(inputs: [String: PipelineStepInput]) throws -> Float {
+        guard let radiusInput = inputs["radius"] else {
+            return defaultRadius
+        }
+        guard let radiusValue = radiusInput.data.scalar else {
+            throw PipelineStepError.invalidInputType("radius", expected: "scalar")
+        }
+        return radiusValue
+    }
 }
 
@@ -163,6 +163,20 @@ public class QuadsStep: PipelineStep {
         device: MTLDevice,
         commandQueue: MTLCommandQueue
     ) throws -> [String: PipelineStepOutput] {
+        return try buildQuads(inputs: inputs)
+    }
+
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        // Quad building only works on the component table, so both backends share it
+        return try buildQuads(inputs: inputs)
+    }
+
+    // MARK: - Private Helper Methods
+
+    private func buildQuads(inputs: [String: PipelineStepInput]) throws -> [String: PipelineStepOutput] {
         let (componentTable, inputProcessedTable) = try getComponentTable(inputs: inputs)
         let components = try extractComponents(from: componentTable)
         let maxStars = Int(inputs["max_stars"]?.data.scalar ?? 50.0)
@@ -206,8 +220,6 @@ public class QuadsStep: PipelineStep {
         ]
     }
 
-    // MARK: - Private Helper Methods
-
     private func getComponentTable(
         inputs: [String: PipelineStepInput]
     ) throws -> ([String: Any], ProcessedTable?) {
@@ -27,21 +27,6 @@ public class StarDetectionOverlayStep: PipelineStep {
             throw PipelineStepError.missingRequiredInput("input_image")
         }
 
-        // Get component properties table
-        guard let componentTableInput = inputs["pixel_coordinates"] else {
-            throw PipelineStepError.missingRequiredInput("pixel_coordinates")
-        }
-
-        // Get component table (can be ProcessedTable or legacy table)
-        let componentTable: [String: Any]
-        if let processedTable = componentTableInput.data.processedTable {
-            componentTable = processedTable.data
-        } else if let table = componentTableInput.data.table {
-            componentTable = table
-        } else {
-            throw PipelineStepError.invalidInputType("pixel_coordinates", expected: "processedTable or table")
-        }
-
         // Get the original input image's ProcessedImage (for history tracking)
         let baseProcessedImage: ProcessedImage
         if let processedImage = inputImageInput.data.processedImage {
@@ -67,7 +52,7 @@ public class StarDetectionOverlayStep: PipelineStep {
         // Use the original input_image's texture for drawing
         let inputTexture: MTLTexture
         if let processedImage = inputImageInput.data.processedImage {
-            inputTexture = processedImage.texture
+            inputTexture = try processedImage.metalTexture(device: device)
         } else if let texture = inputImageInput.data.texture {
             inputTexture = texture
         } else if let fitsImage = inputImageInput.data.fitsImage {
@@ -76,73 +61,106 @@ public class StarDetectionOverlayStep: PipelineStep {
             throw PipelineStepError.invalidInputType("input_image", expected: "processedImage, texture, or fitsImage")
         }
         
-        // Build complete history from pipeline steps (focus on steps, not images)
-        // Extract processing history from previous steps in the pipeline structure
-        var combinedHistory: [ProcessingStep] = []
+        let inputProcessedImage = withPipelineHistory(baseProcessedImage, inputs: inputs)
+        let overlay = try overlayParameters(inputs: inputs)
+
+        // Create star detection overlay filter and apply
+        let overlayFilter = try StarDetectionOverlay(device: device)
+        let annotatedTexture = try overlayFilter.apply(
+            to: inputTexture,
+            ellipses: overlay.ellipses,
+            ellipseColor: overlay.ellipseColor,
+            ellipseWidth: overlay.ellipseWidth,
+            quads: overlay.quads,
+            quadColor: overlay.quadColor,
+            quadWidth: overlay.quadWidth
+        )
         
-        if let contextInput = inputs["_pipeline_context"],
-           let contextMetadata = contextInput.data.metadata,
-           let previousStepOutputs = contextMetadata["previous_steps"] as? [[String: Any]] {
-            // Iterate through each pipeline step in order
-            for stepInfo in previousStepOutputs {
-                // Get the most complete history from this step's outputs
-                // (prefer ProcessedImage, then ProcessedTable, take the one with most history)
-                var bestHistory: [ProcessingStep] = []
-                
-                if let outputs = stepInfo["outputs"] as? [String: [String: Any]] {
-                    for (_, outputData) in outputs {
-                        if let historyData = outputData["processing_history"] as? [[String: Any]] {
-                            var stepHistory: [ProcessingStep] = []
-                            for stepData in historyData {
-                                if let stepID = stepData["step_id"] as? String,
-                                   let stepName = stepData["step_name"] as? String,
-                                   let parameters = stepData["parameters"] as? [String: String],
-                                   let order = stepData["order"] as? Int {
-                                    stepHistory.append(ProcessingStep(
-                                        stepID: stepID,
-                                        stepName: stepName,
-                                        parameters: parameters,
-                                        order: order
-                                    ))
-                                }
-                            }
-                            // Use the history with the most steps (most complete)
-                            if stepHistory.count > bestHistory.count {
-                                bestHistory = stepHistory
-                            }
-                        }
-                    }
-                }
-                
-                // Add all steps from this pipeline step's history
-                // Only add steps we don't already have (by stepID and order)
-                for step in bestHistory {
-                    if !combinedHistory.contains(where: { $0.stepID == step.stepID && $0.order == step.order }) {
-                        combinedHistory.append(step)
-                    }
-                }
-            }
-            
-            // Sort by order to ensure correct sequence
-            combinedHistory.sort { $0.order < $1.order }
+        let outputProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: name,
+            parameters: overlay.historyParameters,
+            newTexture: annotatedTexture,
+            newImageType: .rgba, // Ellipse overlay produces RGBA (color) images
+            newName: "Annotated Image"
+        )
+        
+        return [
+            "annotated_image": PipelineStepOutput(
+                name: "annotated_image",
+                data: .processedImage(outputProcessedImage),
+                description: "Original image with ellipses drawn around detected stars"
+            )
+        ]
+    }
+
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput("input_image")
         }
+        let (baseProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+        let inputProcessedImage = withPipelineHistory(baseProcessedImage, inputs: inputs)
+        let overlay = try overlayParameters(inputs: inputs)
+
+        // Shapes are rasterized per row band, each only over its bounding box
+        let annotated = context.drawStarDetectionOverlay(
+            on: pixels,
+            ellipses: overlay.ellipses,
+            ellipseColor: overlay.ellipseColor,
+            quads: overlay.quads,
+            quadColor: overlay.quadColor,
+            quadWidth: overlay.quadWidth
+        )
+        
+        let outputProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: name,
+            parameters: overlay.historyParameters,
+            newBuffer: annotated,
+            newImageType: annotated.channels == 4 ? .rgba : inputProcessedImage.imageType,
+            newName: "Annotated Image"
+        )
         
-        // Create ProcessedImage with history from pipeline steps
-        let inputProcessedImage: ProcessedImage
-        if !combinedHistory.isEmpty {
-            // Create a new ProcessedImage with the combined history from pipeline steps
-            inputProcessedImage = ProcessedImage(
-                texture: baseProcessedImage.texture,
-                imageType: baseProcessedImage.imageType,
-                originalMinValue: baseProcessedImage.originalMinValue,
-                originalMaxValue: baseProcessedImage.originalMaxValue,
-                processingHistory: combinedHistory,
-                fitsImage: baseProcessedImage.fitsImage,
-                name: baseProcessedImage.name
+        return [
+            "annotated_image": PipelineStepOutput(
+                name: "annotated_image",
+                data: .processedImage(outputProcessedImage),
+                description: "Original image with ellipses drawn around detected stars"
             )
+        ]
+    }
+
+    // MARK: - Private Helper Methods
+
+    /// Shapes, colors and widths to draw, shared by both backends
+    private struct OverlayParameters {
+        let ellipses: [StarEllipse]
+        let ellipseColor: SIMD3<Float>
+        let ellipseWidth: Float
+        let quads: [QuadLine]
+        let quadColor: SIMD3<Float>
+        let quadWidth: Float
+        let historyParameters: [String: String]
+    }
+
+    /// Reads the ellipses from the component table and the quads and drawing options from the inputs
+    private func overlayParameters(inputs: [String: PipelineStepInput]) throws -> OverlayParameters {
+        // Get component properties table
+        guard let componentTableInput = inputs["pixel_coordinates"] else {
+            throw PipelineStepError.missingRequiredInput("pixel_coordinates")
+        }
+
+        // Get component table (can be ProcessedTable or legacy table)
+        let componentTable: [String: Any]
+        if let processedTable = componentTableInput.data.processedTable {
+            componentTable = processedTable.data
+        } else if let table = componentTableInput.data.table {
+            componentTable = table
         } else {
-            // Fall back to base image if no pipeline history available
-            inputProcessedImage = baseProcessedImage
+            throw PipelineStepError.invalidInputType("pixel_coordinates", expected: "processedTable or table")
         }
 
         // Extract ellipse parameters from component table
@@ -225,19 +243,7 @@ public class StarDetectionOverlayStep: PipelineStep {
         let quadColor = SIMD3<Float>(quadColorR, quadColorG, quadColorB)
         let quadWidth = inputs["quad_width"]?.data.scalar ?? 1.0
 
-        // Create star detection overlay filter and apply
-        let overlay = try StarDetectionOverlay(device: device)
-        let annotatedTexture = try overlay.apply(
-            to: inputTexture,
-            ellipses: ellipses,
-            ellipseColor: ellipseColor,
-            ellipseWidth: ellipseWidth,
-            quads: quads,
-            quadColor: quadColor,
-            quadWidth: quadWidth
-        )
-        
-        // Create output ProcessedImage with processing history
+        // Parameters recorded in the processing history
         let parameters: [String: String] = [
             "ellipse_count": "\(ellipses.count)",
             "ellipse_color_r": "\(ellipseColorR)",
@@ -251,22 +257,74 @@ public class StarDetectionOverlayStep: PipelineStep {
             "quad_width": "\(quadWidth)"
         ]
         
-        let outputProcessedImage = inputProcessedImage.withProcessingStep(
-            stepID: id,
-            stepName: name,
-            parameters: parameters,
-            newTexture: annotatedTexture,
-            newImageType: .rgba, // Ellipse overlay produces RGBA (color) images
-            newName: "Annotated Image"
+        return OverlayParameters(
+            ellipses: ellipses,
+            ellipseColor: ellipseColor,
+            ellipseWidth: ellipseWidth,
+            quads: quads,
+            quadColor: quadColor,
+            quadWidth: quadWidth,
+            historyParameters: parameters
         )
+    }
+
+    /// Replaces the history of the input image with the combined history of the previous pipeline steps
+    private func withPipelineHistory(
+        _ baseProcessedImage: ProcessedImage,
+        inputs: [String: PipelineStepInput]
+    ) -> ProcessedImage {
+        // Build complete history from pipeline steps (focus on steps, not images)
+        // Extract processing history from previous steps in the pipeline structure
+        var combinedHistory: [ProcessingStep] = []
         
-        return [
-            "annotated_image": PipelineStepOutput(
-                name: "annotated_image",
-                data: .processedImage(outputProcessedImage),
-                description: "Original image with ellipses drawn around detected stars"
-            )
-        ]
+        if let contextInput = inputs["_pipeline_context"],
+           let contextMetadata = contextInput.data.metadata,
+           let previousStepOutputs = contextMetadata["previous_steps"] as? [[String: Any]] {
+            // Iterate through each pipeline step in order
+            for stepInfo in previousStepOutputs {
+                // Get the most complete history from this step's outputs
+                // (prefer ProcessedImage, then ProcessedTable, take the one with most history)
+                var bestHistory: [ProcessingStep] = []
+                
+                if let outputs = stepInfo["outputs"] as? [String: [String: Any]] {
+                    for (_, outputData) in outputs {
+                        if let historyData = outputData["processing_history"] as? [[String: Any]] {
+                            var stepHistory: [ProcessingStep] = []
+                            for stepData in historyData {
+                                if let stepID = stepData["step_id"] as? String,
+                                   let stepName = stepData["step_name"] as? String,
+                                   let parameters = stepData["parameters"] as? [String: String],
+                                   let order = stepData["order"] as? Int {
+                                    stepHistory.append(ProcessingStep(
+                                        stepID: stepID,
+                                        stepName: stepName,
+                                        parameters: parameters,
+                                        order: order
+                                    ))
+                                }
+                            }
+                            // Use the history with the most steps (most complete)
+                            if stepHistory.count > bestHistory.count {
+                                bestHistory = stepHistory
+                            }
+                        }
+                    }
+                }
+                
+                // Add all steps from this pipeline step's history
+                // Only add steps we don't already have (by stepID and order)
+                for step in bestHistory {
+                    if !combinedHistory.contains(where: { $0.stepID == step.stepID && $0.order == step.order }) {
+                        combinedHistory.append(step)
+                    }
+                }
+            }
+            
+            // Sort by order to ensure correct sequence
+            combinedHistory.sort { $0.order < $1.order }
+        }
+        
+        // Fall back to base image if no pipeline history available
+        return combinedHistory.isEmpty ? baseProcessedImage : baseProcessedImage.withProcessingHistory(combinedHistory)
     }
 }
-
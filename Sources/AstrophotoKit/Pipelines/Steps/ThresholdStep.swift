@@ -43,29 +43,7 @@ public class ThresholdStep: PipelineStep {
             throw PipelineStepError.missingRequiredInput("background_subtracted_image or input_image")
         }
         
-        // Get threshold value (optional)
-        let threshold: Float
-        if let thresholdInput = inputs["threshold_value"] {
-            guard let thresholdValue = thresholdInput.data.scalar else {
-                throw PipelineStepError.invalidInputType("threshold_value", expected: "scalar")
-            }
-            threshold = thresholdValue
-        } else {
-            threshold = defaultThreshold
-        }
-        
-        // Get method (optional)
-        let method: ThresholdMethod
-        if let methodInput = inputs["method"] {
-            if let methodString = methodInput.data.metadata?["method"] as? String,
-               let methodValue = ThresholdMethod(rawValue: methodString) {
-                method = methodValue
-            } else {
-                method = defaultMethod
-            }
-        } else {
-            method = defaultMethod
-        }
+        let (threshold, method) = try resolveParameters(inputs: inputs)
         
         // Get input ProcessedImage or create one from texture/FITSImage
         let inputProcessedImage: ProcessedImage
@@ -89,7 +67,7 @@ public class ThresholdStep: PipelineStep {
             throw PipelineStepError.invalidInputType("input_image", expected: "processedImage, texture, or fitsImage")
         }
         
-        let inputTexture = inputProcessedImage.texture
+        let inputTexture = try inputProcessedImage.metalTexture(device: device)
         
         // Calculate actual threshold based on method
         let actualThreshold: Float
@@ -140,20 +118,67 @@ public class ThresholdStep: PipelineStep {
         )
         
         // Create output ProcessedImage with processing history
-        var parameters: [String: String] = [
-            "method": method.rawValue,
-            "threshold": "\(actualThreshold)"
+        let outputProcessedImage = inputProcessedImage.withProcessingStep(
+            stepID: id,
+            stepName: name,
+            parameters: outputParameters(method: method, threshold: threshold, actualThreshold: actualThreshold),
+            newTexture: thresholdedTexture,
+            newImageType: .binary, // Threshold produces binary images
+            newName: "Thresholded Image"
+        )
+        
+        return [
+            "thresholded_image": PipelineStepOutput(
+                name: "thresholded_image",
+                data: .processedImage(outputProcessedImage),
+                description: "The thresholded image (0 or 1 per pixel)"
+            )
         ]
-        if method != .fixed {
-            parameters["threshold_parameter"] = "\(threshold)"
+    }
+    
+    public func execute(
+        inputs: [String: PipelineStepInput],
+        context: CPUComputeContext
+    ) throws -> [String: PipelineStepOutput] {
+        guard let inputImageInput = inputs["background_subtracted_image"] ?? inputs["input_image"] else {
+            throw PipelineStepError.missingRequiredInput("background_subtracted_image or input_image")
+        }
+        let (threshold, method) = try resolveParameters(inputs: inputs)
+        let (inputProcessedImage, pixels) = try cpuInputImage(inputImageInput)
+        
+        // Same statistics as the GPU path, computed with banded reductions
+        let actualThreshold: Float
+        switch method {
+        case .fixed, .adaptive:
+            actualThreshold = threshold
+        case .otsu:
+            let histogram = context.histogram(pixels, bins: 256, scale: 255)
+            actualThreshold = otsuThreshold(histogram: histogram, totalPixels: pixels.width * pixels.height)
+        case .sigma:
+            let (mean, standardDeviation) = context.meanAndStandardDeviation(pixels)
+            actualThreshold = mean + threshold * standardDeviation
+        case .mad:
+            let numBins = 1024
+            let targetCount = pixels.width * pixels.height / 2
+            let median = (Float(medianBin(of: context.histogram(pixels, bins: numBins), targetCount: targetCount)) + 0.5) / Float(numBins)
+            let madHistogram = context.histogram(pixels, bins: numBins, deviationFrom: median)
+            let mad = (Float(medianBin(of: madHistogram, targetCount: targetCount)) + 0.5) / Float(numBins)
+            actualThreshold = median + threshold * mad
+        case .percentile:
+            let sortedPixels = pixels.toArray().sorted()
+            guard !sortedPixels.isEmpty else {
+                throw PipelineStepError.executionFailed("Cannot compute a percentile threshold of an empty image")
+            }
+            let percentileIndex = Int(Float(sortedPixels.count - 1) * threshold)
+            actualThreshold = sortedPixels[min(max(0, percentileIndex), sortedPixels.count - 1)]
         }
         
         let outputProcessedImage = inputProcessedImage.withProcessingStep(
             stepID: id,
             stepName: name,
-            parameters: parameters,
-            newTexture: thresholdedTexture,
-            newImageType: .binary, // Threshold produces binary images
+            parameters: outputParameters(method: method, threshold: threshold, actualThreshold: actualThreshold),
+            newBuffer: context.threshold(pixels, at: actualThreshold),
+            newImageType: .binary,
             newName: "Thresholded Image"
         )
         
@@ -168,6 +193,48 @@ public class ThresholdStep: PipelineStep {
     
     // MARK: - Private Helper Methods
     
+    /// Returns the threshold_value and method inputs, or their defaults
+    private func resolveParameters(inputs: [String: PipelineStepInput]) throws -> (Float, ThresholdMethod) {
+        var threshold = defaultThreshold
+        if let thresholdInput = inputs["threshold_value"] {
+            guard let thresholdValue = thresholdInput.data.scalar else {
+                throw PipelineStepError.invalidInputType("threshold_value", expected: "scalar")
+            }
+            threshold = thresholdValue
+        }
+        
+        var method = defaultMethod
+        if let methodString = inputs["method"]?.data.metadata?["method"] as? String,
+           let methodValue = ThresholdMethod(rawValue: methodString) {
+            method = methodValue
+        }
+        return (threshold, method)
+    }
+    
+    /// Parameters recorded in the processing history
+    private func outputParameters(method: ThresholdMethod, threshold: Float, actualThreshold: Float) -> [String: String] {
+        var parameters: [String: String] = [
+            "method": method.rawValue,
+            "threshold": "\(actualThreshold)"
+        ]
+        if method != .fixed {
+            parameters["threshold_parameter"] = "\(threshold)"
+        }
+        return parameters
+    }
+    
+    /// Index of the first bin at which the cumulative count reaches `targetCount`
+    private func medianBin(of histogram: [Int], targetCount: Int) -> Int {
+        var cumulativeCount = 0
+        for (bin, count) in histogram.enumerated() {
+            cumulativeCount += count
+            if cumulativeCount >= targetCount {
+                return bin
+            }
+        }
+        return 0
+    }
+    
     private func calculateOtsuThreshold(
         texture: MTLTexture,
         device: MTLDevice,
@@ -219,7 +286,11 @@ public class ThresholdStep: PipelineStep {
             histogram[bin] += 1
         }
         
-        let totalPixels = width * height
+        return otsuThreshold(histogram: histogram, totalPixels: width * height)
+    }
+    
+    /// Otsu's threshold of a 256-bin histogram, as a value in 0-1
+    private func otsuThreshold(histogram: [Int], totalPixels: Int) -> Float {
         var sum: Int = 0
         for i in 0..<256 {
             sum += i * histogram[i]
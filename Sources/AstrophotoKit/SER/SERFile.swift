@@ -0,0 +1,408 @@
+import Foundation
+import os
+
+// Direct C function bindings for functions that Swift Package Manager can't see
+// Using Swift naming conventions while mapping to C function names
+@_silgen_name("apk_convert_be_u16_to_f32")
+func convertBigEndianUInt16ToFloat32(_ src: UnsafeRawPointer?, _ dst: UnsafeMutablePointer<Float32>?, _ count: Int, _ scale: Double, _ zero: Double)
+
+/// Pixel layout of the frames in a SER file
+public enum SERColorID: Int32 {
+    case mono = 0
+    case bayerRGGB = 8
+    case bayerGRBG = 9
+    case bayerGBRG = 10
+    case bayerBGGR = 11
+    case bayerCYYM = 16
+    case bayerYCMY = 17
+    case bayerYMCY = 18
+    case bayerMYYC = 19
+    case rgb = 100
+    case bgr = 101
+
+    /// Number of samples per pixel (3 for RGB and BGR, 1 for mono and Bayer mosaics)
+    public var planes: Int {
+        self == .rgb || self == .bgr ? 3 : 1
+    }
+
+    /// The Bayer pattern as written to the BAYERPAT keyword, or nil if the frames are not a mosaic
+    public var bayerPattern: String? {
+        switch self {
+        case .bayerRGGB: return "RGGB"
+        case .bayerGRBG: return "GRBG"
+        case .bayerGBRG: return "GBRG"
+        case .bayerBGGR: return "BGGR"
+        case .bayerCYYM: return "CYYM"
+        case .bayerYCMY: return "YCMY"
+        case .bayerYMCY: return "YMCY"
+        case .bayerMYYC: return "MYYC"
+        case .mono, .rgb, .bgr: return nil
+        }
+    }
+}
+
+/// A read-only, memory-mapped SER video file, as written by planetary and lucky-imaging capture tools
+///
+/// The whole file is mapped with `mmap`, so any frame can be accessed by index without
+/// reading the frames before it, and frames are only paged in when they are converted.
+/// Each frame is a zero-copy `SERFrame` view with the same row-access interface as
+/// `FITSMappedImage`, and can be converted to a `FITSImage` for the pipelines.
+public final class SERFile {
+    /// Size of the fixed SER header in bytes
+    static let headerSize = 178
+
+    /// Path of the SER file
+    public let path: String
+
+    /// Frame dimensions in pixels
+    public let width: Int
+    public let height: Int
+
+    /// Number of frames in the file
+    public let frameCount: Int
+
+    /// Pixel layout of the frames
+    public let colorID: SERColorID
+
+    /// Significant bits per sample (1-16)
+    public let bitsPerPixel: Int
+
+    /// True if 16-bit samples are stored little-endian
+    public let isLittleEndian: Bool
+
+    /// Header text fields
+    public let observer: String
+    public let instrument: String
+    public let telescope: String
+
+    /// UTC start time of the capture, if recorded
+    public let startTime: Date?
+
+    /// Number of samples per pixel
+    public var planes: Int {
+        colorID.planes
+    }
+
+    /// Number of bytes per sample (1 for up to 8 bits, otherwise 2)
+    public var bytesPerSample: Int {
+        bitsPerPixel > 8 ? 2 : 1
+    }
+
+    /// Number of bytes of one frame
+    public var frameByteCount: Int {
+        width * height * planes * bytesPerSample
+    }
+
+    private let mapping: UnsafeMutableRawPointer
+    private let mappingLength: Int
+    private let timestamps: UnsafeRawPointer?
+
+    /// Maps a SER file and reads its header
+    /// - Parameters:
+    ///   - path: The file path to the SER file
+    ///   - littleEndian: Byte order of 16-bit samples (nil = from the header)
+    /// - Throws: An error if the file cannot be mapped or is not a valid SER file
+    public init(path: String, littleEndian: Bool? = nil) throws {
+        let descriptor = open(path, O_RDONLY)
+        guard descriptor >= 0 else {
+            let message = String(cString: strerror(errno))
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: message)
+        }
+        defer { close(descriptor) }
+
+        var fileStatus = stat()
+        guard fstat(descriptor, &fileStatus) == 0 else {
+            let message = String(cString: strerror(errno))
+            throw FITSFileError.cannotOpenFile(path: path, status: -1, message: message)
+        }
+        let length = Int(fileStatus.st_size)
+        guard length >= SERFile.headerSize else {
+            throw FITSFileError.readError(status: -1, message: "File is too short for a SER header")
+        }
+
+        guard let mapping = mmap(nil, length, PROT_READ, MAP_PRIVATE, descriptor, 0),
+              mapping != UnsafeMutableRawPointer(bitPattern: -1) else {
+            let message = String(cString: strerror(errno))
+            Logger.swiftfitsio.error("Failed to map SER file at \(path): \(message)")
+            throw FITSFileError.readError(status: -1, message: message)
+        }
+
+        // All header fields are little-endian
+        let header = UnsafeRawBufferPointer(start: mapping, count: SERFile.headerSize)
+        func integer(_ offset: Int) -> Int {
+            Int(Int32(littleEndian: header.loadUnaligned(fromByteOffset: offset, as: Int32.self)))
+        }
+        func text(_ offset: Int, _ length: Int) -> String {
+            let field = header[offset..<(offset + length)].prefix { $0 != 0 }
+            return String(decoding: field, as: UTF8.self).trimmingCharacters(in: .whitespaces)
+        }
+
+        let width = integer(26)
+        let height = integer(30)
+        let bitsPerPixel = integer(34)
+        let frameCount = integer(38)
+        let colorID = SERColorID(rawValue: Int32(integer(18)))
+        // Sizes come from the file, so every product is checked before it is used as an offset
+        func product(_ factors: [Int]) -> Int? {
+            var result = 1
+            for factor in factors {
+                let (next, overflow) = result.multipliedReportingOverflow(by: factor)
+                guard !overflow else {
+                    return nil
+                }
+                result = next
+            }
+            return result
+        }
+        let frameByteCount = product([width, height, colorID?.planes ?? 1, bitsPerPixel > 8 ? 2 : 1])
+        let framesByteCount = frameByteCount.flatMap { product([frameCount, $0]) }
+        let dataEnd = framesByteCount.flatMap { bytes -> Int? in
+            let (end, overflow) = SERFile.headerSize.addingReportingOverflow(bytes)
+            return overflow ? nil : end
+        }
+        guard memcmp(mapping, "LUCAM-RECORDER", 14) == 0, let colorID = colorID,
+              width > 0, height > 0, frameCount >= 0, (1...16).contains(bitsPerPixel),
+              let trailerOffset = dataEnd, trailerOffset <= length else {
+            munmap(mapping, length)
+            throw FITSFileError.readError(status: -1, message: "Invalid or truncated SER header in \(path)")
+        }
+
+        self.path = path
+        self.mapping = mapping
+        self.mappingLength = length
+        self.width = width
+        self.height = height
+        self.frameCount = frameCount
+        self.colorID = colorID
+        self.bitsPerPixel = bitsPerPixel
+        // The specification defines 1 as little-endian, but the common capture tools write 0
+        // for little-endian data; readers such as Siril and PIPP follow the tools
+        self.isLittleEndian = littleEndian ?? (integer(22) == 0)
+        self.observer = text(42, 40)
+        self.instrument = text(82, 40)
+        self.telescope = text(122, 40)
+        self.startTime = SERFile.date(fromTicks: Int64(littleEndian: header.loadUnaligned(fromByteOffset: 170, as: Int64.self)))
+
+        // The optional trailer holds one UTC timestamp per frame
+        self.timestamps = frameCount > 0 && (length - trailerOffset) / 8 >= frameCount
+            ? UnsafeRawPointer(mapping + trailerOffset)
+            : nil
+
+        Logger.swiftfitsio.debug("Mapped SER file \(path): \(frameCount) frames of \(width)x\(height), \(bitsPerPixel) bits")
+    }
+
+    deinit {
+        munmap(mapping, mappingLength)
+    }
+
+    /// Returns a zero-copy view of a frame
+    /// - Parameter index: Frame index (0 to frameCount-1)
+    public func frame(at index: Int) -> SERFrame {
+        precondition(index >= 0 && index < frameCount, "Frame index out of range")
+        return SERFrame(file: self, index: index, data: UnsafeRawPointer(mapping + SERFile.headerSize + index * frameByteCount))
+    }
+
+    /// Returns the UTC capture time of a frame, if the file has a timestamp trailer
+    public func timestamp(ofFrame index: Int) -> Date? {
+        precondition(index >= 0 && index < frameCount, "Frame index out of range")
+        guard let timestamps = timestamps else {
+            return nil
+        }
+        return SERFile.date(fromTicks: Int64(littleEndian: timestamps.loadUnaligned(fromByteOffset: index * 8, as: Int64.self)))
+    }
+
+    /// Converts frames to images in parallel chunks and calls `body` for each chunk
+    ///
+    /// Frames in a chunk are converted concurrently straight from the mapping; the chunks are
+    /// passed to `body` in order, on the calling thread.
+    /// - Parameters:
+    ///   - range: Frames to convert (nil = all frames)
+    ///   - chunkSize: Number of frames converted together (default: twice the number of active cores)
+    ///   - maxConcurrency: Maximum number of frames converted at the same time (default: number of active cores)
+    ///   - body: Closure receiving the index of the first frame and the images of the chunk
+    /// - Throws: Any error thrown by `body`
+    public func forEachFrameChunk(
+        in range: Range<Int>? = nil,
+        chunkSize: Int = 2 * ProcessInfo.processInfo.activeProcessorCount,
+        maxConcurrency: Int = ProcessInfo.processInfo.activeProcessorCount,
+        _ body: (_ firstFrame: Int, _ images: [FITSImage]) throws -> Void
+    ) rethrows {
+        let range = range ?? 0..<frameCount
+        precondition(range.lowerBound >= 0 && range.upperBound <= frameCount, "Frame range out of bounds")
+        let chunkSize = max(1, chunkSize)
+
+        for start in stride(from: range.lowerBound, to: range.upperBound, by: chunkSize) {
+            let frames = start..<min(start + chunkSize, range.upperBound)
+            var images = [FITSImage?](repeating: nil, count: frames.count)
+            let lock = NSLock()
+            let workerCount = max(1, min(maxConcurrency, frames.count))
+
+            DispatchQueue.concurrentPerform(iterations: workerCount) { worker in
+                for offset in stride(from: worker, to: frames.count, by: workerCount) {
+                    let image = frame(at: frames.lowerBound + offset).makeFITSImage()
+                    lock.lock()
+                    images[offset] = image
+                    lock.unlock()
+                }
+            }
+            try body(start, images.map { $0! })
+        }
+    }
+
+    /// Converts a capture time in .NET ticks (100 ns since 0001-01-01) to a date; 0 = not recorded
+    private static func date(fromTicks ticks: Int64) -> Date? {
+        guard ticks > 0 else {
+            return nil
+        }
+        let ticksAt1970: Int64 = 621_355_968_000_000_000
+        return Date(timeIntervalSince1970: Double(ticks - ticksAt1970) / 10_000_000)
+    }
+}
+
+/// A zero-copy view of one frame of a `SERFile`
+///
+/// Samples are converted to Float32 only when they are accessed. Colour frames are stored
+/// with interleaved samples; the row accessors present them as separate R, G and B planes.
+/// The view keeps its file mapped.
+public struct SERFrame {
+    /// The file the frame belongs to
+    public let file: SERFile
+
+    /// Index of the frame in the file
+    public let index: Int
+
+    private let data: UnsafeRawPointer
+
+    init(file: SERFile, index: Int, data: UnsafeRawPointer) {
+        self.file = file
+        self.index = index
+        self.data = data
+    }
+
+    /// Frame dimensions; depth is the number of colour planes
+    public var width: Int { file.width }
+    public var height: Int { file.height }
+    public var depth: Int { file.planes }
+
+    /// The stored samples of the frame, without conversion
+    public var bytes: UnsafeRawBufferPointer {
+        UnsafeRawBufferPointer(start: data, count: file.frameByteCount)
+    }
+
+    /// UTC capture time of the frame, if recorded
+    public var timestamp: Date? {
+        file.timestamp(ofFrame: index)
+    }
+
+    /// Converts one row of a plane to Float32 sample values
+    /// - Parameters:
+    ///   - y: Row index
+    ///   - z: Plane index (0 = R, 1 = G, 2 = B for colour frames)
+    ///   - destination: Buffer receiving `width` values
+    public func copyRow(_ y: Int, plane z: Int = 0, into destination: UnsafeMutablePointer<Float32>) {
+        precondition(y >= 0 && y < height && z >= 0 && z < depth, "Row out of range")
+        let planes = depth
+        guard planes > 1 else {
+            convertSamples(from: y * width, count: width, into: destination)
+            return
+        }
+
+        // BGR frames store blue first
+        let channel = file.colorID == .bgr ? planes - 1 - z : z
+        withUnsafeTemporaryAllocation(of: Float32.self, capacity: width * planes) { row in
+            convertSamples(from: y * width * planes, count: width * planes, into: row.baseAddress!)
+            for x in 0..<width {
+                destination[x] = row[x * planes + channel]
+            }
+        }
+    }
+
+    /// Returns the value of a single sample
+    public subscript(x: Int, y: Int, z: Int = 0) -> Float32 {
+        precondition(x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth, "Pixel coordinates out of range")
+        let channel = file.colorID == .bgr ? depth - 1 - z : z
+        var value: Float32 = 0
+        convertSamples(from: (y * width + x) * depth + channel, count: 1, into: &value)
+        return value
+    }
+
+    /// Converts the frame to an image, like `FITSFile.readFITSImage()`
+    ///
+    /// The header records the frame geometry, the capture metadata and, for mosaics, the
+    /// Bayer pattern (BAYERPAT).
+    /// - Returns: A planar image holding the sample values
+    public func makeFITSImage() -> FITSImage {
+        let planeSize = width * height
+        let store = FITSPixelStore(count: planeSize * depth)
+        if depth == 1 {
+            convertSamples(from: 0, count: planeSize, into: store.pointer)
+        } else {
+            for z in 0..<depth {
+                for y in 0..<height {
+                    copyRow(y, plane: z, into: store.pointer + z * planeSize + y * width)
+                }
+            }
+        }
+
+        var minVal = Float32.greatestFiniteMagnitude
+        var maxVal = -Float32.greatestFiniteMagnitude
+        if accumulateRange(store.pointer, store.count, &minVal, &maxVal) == 0 {
+            minVal = 0
+            maxVal = 0
+        }
+        let bitpix: Int32 = file.bytesPerSample == 2 ? 16 : 8
+        return FITSImage(
+            width: width,
+            height: height,
+            depth: depth,
+            bitpix: bitpix,
+            dataType: bitpix == 16 ? .short : .byte,
+            storage: store,
+            originalMinValue: minVal,
+            originalMaxValue: maxVal,
+            header: makeHeader(bitpix: bitpix)
+        )
+    }
+
+    /// Converts `count` consecutive stored samples starting at sample `start`
+    private func convertSamples(from start: Int, count: Int, into destination: UnsafeMutablePointer<Float32>) {
+        if file.bytesPerSample == 1 {
+            convertUInt8ToFloat32(data.assumingMemoryBound(to: UInt8.self) + start, destination, count, 1, 0)
+        } else if file.isLittleEndian {
+            // Frames start at an even offset, so 16-bit samples are aligned
+            convertUInt16ToFloat32(data.assumingMemoryBound(to: UInt16.self) + start, destination, count, 1, 0)
+        } else {
+            convertBigEndianUInt16ToFloat32(data + 2 * start, destination, count, 1, 0)
+        }
+    }
+
+    /// Builds FITS header cards describing the frame
+    private func makeHeader(bitpix: Int32) -> FITSHeader {
+        var cards = [
+            FITSHeader.formatCard(keyword: "SIMPLE", value: .boolean(true)),
+            FITSHeader.formatCard(keyword: "BITPIX", value: .integer(Int64(bitpix))),
+            FITSHeader.formatCard(keyword: "NAXIS", value: .integer(depth > 1 ? 3 : 2)),
+            FITSHeader.formatCard(keyword: "NAXIS1", value: .integer(Int64(width))),
+            FITSHeader.formatCard(keyword: "NAXIS2", value: .integer(Int64(height)))
+        ]
+        if depth > 1 {
+            cards.append(FITSHeader.formatCard(keyword: "NAXIS3", value: .integer(Int64(depth))))
+        }
+        if let pattern = file.colorID.bayerPattern {
+            cards.append(FITSHeader.formatCard(keyword: "BAYERPAT", value: .string(pattern)))
+        }
+        // Text fields are written by the capture tool and may hold non-ASCII characters;
+        // formatCard replaces them so every card stays 80 bytes
+        for (keyword, value) in [("OBSERVER", file.observer), ("INSTRUME", file.instrument), ("TELESCOP", file.telescope)] where !value.isEmpty {
+            cards.append(FITSHeader.formatCard(keyword: keyword, value: .string(value)))
+        }
+        if let time = timestamp ?? file.startTime {
+            let formatter = ISO8601DateFormatter()
+            formatter.formatOptions = [.withInternetDateTime, .withFractionalSeconds]
+            cards.append(FITSHeader.formatCard(keyword: "DATE-OBS", value: .string(String(formatter.string(from: time).dropLast()))))
+        }
+        cards.append(FITSHeader.formatCard(keyword: "FRAME", value: .integer(Int64(index))))
+
+        return FITSHeader(table: FITSKeywordTable(text: Array(cards.joined().utf8)))
+    }
+}
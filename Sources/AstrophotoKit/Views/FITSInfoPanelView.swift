@@ -81,7 +81,7 @@ public struct FITSInfoPanelView: View {
                 InformationTabView(fitsImage: fitsImage, texture: texture, textureWidth: textureWidth, textureHeight: textureHeight)
                     .tag(FITSInfoPanelTab.information)
                 
-                ImageTabView(fitsImage: fitsImage, texture: texture, textureWidth: textureWidth, textureHeight: textureHeight, textureMinValue: textureMinValue, textureMaxValue: textureMaxValue, imageID: imageID, blackPoint: $blackPoint, whitePoint: $whitePoint, cursorPosition: cursorPosition, aspectRatio: aspectRatio, extractedRegion: extractedRegion, extractedRegionTexture: extractedRegionTexture, extractedRegionSize: $extractedRegionSize, zoom: $zoom, panOffset: $panOffset, onExtractedRegionSizeChanged: onExtractedRegionSizeChanged)
+                ImageTabView(fitsImage: fitsImage, texture: texture, pixelBuffer: processedImage?.buffer, textureWidth: textureWidth, textureHeight: textureHeight, textureMinValue: textureMinValue, textureMaxValue: textureMaxValue, imageID: imageID, blackPoint: $blackPoint, whitePoint: $whitePoint, cursorPosition: cursorPosition, aspectRatio: aspectRatio, extractedRegion: extractedRegion, extractedRegionTexture: extractedRegionTexture, extractedRegionSize: $extractedRegionSize, zoom: $zoom, panOffset: $panOffset, onExtractedRegionSizeChanged: onExtractedRegionSizeChanged)
                     .tag(FITSInfoPanelTab.image)
                 
                 PipelineTabView(processedImage: processedImage, processedTable: processedTable, processedScalar: processedScalar)
@@ -338,7 +338,7 @@ private struct InformationTabView: View {
                             }
                             InfoRow(label: "Total Pixels", value: "\(fitsImage.width * fitsImage.height)")
                             InfoRow(label: "Data Type", value: fitsImage.dataType.description)
-                            if let bitpix = fitsImage.metadata["BITPIX"]?.intValue {
+                            if let bitpix = fitsImage.header["BITPIX"]?.intValue {
                                 InfoRow(label: "BITPIX", value: "\(bitpix)")
                             }
                             InfoRow(label: "Min Value", value: String(format: "%.6f", fitsImage.originalMinValue))
@@ -350,8 +350,8 @@ private struct InformationTabView: View {
                     // FITS metadata
                     GroupBox("FITS Header") {
                         VStack(alignment: .leading, spacing: 8) {
-                            ForEach(Array(fitsImage.metadata.keys.sorted()), id: \.self) { key in
-                                if let value = fitsImage.metadata[key] {
+                            ForEach(fitsImage.header.keywords, id: \.self) { key in
+                                ForEach(Array(fitsImage.header.values(for: key).enumerated()), id: \.offset) { _, value in
                                     InfoRow(label: key, value: formatHeaderValue(value))
                                 }
                             }
@@ -385,6 +385,8 @@ private struct InformationTabView: View {
 private struct ImageTabView: View {
     let fitsImage: FITSImage?
     let texture: MTLTexture?
+    /// Pixels of the processed image in main memory, read directly instead of from the texture
+    let pixelBuffer: ImageBuffer?
     let textureWidth: Int
     let textureHeight: Int
     let textureMinValue: Float
@@ -428,6 +430,11 @@ private struct ImageTabView: View {
             return nil
         }
         
+        // Images with their pixels in main memory need no GPU round trip
+        if let pixels = pixelBuffer, pixels.width == texture.width, pixels.height == texture.height {
+            return textureMinValue + pixels[x: x, y: y] * (textureMaxValue - textureMinValue)
+        }
+        
         // Read pixel value from texture
         // We'll read a small region (1x1 pixel) to get the exact value
         guard let device = MTLCreateSystemDefaultDevice(),
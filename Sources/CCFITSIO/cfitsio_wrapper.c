@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "shim.h"
 
 // Wrapper functions for cfitsio to bridge Swift and C
@@ -23,42 +24,181 @@ int fits_movabs_hdu_wrapper(fitsfile *fptr, int hduNumber, int *hduType, int *st
     return fits_movabs_hdu(fptr, hduNumber, hduType, status);
 }
 
-int fits_get_hdrspace_wrapper(fitsfile *fptr, int *numKeys, int *numMore, int *status) {
-    return fits_get_hdrspace(fptr, numKeys, numMore, status);
+int fits_get_img_param_wrapper(fitsfile *fptr, int maxDimensions, int *bitpix, int *naxis, LONGLONG *naxes, int *status) {
+    // Use the LONGLONG variant so axis lengths are never narrowed to long
+    return fits_get_img_paramll(fptr, maxDimensions, bitpix, naxis, naxes, status);
 }
 
-int fits_read_keyn_wrapper(fitsfile *fptr, int index, char *keyName, char *value, char *comment, int *status) {
-    return fits_read_keyn(fptr, index, keyName, value, comment, status);
+int fits_read_pixll_wrapper(fitsfile *fptr, int dataType, LONGLONG *firstPixel, LONGLONG numElements, void *nullValue, void *array, int *anyNull, int *status) {
+    // firstPixel holds one 1-based coordinate per axis (NAXIS entries)
+    return fits_read_pixll(fptr, dataType, firstPixel, numElements, nullValue, array, anyNull, status);
 }
 
-int fits_get_img_param_wrapper(fitsfile *fptr, int maxDimensions, int *bitpix, int *naxis, LONGLONG *naxes, int *status) {
-    return fits_get_img_param(fptr, maxDimensions, bitpix, naxis, naxes, status);
-}
-
-int fits_read_img_wrapper(fitsfile *fptr, int dataType, int naxis, LONGLONG *firstPixel, LONGLONG *numElements, float *nullValue, float *array, int *anyNull, int *status) {
-    // Convert LONGLONG arrays to long arrays for fits_read_pix
-    // fits_read_pix expects long* (32-bit), but we receive LONGLONG* (64-bit) from Swift
-    // fits_read_pix is more commonly used and may be more compatible across CFITSIO versions
-    long firstPixelLong[3] = {1, 1, 1};  // Default to starting at pixel 1 in each dimension
-    long numElementsLong[3] = {1, 1, 1};  // Default values
-    
-    // Copy only the dimensions that exist (naxis is typically 1, 2, or 3)
-    int dimsToCopy = (naxis < 3) ? naxis : 3;
-    for (int i = 0; i < dimsToCopy; i++) {
-        firstPixelLong[i] = (long)firstPixel[i];
-        numElementsLong[i] = (long)numElements[i];
+
+int fits_read_img_elements_wrapper(fitsfile *fptr, int dataType, LONGLONG firstElement, LONGLONG numElements, void *nullValue, void *array, int *anyNull, int *status) {
+    // Reads a contiguous run of pixels addressed by 1-based linear element index.
+    // Consecutive rows (and planes) are contiguous in a FITS data unit, so a band of
+    // rows maps onto a single run. Used by the row-chunk reader so that large images
+    // can be streamed through a small, reusable buffer.
+    return fits_read_img(fptr, dataType, firstElement, numElements, nullValue, array, anyNull, status);
+}
+
+int fits_get_img_equivtype_wrapper(fitsfile *fptr, int *equivType, int *status) {
+    return fits_get_img_equivtype(fptr, equivType, status);
+}
+
+int fits_set_bscale_wrapper(fitsfile *fptr, double scale, double zero, int *status) {
+    return fits_set_bscale(fptr, scale, zero, status);
+}
+
+int fits_read_key_dbl_wrapper(fitsfile *fptr, const char *keyName, double *value, int *status) {
+    return fits_read_key(fptr, TDOUBLE, keyName, value, NULL, status);
+}
+
+int fits_get_hduaddrll_wrapper(fitsfile *fptr, LONGLONG *headStart, LONGLONG *dataStart, LONGLONG *dataEnd, int *status) {
+    // Byte offsets of the current HDU's header, data unit and end of data in the file
+    return fits_get_hduaddrll(fptr, headStart, dataStart, dataEnd, status);
+}
+
+int fits_is_compressed_image_wrapper(fitsfile *fptr, int *status) {
+    return fits_is_compressed_image(fptr, status);
+}
+
+int fits_hdr2str_wrapper(fitsfile *fptr, char **header, int *numKeys, int *status) {
+    // Returns every card of the current header as one string of 80-byte cards followed by END;
+    // numKeys does not count the END card.
+    // The caller releases the string with fits_free_memory_wrapper.
+    return fits_hdr2str(fptr, 0, NULL, 0, header, numKeys, status);
+}
+
+int fits_free_memory_wrapper(void *memory, int *status) {
+    return fits_free_memory(memory, status);
+}
+
+int fits_read_subset_wrapper(fitsfile *fptr, int dataType, int naxis, LONGLONG *firstPixel, LONGLONG *lastPixel, void *nullValue, void *array, int *anyNull, int *status) {
+    // Reads the rectangular (hyper-)box from firstPixel to lastPixel (1-based, inclusive)
+    // with unit increments. For tile-compressed images CFITSIO only decompresses the
+    // tiles that intersect the box.
+    long first[999];
+    long last[999];
+    long increment[999];
+
+    if (*status > 0) {
+        return *status;
+    }
+    if (naxis < 1 || naxis > 999) {
+        *status = BAD_NAXIS;
+        return *status;
     }
-    
-    // Calculate total number of elements to read
-    long totalElements = 1;
-    for (int i = 0; i < dimsToCopy; i++) {
-        totalElements *= numElementsLong[i];
+    for (int i = 0; i < naxis; i++) {
+        first[i] = (long)firstPixel[i];
+        last[i] = (long)lastPixel[i];
+        increment[i] = 1;
     }
-    
-    // Use fits_read_pix which is more straightforward and widely supported
-    // Signature: fits_read_pix(fitsfile *fptr, int datatype, long *fpixel, 
-    //                          long nelements, void *nulval, void *array, int *anynul, int *status)
-    // fpixel is the starting pixel array [1,1,1...], nelements is total number of pixels to read
-    return fits_read_pix(fptr, dataType, firstPixelLong, totalElements, nullValue, array, anyNull, status);
+    return fits_read_subset(fptr, dataType, first, last, increment, nullValue, array, anyNull, status);
+}
+
+int fits_get_hdu_num_wrapper(fitsfile *fptr, int *hduNumber) {
+    // Returns the 1-based number of the current HDU
+    return fits_get_hdu_num(fptr, hduNumber);
+}
+
+int fits_create_file_wrapper(fitsfile **fptr, const char *filename, int *status) {
+    // A leading '!' in filename overwrites an existing file
+    return fits_create_file(fptr, filename, status);
+}
+
+int fits_create_img_wrapper(fitsfile *fptr, int bitpix, int naxis, LONGLONG *naxes, int *status) {
+    // bitpix may also be one of the CFITSIO unsigned/signed codes such as USHORT_IMG (20),
+    // which writes BITPIX = 16 with BZERO = 32768
+    return fits_create_imgll(fptr, bitpix, naxis, naxes, status);
+}
+
+int fits_set_compression_type_wrapper(fitsfile *fptr, int compressionType, int *status) {
+    return fits_set_compression_type(fptr, compressionType, status);
 }
 
+int fits_set_tile_dim_wrapper(fitsfile *fptr, int naxis, LONGLONG *tileSize, int *status) {
+    long tiles[6];
+
+    if (*status > 0) {
+        return *status;
+    }
+    // CFITSIO supports tiling of at most 6 axes
+    if (naxis < 1 || naxis > 6) {
+        *status = BAD_NAXIS;
+        return *status;
+    }
+    for (int i = 0; i < naxis; i++) {
+        tiles[i] = (long)tileSize[i];
+    }
+    return fits_set_tile_dim(fptr, naxis, tiles, status);
+}
+
+int fits_set_quantize_level_wrapper(fitsfile *fptr, float level, int *status) {
+    return fits_set_quantize_level(fptr, level, status);
+}
+
+int fits_write_img_wrapper(fitsfile *fptr, int dataType, LONGLONG firstElement, LONGLONG numElements, void *array, int *status) {
+    // Writes a contiguous run of pixels addressed by 1-based linear element index.
+    // For compressed images CFITSIO buffers rows until a tile is complete and then compresses it.
+    return fits_write_img(fptr, dataType, firstElement, numElements, array, status);
+}
+
+int fits_write_record_wrapper(fitsfile *fptr, const char *card, int *status) {
+    return fits_write_record(fptr, card, status);
+}
+
+// Holds the buffer pointer and size that CFITSIO's memory driver keeps referring to for the
+// lifetime of a memory file, so they must not live on the caller's stack
+typedef struct {
+    void *buffer;
+    size_t size;
+} fits_memfile_handle;
+
+int fits_open_memfile_wrapper(fitsfile **fptr, const char *name, const void *buffer, size_t size, void **handle, int *status) {
+    fits_memfile_handle *memfile;
+
+    *handle = NULL;
+    if (*status > 0) {
+        return *status;
+    }
+    memfile = malloc(sizeof(fits_memfile_handle));
+    if (memfile == NULL) {
+        *status = MEMORY_ALLOCATION;
+        return *status;
+    }
+    // The buffer is opened read-only and without a realloc function, so CFITSIO
+    // neither writes to it nor resizes it
+    memfile->buffer = (void *)buffer;
+    memfile->size = size;
+    if (fits_open_memfile(fptr, name, READONLY, &memfile->buffer, &memfile->size, 0, NULL, status) > 0) {
+        free(memfile);
+        return *status;
+    }
+    *handle = memfile;
+    return *status;
+}
+
+void fits_free_memfile_handle_wrapper(void *handle) {
+    // Must only be called after the file has been closed
+    free(handle);
+}
+
+int fits_verify_chksum_wrapper(fitsfile *fptr, int *dataStatus, int *hduStatus, int *status) {
+    // Each status is 1 if the checksum is correct, 0 if the keyword is missing, -1 if it is wrong
+    return fits_verify_chksum(fptr, dataStatus, hduStatus, status);
+}
+
+int fits_update_chksum_wrapper(fitsfile *fptr, int *status) {
+    // Recomputes CHECKSUM from the header, assuming DATASUM is present and correct
+    return fits_update_chksum(fptr, status);
+}
+
+int fits_update_key_str_wrapper(fitsfile *fptr, const char *keyname, const char *value, const char *comment, int *status) {
+    return fits_update_key_str(fptr, keyname, value, comment, status);
+}
+
+int fits_flush_file_wrapper(fitsfile *fptr, int *status) {
+    return fits_flush_file(fptr, status);
+}
@@ -0,0 +1,43 @@
+#include <stddef.h>
+#include <stdint.h>
+
+// 32-bit ones' complement checksums of FITS data, as defined by the FITS checksum
+// convention (CHECKSUM / DATASUM keywords).
+// These functions are called from Swift using @_silgen_name
+//
+// Ones' complement addition is associative and commutative, so a data unit can be split
+// into word-aligned chunks that are summed on different threads and combined afterwards.
+
+// Folds the 16-bit carries of split high/low accumulators into a 32-bit sum
+static uint32_t apk_checksum_fold(uint64_t hi, uint64_t lo) {
+    uint64_t hicarry = hi >> 16;
+    uint64_t locarry = lo >> 16;
+    while (hicarry | locarry) {
+        hi = (hi & 0xFFFF) + locarry;
+        lo = (lo & 0xFFFF) + hicarry;
+        hicarry = hi >> 16;
+        locarry = lo >> 16;
+    }
+    return (uint32_t)((hi << 16) | lo);
+}
+
+// Adds `length` bytes of big-endian 32-bit words to a running sum; `length` must be a
+// multiple of 4. The high and low halves of every word are accumulated separately in
+// 64-bit lanes, so the loop has no carries to propagate and auto-vectorizes.
+uint32_t apk_checksum_accumulate(const uint8_t *data, size_t length, uint32_t sum) {
+    uint64_t hi = sum >> 16;
+    uint64_t lo = sum & 0xFFFF;
+    const size_t words = length / 4;
+
+    for (size_t i = 0; i < words; i++) {
+        const uint8_t *word = data + 4 * i;
+        hi += ((uint32_t)word[0] << 8) | word[1];
+        lo += ((uint32_t)word[2] << 8) | word[3];
+    }
+    return apk_checksum_fold(hi, lo);
+}
+
+// Combines two partial sums of disjoint, word-aligned chunks
+uint32_t apk_checksum_combine(uint32_t a, uint32_t b) {
+    return apk_checksum_fold((uint64_t)(a >> 16) + (b >> 16), (uint64_t)(a & 0xFFFF) + (b & 0xFFFF));
+}
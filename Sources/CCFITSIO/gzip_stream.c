@@ -0,0 +1,113 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+// Streaming and block-parallel decompression of gzip-compressed FITS files (.fits.gz)
+// These functions are called from Swift using @_silgen_name
+//
+// Sequential streams use zlib's gzFile interface, which inflates into a small buffer and
+// handles files with several concatenated gzip members. Files written in the BGZF layout
+// (bgzip, pigz --blocked) store the size of every member in its header, so the members can
+// be located without inflating and decompressed independently on several threads.
+
+// Size of the buffer zlib reads compressed data into
+#define APK_GZ_BUFFER_SIZE (256 * 1024)
+
+// BGZF members carry the compressed size in a 'BC' extra subfield
+#define APK_BGZF_HEADER_SIZE 18
+#define APK_GZIP_TRAILER_SIZE 8
+
+// Opens a gzip (or uncompressed) file for sequential reading; returns NULL on failure
+void *apk_gz_open(const char *path) {
+    gzFile file = gzopen(path, "rb");
+    if (file != NULL) {
+        gzbuffer(file, APK_GZ_BUFFER_SIZE);
+    }
+    return file;
+}
+
+// Inflates up to `length` bytes into `buffer`; returns the number of bytes read
+// (less than `length` only at the end of the stream), or -1 on error
+long apk_gz_read(void *handle, void *buffer, size_t length) {
+    gzFile file = (gzFile)handle;
+    size_t total = 0;
+
+    // gzread takes an unsigned int length, so read large requests in pieces
+    while (total < length) {
+        size_t request = length - total;
+        if (request > (1u << 30)) {
+            request = 1u << 30;
+        }
+        int count = gzread(file, (uint8_t *)buffer + total, (unsigned int)request);
+        if (count < 0) {
+            return -1;
+        }
+        if (count == 0) {
+            break;
+        }
+        total += (size_t)count;
+    }
+    return (long)total;
+}
+
+void apk_gz_close(void *handle) {
+    gzclose((gzFile)handle);
+}
+
+static uint32_t apk_read_le32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+// Locates the members of a BGZF file. Writes the byte offset of each member to `offsets`
+// and its uncompressed size to `sizes`, for at most `capacity` members.
+// Returns the number of members, or -1 if the data is not entirely in BGZF layout.
+long apk_bgzf_index(const uint8_t *data, size_t length, uint64_t *offsets, uint32_t *sizes, size_t capacity) {
+    size_t position = 0;
+    long count = 0;
+
+    while (position < length) {
+        const uint8_t *member = data + position;
+        if (length - position < APK_BGZF_HEADER_SIZE + APK_GZIP_TRAILER_SIZE ||
+            member[0] != 0x1f || member[1] != 0x8b || member[2] != 8 || (member[3] & 4) == 0) {
+            return -1;
+        }
+        // XLEN = 6 with a single 'BC' subfield of length 2 holding BSIZE (member size - 1)
+        uint16_t extraLength = (uint16_t)(member[10] | (member[11] << 8));
+        if (extraLength != 6 || member[12] != 'B' || member[13] != 'C' || member[14] != 2 || member[15] != 0) {
+            return -1;
+        }
+        size_t memberSize = (size_t)(member[16] | (member[17] << 8)) + 1;
+        if (memberSize < APK_BGZF_HEADER_SIZE + APK_GZIP_TRAILER_SIZE || memberSize > length - position) {
+            return -1;
+        }
+        if ((size_t)count < capacity) {
+            offsets[count] = position;
+            // ISIZE: uncompressed size modulo 2^32, the last field of the trailer
+            sizes[count] = apk_read_le32(member + memberSize - 4);
+        }
+        count++;
+        position += memberSize;
+    }
+    return count;
+}
+
+// Inflates one complete gzip member into `destination`; returns the number of bytes
+// produced, or -1 if the member is corrupt or does not fit
+long apk_inflate_member(const uint8_t *source, size_t sourceLength, uint8_t *destination, size_t capacity) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // windowBits 15 + 16 selects the gzip wrapper
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return -1;
+    }
+    stream.next_in = (Bytef *)source;
+    stream.avail_in = (uInt)sourceLength;
+    stream.next_out = destination;
+    stream.avail_out = (uInt)capacity;
+
+    int result = inflate(&stream, Z_FINISH);
+    long produced = (long)stream.total_out;
+    inflateEnd(&stream);
+    return result == Z_STREAM_END ? produced : -1;
+}
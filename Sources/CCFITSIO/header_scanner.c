@@ -0,0 +1,195 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Single-pass scanner for FITS header cards, used by the Swift side to parse a whole
+// header fetched with fits_hdr2str without per-keyword CFITSIO calls.
+// These functions are called from Swift using @_silgen_name
+//
+// For every card the scanner writes APK_CARD_FIELDS int32 values into `fields`:
+//   [0] keyword offset      [1] keyword length
+//   [2] value kind (see below)
+//   [3] value offset        [4] value length
+//   [5] comment offset      [6] comment length
+// Offsets are byte offsets from the start of the header text. String values exclude the
+// enclosing quotes (embedded '' escapes are left for the caller) and trailing blanks.
+
+#define APK_CARD_LENGTH 80
+#define APK_CARD_FIELDS 7
+
+// Value kinds
+#define APK_VALUE_NONE 0       // Commentary card (COMMENT, HISTORY, blank keyword, ...)
+#define APK_VALUE_STRING 1     // Quoted string
+#define APK_VALUE_INTEGER 2    // Integer literal
+#define APK_VALUE_FLOAT 3      // Floating-point literal (E or D exponent)
+#define APK_VALUE_LOGICAL 4    // T or F
+#define APK_VALUE_OTHER 5      // Undefined or unrecognized (e.g. complex) value
+
+static int apk_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Classifies an unquoted value token as integer, float, logical or other
+static int apk_classify_value(const char *value, size_t length) {
+    if (length == 0) {
+        return APK_VALUE_OTHER;
+    }
+    if (length == 1 && (value[0] == 'T' || value[0] == 'F')) {
+        return APK_VALUE_LOGICAL;
+    }
+
+    size_t i = 0;
+    if (value[i] == '+' || value[i] == '-') {
+        i++;
+    }
+    size_t digits = 0;
+    while (i < length && apk_is_digit(value[i])) {
+        i++;
+        digits++;
+    }
+    if (i == length) {
+        return digits > 0 ? APK_VALUE_INTEGER : APK_VALUE_OTHER;
+    }
+
+    if (value[i] == '.') {
+        i++;
+        while (i < length && apk_is_digit(value[i])) {
+            i++;
+            digits++;
+        }
+    }
+    if (digits == 0) {
+        return APK_VALUE_OTHER;
+    }
+    if (i < length && (value[i] == 'E' || value[i] == 'e' || value[i] == 'D' || value[i] == 'd')) {
+        i++;
+        if (i < length && (value[i] == '+' || value[i] == '-')) {
+            i++;
+        }
+        size_t exponentDigits = 0;
+        while (i < length && apk_is_digit(value[i])) {
+            i++;
+            exponentDigits++;
+        }
+        if (exponentDigits == 0) {
+            return APK_VALUE_OTHER;
+        }
+    }
+    return i == length ? APK_VALUE_FLOAT : APK_VALUE_OTHER;
+}
+
+// Returns the length of text with trailing blanks removed
+static size_t apk_trim_right(const char *text, size_t length) {
+    while (length > 0 && text[length - 1] == ' ') {
+        length--;
+    }
+    return length;
+}
+
+// Scans up to maxCards cards of header text and stops at the END card (which is not reported).
+// Returns the number of cards written to fields.
+size_t apk_scan_header(const char *header, size_t maxCards, int32_t *fields) {
+    size_t written = 0;
+
+    for (size_t card = 0; card < maxCards; card++) {
+        const char *text = header + card * APK_CARD_LENGTH;
+        const int32_t base = (int32_t)(card * APK_CARD_LENGTH);
+        int32_t *out = fields + written * APK_CARD_FIELDS;
+
+        size_t keyStart = 0;
+        size_t keyLength = apk_trim_right(text, 8);
+        size_t valueStart = 10;
+
+        if (keyLength == 3 && memcmp(text, "END", 3) == 0 && apk_trim_right(text, APK_CARD_LENGTH) == 3) {
+            break;
+        }
+
+        int hasValue = text[8] == '=' && text[9] == ' ';
+
+        // ESO HIERARCH convention: the keyword runs up to the '=' sign
+        if (keyLength == 8 && memcmp(text, "HIERARCH", 8) == 0) {
+            const char *equals = memchr(text + 8, '=', APK_CARD_LENGTH - 8);
+            if (equals != NULL) {
+                size_t start = 8;
+                while (start < (size_t)(equals - text) && text[start] == ' ') {
+                    start++;
+                }
+                keyStart = start;
+                keyLength = apk_trim_right(text + start, (size_t)(equals - text) - start);
+                valueStart = (size_t)(equals - text) + 1;
+                hasValue = 1;
+            }
+        }
+
+        out[0] = base + (int32_t)keyStart;
+        out[1] = (int32_t)keyLength;
+
+        if (!hasValue) {
+            // Commentary card: everything after the keyword is free text
+            out[2] = APK_VALUE_NONE;
+            out[3] = base + 8;
+            out[4] = 0;
+            out[5] = base + 8;
+            out[6] = (int32_t)apk_trim_right(text + 8, APK_CARD_LENGTH - 8);
+            written++;
+            continue;
+        }
+
+        size_t i = valueStart;
+        while (i < APK_CARD_LENGTH && text[i] == ' ') {
+            i++;
+        }
+
+        size_t valueEnd;
+        if (i < APK_CARD_LENGTH && text[i] == '\'') {
+            // Quoted string; '' is an escaped quote
+            size_t start = i + 1;
+            size_t j = start;
+            while (j < APK_CARD_LENGTH) {
+                if (text[j] == '\'') {
+                    if (j + 1 < APK_CARD_LENGTH && text[j + 1] == '\'') {
+                        j += 2;
+                        continue;
+                    }
+                    break;
+                }
+                j++;
+            }
+            out[2] = APK_VALUE_STRING;
+            out[3] = base + (int32_t)start;
+            out[4] = (int32_t)apk_trim_right(text + start, j - start);
+            valueEnd = j < APK_CARD_LENGTH ? j + 1 : APK_CARD_LENGTH;
+        } else {
+            size_t start = i;
+            size_t j = start;
+            while (j < APK_CARD_LENGTH && text[j] != '/') {
+                j++;
+            }
+            size_t length = apk_trim_right(text + start, j - start);
+            out[2] = apk_classify_value(text + start, length);
+            out[3] = base + (int32_t)start;
+            out[4] = (int32_t)length;
+            valueEnd = j;
+        }
+
+        // Comment follows the first '/' after the value
+        size_t c = valueEnd;
+        while (c < APK_CARD_LENGTH && text[c] != '/') {
+            c++;
+        }
+        if (c < APK_CARD_LENGTH) {
+            c++;
+            while (c < APK_CARD_LENGTH && text[c] == ' ') {
+                c++;
+            }
+            out[5] = base + (int32_t)c;
+            out[6] = (int32_t)apk_trim_right(text + c, APK_CARD_LENGTH - c);
+        } else {
+            out[5] = base + APK_CARD_LENGTH;
+            out[6] = 0;
+        }
+        written++;
+    }
+
+    return written;
+}
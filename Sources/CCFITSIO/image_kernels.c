@@ -0,0 +1,383 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Image processing kernels for the CPU execution backend
+// These functions are called from Swift using @_silgen_name
+//
+// Every kernel works on a range of rows [y0, y1) of a Float32 image with a row stride
+// given in elements, so that Swift can split an image into bands and run them on all
+// cores. The inner loops run along rows without branches so that the compiler
+// auto-vectorizes them; they reproduce the Metal shaders of the same steps.
+
+static inline ptrdiff_t clamp_index(ptrdiff_t value, ptrdiff_t upper) {
+    return value < 0 ? 0 : (value > upper ? upper : value);
+}
+
+// MARK: - Gaussian blur
+
+// Horizontal pass of a separable convolution with edge clamping
+// weights holds 2 * radius + 1 normalized taps
+void apk_convolve_rows_horizontal(const float *src, ptrdiff_t srcStride, float *dst, ptrdiff_t dstStride,
+                                  ptrdiff_t width, ptrdiff_t y0, ptrdiff_t y1,
+                                  const float *weights, ptrdiff_t radius) {
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        const float *restrict in = src + y * srcStride;
+        float *restrict out = dst + y * dstStride;
+
+        // Interior pixels need no clamping: accumulate one tap at a time across the row
+        ptrdiff_t interiorEnd = width - radius;
+        if (interiorEnd > radius) {
+            for (ptrdiff_t x = radius; x < interiorEnd; x++) {
+                out[x] = 0.0f;
+            }
+            for (ptrdiff_t k = 0; k <= 2 * radius; k++) {
+                const float w = weights[k];
+                const float *restrict tap = in + k - radius;
+                for (ptrdiff_t x = radius; x < interiorEnd; x++) {
+                    out[x] += w * tap[x];
+                }
+            }
+        }
+
+        // Edge pixels: the whole row if it is narrower than the kernel
+        const ptrdiff_t leftEnd = interiorEnd > radius ? radius : width;
+        const ptrdiff_t rightStart = interiorEnd > radius ? interiorEnd : width;
+        for (ptrdiff_t x = 0; x < width; x++) {
+            if (x == leftEnd) {
+                x = rightStart;
+                if (x >= width) {
+                    break;
+                }
+            }
+            float sum = 0.0f;
+            for (ptrdiff_t k = -radius; k <= radius; k++) {
+                sum += weights[k + radius] * in[clamp_index(x + k, width - 1)];
+            }
+            out[x] = sum;
+        }
+    }
+}
+
+// Vertical pass of a separable convolution with edge clamping
+void apk_convolve_rows_vertical(const float *src, ptrdiff_t srcStride, float *dst, ptrdiff_t dstStride,
+                                ptrdiff_t width, ptrdiff_t height, ptrdiff_t y0, ptrdiff_t y1,
+                                const float *weights, ptrdiff_t radius) {
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        float *restrict out = dst + y * dstStride;
+        for (ptrdiff_t x = 0; x < width; x++) {
+            out[x] = 0.0f;
+        }
+        for (ptrdiff_t k = -radius; k <= radius; k++) {
+            const float w = weights[k + radius];
+            const float *restrict in = src + clamp_index(y + k, height - 1) * srcStride;
+            for (ptrdiff_t x = 0; x < width; x++) {
+                out[x] += w * in[x];
+            }
+        }
+    }
+}
+
+// MARK: - Local median background
+
+// Maps values in 0-1 to 256 histogram bins, as the local_median shader does
+void apk_quantize_rows_u8(const float *src, ptrdiff_t srcStride, uint8_t *dst, ptrdiff_t dstStride,
+                          ptrdiff_t width, ptrdiff_t y0, ptrdiff_t y1) {
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        const float *restrict in = src + y * srcStride;
+        uint8_t *restrict out = dst + y * dstStride;
+        for (ptrdiff_t x = 0; x < width; x++) {
+            float v = fminf(fmaxf(in[x], 0.0f), 1.0f) * 256.0f;
+            out[x] = (uint8_t)fminf(v, 255.0f);
+        }
+    }
+}
+
+// Moves the median bin m so that it is the first bin whose cumulative count reaches target;
+// below is the number of values in the bins before m
+static inline void settle_median(const uint32_t *histogram, uint32_t target, int *m, uint32_t *below) {
+    while (*m < 255 && *below + histogram[*m] < target) {
+        *below += histogram[*m];
+        (*m)++;
+    }
+    while (*m > 0 && *below >= target) {
+        (*m)--;
+        *below -= histogram[*m];
+    }
+}
+
+// Median of the (2 * halfWindow + 1)^2 window around each pixel, clipped at the image edges
+//
+// The window histogram slides along each row (Huang's algorithm): moving one pixel right
+// removes one column and adds another, so the cost per pixel grows with the window height
+// instead of its area.
+void apk_local_median_rows(const uint8_t *bins, ptrdiff_t binStride, float *dst, ptrdiff_t dstStride,
+                           ptrdiff_t width, ptrdiff_t height, ptrdiff_t y0, ptrdiff_t y1, ptrdiff_t halfWindow) {
+    uint32_t histogram[256];
+
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        const ptrdiff_t top = y - halfWindow < 0 ? 0 : y - halfWindow;
+        const ptrdiff_t bottom = y + halfWindow > height - 1 ? height - 1 : y + halfWindow;
+        const ptrdiff_t rows = bottom - top + 1;
+        const uint8_t *window = bins + top * binStride;
+        float *out = dst + y * dstStride;
+
+        memset(histogram, 0, sizeof(histogram));
+        uint32_t count = 0;
+        int m = 0;
+        uint32_t below = 0;
+
+        const ptrdiff_t firstColumns = halfWindow + 1 < width ? halfWindow + 1 : width;
+        for (ptrdiff_t r = 0; r < rows; r++) {
+            for (ptrdiff_t x = 0; x < firstColumns; x++) {
+                histogram[window[r * binStride + x]]++;
+            }
+        }
+        count = (uint32_t)(rows * firstColumns);
+
+        for (ptrdiff_t x = 0; x < width; x++) {
+            settle_median(histogram, count / 2, &m, &below);
+            out[x] = ((float)m + 0.5f) / 256.0f;
+
+            const ptrdiff_t removed = x - halfWindow;
+            if (removed >= 0) {
+                for (ptrdiff_t r = 0; r < rows; r++) {
+                    uint8_t bin = window[r * binStride + removed];
+                    histogram[bin]--;
+                    below -= bin < m;
+                }
+                count -= (uint32_t)rows;
+            }
+            const ptrdiff_t added = x + halfWindow + 1;
+            if (added < width) {
+                for (ptrdiff_t r = 0; r < rows; r++) {
+                    uint8_t bin = window[r * binStride + added];
+                    histogram[bin]++;
+                    below += bin < m;
+                }
+                count += (uint32_t)rows;
+            }
+        }
+    }
+}
+
+// dst = clamp(src - background, 0, 1)
+void apk_subtract_clamped_f32(const float *restrict src, const float *restrict background, float *restrict dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = fminf(fmaxf(src[i] - background[i], 0.0f), 1.0f);
+    }
+}
+
+// MARK: - Threshold and statistics
+
+// dst = src >= threshold ? 1 : 0
+void apk_threshold_f32(const float *restrict src, float *restrict dst, size_t count, float threshold) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[i] >= threshold ? 1.0f : 0.0f;
+    }
+}
+
+// Adds the sum and the sum of squares of the values to *sum and *sumSquares
+void apk_sum_squares_f32(const float *restrict src, size_t count, double *sum, double *sumSquares) {
+    double s = 0.0;
+    double sq = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        s += src[i];
+        sq += (double)src[i] * src[i];
+    }
+    *sum += s;
+    *sumSquares += sq;
+}
+
+// Adds the values to a histogram: bin = min(int(clamp(v, 0, 1) * scale), bins - 1), where
+// v is the value itself or, if absolute is set, its distance from center
+void apk_histogram_f32(const float *restrict src, size_t count, float center, int absolute,
+                       float scale, int bins, uint32_t *restrict histogram) {
+    for (size_t i = 0; i < count; i++) {
+        float v = absolute ? fabsf(src[i] - center) : src[i];
+        int bin = (int)(fminf(fmaxf(v, 0.0f), 1.0f) * scale);
+        histogram[bin < bins - 1 ? bin : bins - 1]++;
+    }
+}
+
+// MARK: - Binary morphology
+
+// Horizontal pass of binary erosion (erode != 0) or dilation over a clamped window
+// Writes 1 where all (erosion) or any (dilation) pixels in the window are >= 0.5
+void apk_binary_morphology_rows_horizontal(const float *src, ptrdiff_t srcStride, float *dst, ptrdiff_t dstStride,
+                                           ptrdiff_t width, ptrdiff_t y0, ptrdiff_t y1, ptrdiff_t radius, int erode) {
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        const float *restrict in = src + y * srcStride;
+        float *restrict out = dst + y * dstStride;
+        for (ptrdiff_t x = 0; x < width; x++) {
+            const ptrdiff_t start = x - radius < 0 ? 0 : x - radius;
+            const ptrdiff_t end = x + radius > width - 1 ? width - 1 : x + radius;
+            float value = erode ? 1.0f : 0.0f;
+            for (ptrdiff_t j = start; j <= end; j++) {
+                const float set = in[j] >= 0.5f ? 1.0f : 0.0f;
+                value = erode ? fminf(value, set) : fmaxf(value, set);
+            }
+            out[x] = value;
+        }
+    }
+}
+
+// Vertical pass of binary erosion or dilation over the 0/1 output of the horizontal pass
+void apk_binary_morphology_rows_vertical(const float *src, ptrdiff_t srcStride, float *dst, ptrdiff_t dstStride,
+                                         ptrdiff_t width, ptrdiff_t height, ptrdiff_t y0, ptrdiff_t y1,
+                                         ptrdiff_t radius, int erode) {
+    for (ptrdiff_t y = y0; y < y1; y++) {
+        const ptrdiff_t start = y - radius < 0 ? 0 : y - radius;
+        const ptrdiff_t end = y + radius > height - 1 ? height - 1 : y + radius;
+        float *restrict out = dst + y * dstStride;
+        memcpy(out, src + start * srcStride, (size_t)width * sizeof(float));
+        for (ptrdiff_t r = start + 1; r <= end; r++) {
+            const float *restrict in = src + r * srcStride;
+            if (erode) {
+                for (ptrdiff_t x = 0; x < width; x++) {
+                    out[x] = fminf(out[x], in[x]);
+                }
+            } else {
+                for (ptrdiff_t x = 0; x < width; x++) {
+                    out[x] = fmaxf(out[x], in[x]);
+                }
+            }
+        }
+    }
+}
+
+// MARK: - Connected components
+
+// Writes the (x, y) coordinates of the pixels >= 0.5 in one row; returns their number
+size_t apk_collect_set_pixels(const float *restrict row, ptrdiff_t width, ptrdiff_t y, int32_t *restrict coordinates) {
+    size_t count = 0;
+    for (ptrdiff_t x = 0; x < width; x++) {
+        if (row[x] >= 0.5f) {
+            coordinates[2 * count] = (int32_t)x;
+            coordinates[2 * count + 1] = (int32_t)y;
+            count++;
+        }
+    }
+    return count;
+}
+
+// MARK: - Star detection overlay
+
+// Copies grayscale values to the RGB channels of an RGBA image with alpha 1
+void apk_gray_to_rgba_f32(const float *restrict src, float *restrict dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[4 * i] = src[i];
+        dst[4 * i + 1] = src[i];
+        dst[4 * i + 2] = src[i];
+        dst[4 * i + 3] = 1.0f;
+    }
+}
+
+static inline void set_rgb(float *pixel, const float *color) {
+    pixel[0] = color[0];
+    pixel[1] = color[1];
+    pixel[2] = color[2];
+    pixel[3] = 1.0f;
+}
+
+// Draws ellipse outlines and axes into rows [y0, y1) of an RGBA image, like draw_ellipses
+// ellipses holds 5 floats per ellipse: centroid x, centroid y, major axis, minor axis, rotation
+// Only the bounding box of each ellipse is visited instead of testing every pixel.
+void apk_draw_ellipses_rows(float *rgba, ptrdiff_t rowStride, ptrdiff_t width, ptrdiff_t y0, ptrdiff_t y1,
+                            const float *ellipses, size_t ellipseCount, const float *color) {
+    for (size_t i = 0; i < ellipseCount; i++) {
+        const float cx = ellipses[5 * i];
+        const float cy = ellipses[5 * i + 1];
+        const float a = ellipses[5 * i + 2];
+        const float b = ellipses[5 * i + 3];
+        const float angle = ellipses[5 * i + 4];
+        if (!(a > 0.0f && b > 0.0f) || !isfinite(cx) || !isfinite(cy) || !isfinite(a) || !isfinite(b)) {
+            continue;
+        }
+
+        const float avgRadius = (a + b) * 0.5f;
+        const float threshold = 1.0f / fmaxf(avgRadius, 1.0f);
+        const float reach = fmaxf(a, b) * sqrtf(1.0f + threshold) + 1.0f;
+        const float cosAngle = cosf(-angle);
+        const float sinAngle = sinf(-angle);
+
+        ptrdiff_t top = (ptrdiff_t)floorf(cy - reach);
+        ptrdiff_t bottom = (ptrdiff_t)ceilf(cy + reach);
+        ptrdiff_t left = (ptrdiff_t)floorf(cx - reach);
+        ptrdiff_t right = (ptrdiff_t)ceilf(cx + reach);
+        top = top < y0 ? y0 : top;
+        bottom = bottom > y1 - 1 ? y1 - 1 : bottom;
+        left = left < 0 ? 0 : left;
+        right = right > width - 1 ? width - 1 : right;
+
+        for (ptrdiff_t y = top; y <= bottom; y++) {
+            float *row = rgba + y * rowStride;
+            const float dy = (float)y - cy;
+            for (ptrdiff_t x = left; x <= right; x++) {
+                const float dx = (float)x - cx;
+                const float rx = cosAngle * dx - sinAngle * dy;
+                const float ry = sinAngle * dx + cosAngle * dy;
+                const float value = (rx * rx) / (a * a) + (ry * ry) / (b * b);
+                const int onEllipse = fabsf(value - 1.0f) <= threshold;
+                const int onAxis = value <= 1.0f && (fabsf(ry) <= 0.5f || fabsf(rx) <= 0.5f);
+                if (onEllipse || onAxis) {
+                    set_rgb(row + 4 * x, color);
+                }
+            }
+        }
+    }
+}
+
+static inline float distance_to_segment(float px, float py, float ax, float ay, float bx, float by) {
+    const float dx = bx - ax;
+    const float dy = by - ay;
+    const float length = sqrtf(dx * dx + dy * dy);
+    if (length < 0.0001f) {
+        return sqrtf((px - ax) * (px - ax) + (py - ay) * (py - ay));
+    }
+    const float ux = dx / length;
+    const float uy = dy / length;
+    float projection = (px - ax) * ux + (py - ay) * uy;
+    projection = fminf(fmaxf(projection, 0.0f), length);
+    const float qx = ax + ux * projection - px;
+    const float qy = ay + uy * projection - py;
+    return sqrtf(qx * qx + qy * qy);
+}
+
+// Draws the outlines S1-S2-S3-S4-S1 of quads into rows [y0, y1) of an RGBA image, like draw_quads
+// quads holds 8 floats per quad: x1, y1, x2, y2, x3, y3, x4, y4
+void apk_draw_quads_rows(float *rgba, ptrdiff_t rowStride, ptrdiff_t width, ptrdiff_t y0, ptrdiff_t y1,
+                         const float *quads, size_t quadCount, const float *color, float lineWidth) {
+    const float halfWidth = lineWidth * 0.5f;
+    for (size_t i = 0; i < quadCount; i++) {
+        const float *q = quads + 8 * i;
+        for (int edge = 0; edge < 4; edge++) {
+            const float ax = q[2 * edge];
+            const float ay = q[2 * edge + 1];
+            const float bx = q[(2 * edge + 2) % 8];
+            const float by = q[(2 * edge + 3) % 8];
+            if (!isfinite(ax) || !isfinite(ay) || !isfinite(bx) || !isfinite(by)) {
+                continue;
+            }
+
+            ptrdiff_t top = (ptrdiff_t)floorf(fminf(ay, by) - halfWidth);
+            ptrdiff_t bottom = (ptrdiff_t)ceilf(fmaxf(ay, by) + halfWidth);
+            ptrdiff_t left = (ptrdiff_t)floorf(fminf(ax, bx) - halfWidth);
+            ptrdiff_t right = (ptrdiff_t)ceilf(fmaxf(ax, bx) + halfWidth);
+            top = top < y0 ? y0 : top;
+            bottom = bottom > y1 - 1 ? y1 - 1 : bottom;
+            left = left < 0 ? 0 : left;
+            right = right > width - 1 ? width - 1 : right;
+
+            for (ptrdiff_t y = top; y <= bottom; y++) {
+                float *row = rgba + y * rowStride;
+                for (ptrdiff_t x = left; x <= right; x++) {
+                    if (distance_to_segment((float)x, (float)y, ax, ay, bx, by) <= halfWidth) {
+                        set_rgb(row + 4 * x, color);
+                    }
+                }
+            }
+        }
+    }
+}
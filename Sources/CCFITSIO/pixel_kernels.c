@@ -0,0 +1,184 @@
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Native pixel kernels used by the Swift side for bulk pixel conversion
+// These functions are called from Swift using @_silgen_name
+//
+// The loops are written without branches or aliasing so that the compiler
+// auto-vectorizes them (NEON on Apple Silicon, SSE/AVX on x86_64).
+
+// Converts stored pixel values to physical Float32 values: dst = zero + scale * src
+void apk_convert_u8_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)src[i] * s + z;
+    }
+}
+
+void apk_convert_i16_to_f32(const int16_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)src[i] * s + z;
+    }
+}
+
+void apk_convert_u16_to_f32(const uint16_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)src[i] * s + z;
+    }
+}
+
+void apk_convert_i32_to_f32(const int32_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    // 32-bit integers do not fit a float mantissa, so scale in double precision
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)((double)src[i] * scale + zero);
+    }
+}
+
+void apk_convert_i64_to_f32(const int64_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)((double)src[i] * scale + zero);
+    }
+}
+
+void apk_convert_f32_to_f32(const float *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    if (scale == 1.0 && zero == 0.0) {
+        memcpy(dst, src, count * sizeof(float));
+        return;
+    }
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        // Separate statements keep the product rounded (no FMA contraction), so the
+        // normalized view maps the minimum of an image to exactly 0
+        const float product = src[i] * s;
+        dst[i] = product + z;
+    }
+}
+
+void apk_convert_f64_to_f32(const double *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)(src[i] * scale + zero);
+    }
+}
+
+// Converts big-endian stored values (as found in a FITS data unit) to physical Float32 values.
+// src is a byte pointer into the data unit and need not be aligned; each element is loaded
+// with memcpy and byte-swapped, which compiles to a single load + rev/bswap per element.
+static inline uint16_t apk_load_be16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap16(v);
+#endif
+    return v;
+}
+
+static inline uint32_t apk_load_be32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t apk_load_be64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+void apk_convert_be_i16_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)(int16_t)apk_load_be16(src + 2 * i) * s + z;
+    }
+}
+
+void apk_convert_be_u16_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)apk_load_be16(src + 2 * i) * s + z;
+    }
+}
+
+void apk_convert_be_i32_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)((double)(int32_t)apk_load_be32(src + 4 * i) * scale + zero);
+    }
+}
+
+void apk_convert_be_i64_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (float)((double)(int64_t)apk_load_be64(src + 8 * i) * scale + zero);
+    }
+}
+
+void apk_convert_be_f32_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    const float s = (float)scale;
+    const float z = (float)zero;
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t bits = apk_load_be32(src + 4 * i);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        dst[i] = v * s + z;
+    }
+}
+
+void apk_convert_be_f64_to_f32(const uint8_t *restrict src, float *restrict dst, size_t count, double scale, double zero) {
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t bits = apk_load_be64(src + 8 * i);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        dst[i] = (float)(v * scale + zero);
+    }
+}
+
+// Accumulates the range of the finite values in src into *minValue / *maxValue.
+// NaN and infinite pixels (blank values) are skipped. The caller seeds the range with
+// +FLT_MAX / -FLT_MAX, which allows the range to be accumulated chunk by chunk.
+// Returns the number of finite values seen.
+size_t apk_minmax_f32(const float *restrict src, size_t count, float *minValue, float *maxValue) {
+    float lo = *minValue;
+    float hi = *maxValue;
+    size_t finite = 0;
+    for (size_t i = 0; i < count; i++) {
+        const float v = src[i];
+        const int isFinite = fabsf(v) <= FLT_MAX;
+        lo = (isFinite && v < lo) ? v : lo;
+        hi = (isFinite && v > hi) ? v : hi;
+        finite += (size_t)isFinite;
+    }
+    *minValue = lo;
+    *maxValue = hi;
+    return finite;
+}
+
+// Maps src from [minValue, maxValue] to [0, 1]. src and dst may be the same buffer.
+// Blank (NaN) pixels stay NaN. If the range is empty the values are copied unchanged.
+void apk_normalize_f32(const float *src, float *dst, size_t count, float minValue, float maxValue) {
+    const float range = maxValue - minValue;
+    if (!(range > 0.0f)) {
+        if (src != dst) {
+            memmove(dst, src, count * sizeof(float));
+        }
+        return;
+    }
+    const float inverseRange = 1.0f / range;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (src[i] - minValue) * inverseRange;
+    }
+}
@@ -114,6 +114,79 @@ func readImageMetadata() throws {
     }
 }
 
+@Test("Keyword table parses header cards")
+func parseKeywordTable() throws {
+    let cards = [
+        "SIMPLE  =                    T / conforms to FITS standard",
+        "NAXIS1  =                 1024",
+        "OBJECT  = 'Barnard''s Star'   / target",
+        "EXPTIME =              1.5D+02 / seconds",
+        "HISTORY calibrated",
+        "END"
+    ]
+    let text = cards.flatMap { Array($0.padding(toLength: 80, withPad: " ", startingAt: 0).utf8) }
+    let table = FITSKeywordTable(text: text)
+
+    #expect(table.count == 5, "END should terminate the table")
+    #expect(table.value(for: "SIMPLE") == .boolean(true))
+    #expect(table.value(for: "NAXIS1") == .integer(1024))
+    #expect(table.value(for: "OBJECT") == .string("Barnard's Star"))
+    #expect(table.comment(at: 2) == "target")
+    #expect(table.value(for: "EXPTIME") == .floatingPoint(150))
+    #expect(table.value(for: "HISTORY") == .comment("calibrated"))
+    #expect(table.value(for: "NAXIS") == nil)
+
+    if let firstFile = getAllFITSFiles().first {
+        let fitsFile = try FITSFile(path: firstFile)
+        let image = try fitsFile.readFITSImage()
+        let fileTable = try fitsFile.readKeywordTable()
+        #expect(fileTable.value(for: "NAXIS1")?.intValue == Int64(image.width), "NAXIS1 should match image width")
+    }
+}
+
+@Test("Header keeps repeated keywords")
+func headerRepeatedKeywords() {
+    let cards = [
+        FITSHeader.formatCard(keyword: "EXPTIME", value: .floatingPoint(300), comment: "seconds"),
+        FITSHeader.formatCard(keyword: "HISTORY", value: .comment("dark subtracted")),
+        FITSHeader.formatCard(keyword: "FILTER", value: .string("Ha")),
+        FITSHeader.formatCard(keyword: "HISTORY", value: .comment("flat fielded")),
+        "END".padding(toLength: 80, withPad: " ", startingAt: 0)
+    ]
+    let header = FITSHeader(table: FITSKeywordTable(text: Array(cards.joined().utf8)))
+
+    #expect(header.count == 4)
+    #expect(header["EXPTIME"] == .floatingPoint(300))
+    #expect(header.comment(for: "EXPTIME") == "seconds")
+    #expect(header["FILTER"] == .string("Ha"))
+    #expect(header.history == ["dark subtracted", "flat fielded"], "All HISTORY cards should be kept in order")
+    #expect(header.keywords == ["EXPTIME", "HISTORY", "FILTER"])
+
+    let rebuilt = FITSHeader(dictionary: ["EXPTIME": .floatingPoint(300), "FILTER": .string("Ha")])
+    #expect(rebuilt["EXPTIME"] == header["EXPTIME"], "Formatted cards should parse back to the same value")
+    #expect(rebuilt.dictionary.count == 2)
+}
+
+@Test("Header cards are 80 bytes of printable ASCII")
+func headerCardFormatting() {
+    let cards = [
+        FITSHeader.formatCard(keyword: "OBJECT", value: .string("Cœur du Cygne"), comment: "Nébuleuse"),
+        FITSHeader.formatCard(keyword: "OBSERVATORY", value: .comment("backyard")),
+        FITSHeader.formatCard(keyword: "DATAMAX", value: .floatingPoint(.nan)),
+        FITSHeader.formatCard(keyword: "DATAMIN", value: .floatingPoint(-.infinity), comment: "no data")
+    ]
+    for card in cards {
+        #expect(card.utf8.count == 80, "Every card should be exactly 80 bytes")
+        #expect(card.utf8.allSatisfy { (0x20...0x7E).contains($0) }, "Cards should only contain printable ASCII")
+    }
+
+    let header = FITSHeader(table: FITSKeywordTable(text: Array((cards.joined() + "END".padding(toLength: 80, withPad: " ", startingAt: 0)).utf8)))
+    #expect(header["OBJECT"] == .string("C?ur du Cygne"))
+    #expect(header["OBSERVATORY"] == .string("backyard"), "Long commentary keywords should not be truncated")
+    #expect(header["DATAMAX"]?.doubleValue == nil, "Non-finite values should be written as undefined")
+    #expect(!cards[2].contains("NAN") && !cards[3].contains("INF"))
+}
+
 // MARK: - Image Data Tests
 
 @Test("Can read image pixel data from FITS file")
@@ -128,16 +201,60 @@ func readImageData() throws {
     let image = try fitsFile.readFITSImage()
     
     // Check pixel data
-    #expect(!image.pixelData.isEmpty, "Image should have pixel data")
-    #expect(image.pixelData.count == image.width * image.height, "Pixel data count should match image dimensions")
+    #expect(!image.normalizedPixels.isEmpty, "Image should have pixel data")
+    #expect(image.normalizedPixels.count == image.width * image.height, "Pixel data count should match image dimensions")
     
     // Check that pixel values are normalized (0-1 range)
-    let minValue = image.pixelData.min() ?? 0
-    let maxValue = image.pixelData.max() ?? 0
+    let minValue = image.normalizedPixels.min() ?? 0
+    let maxValue = image.normalizedPixels.max() ?? 0
     #expect(minValue >= 0, "Pixel values should be >= 0")
     #expect(maxValue <= 1.0, "Pixel values should be <= 1.0 (normalized)")
 }
 
+@Test("Raw data reproduces original pixel values")
+func rawDataRoundTrip() throws {
+    let files = getAllFITSFiles()
+    guard let firstFile = files.first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let rawData = image.rawData
+    #expect(rawData.count == image.normalizedPixels.count * MemoryLayout<Float32>.size, "Raw data should hold one Float32 per pixel")
+
+    let rawValues = rawData.withUnsafeBytes { Array($0.bindMemory(to: Float32.self)) }
+    let finiteValues = rawValues.filter { $0.isFinite }
+    #expect(finiteValues.min() == image.originalMinValue, "Raw minimum should match the original minimum")
+    #expect(finiteValues.max() == image.originalMaxValue, "Raw maximum should match the original maximum")
+    #expect(rawValues[0] == image.getPixelValue(x: 0, y: 0), "Raw value should match getPixelValue")
+}
+
+@Test("Regions share pixel storage and copy on write")
+func regionSharesStorage() {
+    let pixels: [Float32] = (0..<64).map { Float32($0) }
+    let image = FITSImage(
+        width: 8, height: 8, depth: 1, bitpix: -32, dataType: .float,
+        storage: pixels.withUnsafeBufferPointer { FITSPixelStore(copying: $0) },
+        originalMinValue: 0, originalMaxValue: 63, header: .empty
+    )
+    #expect(Int(bitPattern: image.storage.pointer) % FITSPixelStore.alignment == 0, "Store should be 64-byte aligned")
+
+    guard var region = image.extractRegion(centerX: 4, centerY: 4, size: 4) else {
+        Issue.record("Region should be extracted")
+        return
+    }
+    #expect(region.storage === image.storage, "Region should share the parent's store")
+    #expect(region.getPixelValue(x: 0, y: 0) == image.getPixelValue(x: 2, y: 2), "Region should map onto parent pixels")
+
+    region.withUnsafeMutablePixels { target, _, _ in
+        target[0] = 63
+    }
+    #expect(region.storage !== image.storage, "Mutating a shared region should copy its store")
+    #expect(image.rawPixels[2, 2] == pixels[2 * 8 + 2], "Mutating a region should not affect the parent")
+    #expect(region.rawPixels[0, 0] == 63, "Mutation should be visible in the region")
+}
+
 @Test("Image data type is valid")
 func imageDataType() throws {
     let files = getAllFITSFiles()
@@ -156,6 +273,879 @@ func imageDataType() throws {
     #expect(image.bitpix != 0, "BITPIX should be non-zero")
 }
 
+@Test("Geometry folds extra axes and reads honor the allocation cap")
+func imageGeometryAndAllocationCap() throws {
+    let cube = try FITSImageGeometry(bitpix: 16, axes: [100, 80, 3, 4])
+    #expect(cube.pixelCount == 96_000)
+    #expect(cube.depth == 12, "Axes beyond the second should fold into planes")
+    #expect(cube.planeCoordinates(7) == [1, 2])
+    #expect(throws: FITSFileError.self) {
+        _ = try FITSImageGeometry(bitpix: 8, axes: [Int.max, 2])
+    }
+
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let fitsFile = try FITSFile(path: firstFile)
+    let image = try fitsFile.readFITSImage()
+    let geometry = try fitsFile.readImageGeometry()
+    #expect(geometry.pixelCount == image.width * image.height * image.depth)
+
+    var firstRow = [Float32](repeating: 0, count: image.width)
+    var start = [Int](repeating: 0, count: geometry.naxis)
+    start[1] = image.height - 1
+    try fitsFile.readPixels(at: start, count: image.width, into: &firstRow)
+    for x in [0, image.width / 2, image.width - 1] {
+        #expect(firstRow[x] == image.getPixelValue(x: x, y: image.height - 1), "Coordinate read should match full read")
+    }
+
+    let limited = try FITSFile(path: firstFile)
+    limited.maxAllocationBytes = 16
+    #expect(throws: FITSFileError.self) {
+        _ = try limited.readFITSImage()
+    }
+}
+
+@Test("Region reads match regions of the full image")
+func readRegionFromFile() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    guard image.width >= 16 && image.height >= 16 else {
+        return
+    }
+
+    let fitsFile = try FITSFile(path: firstFile)
+    let region = try fitsFile.readRegion(x: 4, y: 6, width: 8, height: 5)
+    #expect(region.width == 8 && region.height == 5)
+    #expect(region.getPixelValue(x: 0, y: 0) == image.getPixelValue(x: 4, y: 6), "Region should start at the requested pixel")
+    #expect(region.getPixelValue(x: 7, y: 4) == image.getPixelValue(x: 11, y: 10), "Region should end at the requested pixel")
+
+    let cutouts = try fitsFile.readCutouts(centers: [(x: 8, y: 8), (x: 0, y: 0)], size: 6)
+    let inMemory = try #require(image.extractRegion(centerX: 0, centerY: 0, size: 6))
+    #expect(cutouts.count == 2)
+    #expect(cutouts[0]?.width == 6 && cutouts[0]?.height == 6)
+    #expect(cutouts[1]?.width == inMemory.width && cutouts[1]?.height == inMemory.height, "Edge cutouts should be clipped like extractRegion")
+    #expect(cutouts[0]?.getPixelValue(x: 0, y: 0) == image.getPixelValue(x: 5, y: 5))
+}
+
+@Test("Parallel read matches serial read")
+func readImageParallel() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let serial = try FITSFile(path: firstFile).readFITSImage()
+    let parallel = try FITSFile(path: firstFile).readFITSImageParallel(maxConcurrency: 4)
+    #expect(parallel == serial, "Parallel read should produce the same image")
+    #expect(try FITSFile(path: firstFile).currentHDU() == 0, "A new file should start at the primary HDU")
+
+    // Tile-compressed fixture, with tiles that do not divide the image height
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("tiled-\(UUID().uuidString).fits").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+    try FITSWriter.write(serial, to: path, options: FITSWriter.Options(compression: .gzip, tileRows: 7, quantizeLevel: 0))
+
+    let compressedSerial = try FITSFile(path: path).readFITSImage(hduNumber: 1)
+    let compressedParallel = try FITSFile(path: path).readFITSImageParallel(hduNumber: 1, maxConcurrency: 4)
+    #expect(compressedParallel == compressedSerial, "Parallel decompression should match a serial read")
+    #expect(compressedParallel.width == serial.width && compressedParallel.height == serial.height)
+    #expect(compressedParallel.getPixelValue(x: serial.width / 2, y: serial.height - 1) ==
+            serial.getPixelValue(x: serial.width / 2, y: serial.height - 1), "Lossless compression should keep pixel values")
+}
+
+@Test("Files opened from memory read like files on disk")
+func readMemoryFile() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let data = try Data(contentsOf: URL(fileURLWithPath: firstFile))
+    let memoryFile = try FITSFile(data: data, name: "frame")
+    #expect(memoryFile.path == "mem://frame")
+    #expect(try memoryFile.numberOfHDUs() == FITSFile(path: firstFile).numberOfHDUs())
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    #expect(try memoryFile.readFITSImage() == image, "Memory file should decode to the same image")
+    #expect(throws: FITSFileError.self) { try FITSFile(data: Data(count: 2880)) }
+}
+
+@Test("Handle pool reuses handles within its limit")
+func handlePool() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let expected = try FITSFile(path: firstFile).readHeader()
+    let pool = FITSHandlePool(maxOpenHandles: 2)
+    let lock = NSLock()
+    var headers: [[String: FITSHeaderValue]] = []
+
+    DispatchQueue.concurrentPerform(iterations: 16) { _ in
+        let header = try? pool.withHandle(path: firstFile, hdu: 0) { try $0.readHeader() }
+        lock.lock()
+        headers.append(header ?? [:])
+        lock.unlock()
+    }
+
+    let statistics = pool.statistics
+    #expect(headers.allSatisfy { $0 == expected }, "Every worker should read the same header")
+    #expect(statistics.hits + statistics.misses == 16, "Every checkout should be counted")
+    // With a single file, waiting checkouts pick up returned handles instead of replacing them
+    #expect(statistics.evictions == 0, "Returned handles should be reused, not evicted")
+    #expect(statistics.misses <= 2 && statistics.openHandles <= 2, "The pool should stay within its limit")
+
+    pool.removeAll()
+    #expect(pool.statistics.openHandles == 0, "Removing idle handles should close them")
+}
+
+// MARK: - Streaming Tests
+
+@Test("Row chunks cover the whole image")
+func streamRowChunks() throws {
+    let files = getAllFITSFiles()
+    guard let firstFile = files.first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+
+    let fitsFile = try FITSFile(path: firstFile)
+    var rowsSeen = 0
+    var pixelsSeen = 0
+    try fitsFile.forEachRowChunk(rowsPerChunk: 64) { chunk in
+        #expect(chunk.width == image.width, "Chunk width should match image width")
+        #expect(chunk.rowCount <= 64, "Chunk should not exceed the requested number of rows")
+        rowsSeen += chunk.rowCount
+        pixelsSeen += chunk.pixels.count
+    }
+
+    #expect(rowsSeen == image.height * image.depth, "Chunks should cover every row")
+    #expect(pixelsSeen == image.width * image.height * image.depth, "Chunks should cover every pixel")
+
+    let statistics = try FITSFile(path: firstFile).readImageStatistics(rowsPerChunk: 64)
+    #expect(statistics.minValue == image.originalMinValue, "Streamed minimum should match full read")
+    #expect(statistics.maxValue == image.originalMaxValue, "Streamed maximum should match full read")
+}
+
+@Test("Native pixel read matches float read")
+func readNativePixels() throws {
+    let files = getAllFITSFiles()
+    guard let firstFile = files.first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let native = try FITSFile(path: firstFile).readNativeImage()
+
+    #expect(native.width == image.width, "Native width should match image width")
+    #expect(native.height == image.height, "Native height should match image height")
+    #expect(native.byteCount <= native.width * native.height * native.depth * Int(abs(image.bitpix)) / 8,
+            "Native storage should not exceed BITPIX bytes per pixel")
+
+    let physical = native.float32Pixels()
+    #expect(physical.min() == image.originalMinValue, "Converted minimum should match float read")
+    #expect(physical.max() == image.originalMaxValue, "Converted maximum should match float read")
+}
+
+@Test("Mapped image matches streamed read")
+func mapImagePixels() throws {
+    let files = getAllFITSFiles()
+    guard let firstFile = files.first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let mapped = try FITSFile(path: firstFile).mapImage()
+
+    #expect(mapped.width == image.width, "Mapped width should match image width")
+    #expect(mapped.height == image.height, "Mapped height should match image height")
+    #expect(mapped.dataOffset % 2880 == 0, "Data unit should start on a FITS block boundary")
+    #expect(mapped[0, 0] == image.getPixelValue(x: 0, y: 0), "Mapped pixel should match full read")
+
+    let statistics = mapped.statistics(rowsPerChunk: 64)
+    let streamed = try FITSFile(path: firstFile).readImageStatistics(rowsPerChunk: 64)
+    #expect(statistics == streamed, "Mapped statistics should match streamed statistics")
+}
+
+@Test("Catalog scan reads headers and reuses its index")
+func catalogScan() throws {
+    let files = getAllFITSFiles()
+    guard let firstFile = files.first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let indexURL = FileManager.default.temporaryDirectory.appendingPathComponent("catalog-\(UUID().uuidString).json")
+    defer { try? FileManager.default.removeItem(at: indexURL) }
+
+    let scanner = FITSCatalogScanner(maxOpenFiles: 2, indexURL: indexURL)
+    let entries = try scanner.scan(paths: files)
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let first = try #require(entries.first { $0.path == firstFile })
+    #expect(first.width == image.width, "Catalog width should match image width")
+    #expect(first.height == image.height, "Catalog height should match image height")
+    #expect(Int32(first.bitpix) == image.bitpix, "Catalog BITPIX should match image BITPIX")
+    #expect(FileManager.default.fileExists(atPath: indexURL.path), "Index should be written")
+
+    let rescanned = try scanner.scan(paths: files)
+    #expect(rescanned == entries, "Unchanged files should be served from the index")
+
+    // Records of files that disappeared are pruned from the index
+    let copyURL = FileManager.default.temporaryDirectory.appendingPathComponent("catalog-\(UUID().uuidString).fits")
+    try FileManager.default.copyItem(atPath: firstFile, toPath: copyURL.path)
+    _ = try scanner.scan(paths: [copyURL.path])
+    try FileManager.default.removeItem(at: copyURL)
+    _ = try scanner.scan(paths: files)
+    let indexKeys = try (JSONSerialization.jsonObject(with: Data(contentsOf: indexURL)) as? [String: Any])?.keys
+    #expect(indexKeys?.contains(copyURL.path) == false, "Missing files should be pruned from the index")
+
+    let table = FITSCatalogScanner.table(from: entries)
+    #expect(table.data["row_count"] as? Int == entries.count)
+    #expect((table.data["path"] as? [String])?.count == entries.count)
+}
+
+// MARK: - Writing Tests
+
+@Test("Written images round-trip with their header")
+func writeCompressedImage() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let original = image.rawPixels.toArray()
+    let directory = FileManager.default.temporaryDirectory
+
+    let plainPath = directory.appendingPathComponent("writer-\(UUID().uuidString).fits").path
+    let compressedPath = directory.appendingPathComponent("writer-\(UUID().uuidString).fits.fz").path
+    defer {
+        try? FileManager.default.removeItem(atPath: plainPath)
+        try? FileManager.default.removeItem(atPath: compressedPath)
+    }
+
+    try FITSWriter.write(image, to: plainPath)
+    try FITSWriter.write(image, to: compressedPath, options: FITSWriter.Options(compression: .gzip, quantizeLevel: 0))
+
+    // The compressed image follows an empty primary HDU
+    let plain = try FITSFile(path: plainPath).readFITSImage()
+    let compressed = try FITSFile(path: compressedPath).readFITSImageParallel(hduNumber: 1, maxConcurrency: 4)
+
+    for copy in [plain, compressed] {
+        #expect(copy.width == image.width && copy.height == image.height && copy.depth == image.depth,
+                "Written image should keep its dimensions")
+        let values = copy.rawPixels.toArray()
+        #expect(zip(values, original).allSatisfy { $0 == $1 || ($0.isNaN && $1.isNaN) },
+                "Lossless writes should reproduce the original values")
+
+        for keyword in image.header.keywords where !keyword.isEmpty && !FITSWriter.isStructuralKeyword(keyword) {
+            #expect(copy.header[keyword] != nil, "Header keyword \(keyword) should be propagated")
+        }
+    }
+}
+
+@Test("Integer writes round physical values")
+func writeIntegerImage() throws {
+    // Half-integer and fractional values check rounding instead of truncation
+    let pixels: [Float32] = (0..<96).map { Float32($0) * 1.3 - 40 }
+    let image = FITSImage(
+        width: 12, height: 8, depth: 1, bitpix: -32, dataType: .float,
+        storage: pixels.withUnsafeBufferPointer { FITSPixelStore(copying: $0) },
+        originalMinValue: pixels.min()!, originalMaxValue: pixels.max()!, header: .empty
+    )
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("writer-\(UUID().uuidString).fits").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+
+    for (format, bitpix) in [(FITSWriter.PixelFormat.int16, Int32(16)), (.int32, 32)] {
+        for compression in [FITSWriter.Compression.none, .rice] {
+            try FITSWriter.write(image, to: path, options: FITSWriter.Options(pixelFormat: format, compression: compression))
+            let copy = try FITSFile(path: path).readFITSImage(hduNumber: compression == .none ? 0 : 1)
+            #expect(copy.bitpix == bitpix)
+            #expect(copy.rawPixels.toArray() == pixels.map { $0.rounded() }, "Integer pixels should hold the rounded values")
+        }
+    }
+}
+
+@Test("Multi-extension HDUs load concurrently")
+func readMultiExtensionFile() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    guard let region = image.extractRegion(centerX: image.width / 2, centerY: image.height / 2, size: 32) else {
+        Issue.record("Image too small for a region")
+        return
+    }
+
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("mef-\(UUID().uuidString).fits").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+
+    let writer = try FITSWriter(path: path)
+    try writer.write(image)
+    try writer.write(region)
+    try writer.write(image, options: FITSWriter.Options(compression: .gzip, quantizeLevel: 0))
+    try writer.close()
+
+    let file = try FITSFile(path: path)
+    let images = try file.readFITSImages(maxConcurrency: 3)
+    #expect(images.count == 3, "Every image HDU should be read")
+    for (hdu, parallel) in images.enumerated() {
+        #expect(parallel == (try file.readFITSImage(hduNumber: hdu)), "HDU \(hdu) should match a serial read")
+    }
+
+    let selected = try file.readFITSImages(hduNumbers: [1], maxConcurrency: 2)
+    #expect(selected.count == 1 && selected[0].width == region.width, "Only the selected HDU should be read")
+
+    let processed = try #require(try file.readProcessedImages(maxConcurrency: 3).images)
+    #expect(processed.count == 3)
+    #expect(processed.allSatisfy { $0.buffer != nil && $0.existingTexture == nil }, "Images without a device should only have buffers")
+}
+
+@Test("Frame loader delivers frames in order within its limits")
+func frameLoader() async throws {
+    let files = getAllFITSFiles()
+    guard !files.isEmpty else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let paths = files + ["/nonexistent/frame.fits"] + files
+    let loader = FITSFrameLoader(paths: paths, prefetchCount: 2)
+    var indices: [Int] = []
+
+    for await frame in loader {
+        indices.append(frame.index)
+        if frame.path == "/nonexistent/frame.fits" {
+            #expect(throws: FITSFileError.self) { try frame.result.get() }
+        } else {
+            let image = try frame.result.get()
+            #expect(image == (try FITSFile(path: frame.path).readFITSImage()), "Prefetched frame should match a direct read")
+        }
+    }
+
+    let metrics = loader.metrics
+    #expect(indices == Array(paths.indices), "Frames should arrive in path order")
+    #expect(metrics.framesLoaded == paths.count)
+    #expect(metrics.peakQueuedFrames <= 2, "No more than prefetchCount frames should wait")
+    #expect(metrics.buffersReused + metrics.buffersAllocated == paths.count - 1, "Every image should get a store")
+}
+
+@Test("Loader batches stream results and reuse frame stores")
+func frameLoaderBatch() async throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    // The ring holds prefetchCount + 2 stores, so later frames must reuse released ones
+    let loader = FITSFrameLoader(paths: Array(repeating: firstFile, count: 6) + ["/nonexistent/frame.fits"], prefetchCount: 1)
+    let executor = PipelineExecutor(backend: .cpu(CPUComputeContext()))
+    var indices: [Int] = []
+    for await frame in executor.executeBatch(pipeline: StarDetectionPipeline(), frames: loader) {
+        indices.append(frame.index)
+        if frame.index == 6, case .success = frame.result {
+            Issue.record("A frame that cannot be read should fail")
+        }
+    }
+
+    #expect(indices == Array(0..<7), "Results should arrive in frame order")
+    #expect(loader.metrics.buffersReused > 0, "Stores of released frames should be reused")
+}
+
+@Test("Checksums are written and verified")
+func checksums() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    // Chunked sums must match a single pass
+    let bytes = (0..<(FITSFile.checksumChunkSize * 3 + 2880)).map { UInt8(truncatingIfNeeded: ($0 &* 2654435761) >> 13) }
+    bytes.withUnsafeBytes { buffer in
+        #expect(FITSFile.checksum(of: buffer, maxConcurrency: 8) == FITSFile.checksum(of: buffer, maxConcurrency: 1))
+    }
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("checksum-\(UUID().uuidString).fits").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+
+    let writer = try FITSWriter(path: path)
+    try writer.write(image, options: FITSWriter.Options(checksum: true))
+    try writer.write(image, options: FITSWriter.Options(compression: .rice, checksum: true))
+    try writer.close()
+
+    let results = try FITSFile(path: path).verifyChecksums()
+    #expect(results.count == 2)
+    #expect(results.allSatisfy { $0.dataStatus == .valid && $0.hduStatus == .valid }, "Written checksums should verify")
+
+    // Flip one byte in the first data unit
+    let dataOffset = UInt64(try FITSFile(path: path).mapImage().dataOffset)
+    let handle = try FileHandle(forUpdating: URL(fileURLWithPath: path))
+    try handle.seek(toOffset: dataOffset)
+    let original = try handle.read(upToCount: 1) ?? Data([0])
+    try handle.seek(toOffset: dataOffset)
+    try handle.write(contentsOf: Data([original[0] ^ 0xFF]))
+    try handle.close()
+
+    let corrupted = try FITSFile(path: path).verifyChecksums()
+    #expect(!corrupted[0].isValid, "A changed data byte should be detected")
+}
+
+@Test("Frame cache evicts, spills and notices changed files")
+func frameCache() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let directory = FileManager.default.temporaryDirectory.appendingPathComponent("frame-cache-\(UUID().uuidString)")
+    try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: directory) }
+    let pathA = directory.appendingPathComponent("a.fits").path
+    let pathB = directory.appendingPathComponent("b.fits").path
+    try FileManager.default.copyItem(atPath: firstFile, toPath: pathA)
+    try FileManager.default.copyItem(atPath: firstFile, toPath: pathB)
+
+    let expected = try FITSFile(path: firstFile).readFITSImage()
+    let frameBytes = expected.width * expected.height * expected.depth * MemoryLayout<Float32>.stride
+    let spillDirectory = directory.appendingPathComponent("spill")
+    let cache = FITSFrameCache(byteBudget: frameBytes, spillDirectory: spillDirectory)
+
+    #expect(try cache.image(path: pathA) == expected)
+    #expect(try cache.image(path: pathA) == expected)
+    _ = try cache.image(path: pathB)
+    #expect(try cache.image(path: pathA) == expected, "A spilled frame should be restored unchanged")
+
+    var statistics = cache.statistics
+    #expect(statistics.misses == 2 && statistics.hits == 1 && statistics.spillHits == 1)
+    #expect(statistics.evictions == 2 && statistics.spills == 2, "Each new frame should push the other one out")
+    #expect(statistics.bytes <= frameBytes, "The cache should stay within its budget")
+
+    try FileManager.default.setAttributes([.modificationDate: Date().addingTimeInterval(60)], ofItemAtPath: pathA)
+    _ = try cache.image(path: pathA)
+    statistics = cache.statistics
+    #expect(statistics.misses == 3, "A modified file should be decoded again")
+
+    // The spill of the old version of b.fits is dropped when the new version is read
+    try FileManager.default.setAttributes([.modificationDate: Date().addingTimeInterval(60)], ofItemAtPath: pathB)
+    _ = try cache.image(path: pathB)
+    #expect(cache.statistics.spillBytes == frameBytes, "Only the spill of the evicted a.fits should remain")
+
+    cache.removeAll()
+    #expect(cache.statistics.entryCount == 0)
+    #expect(try FileManager.default.contentsOfDirectory(atPath: spillDirectory.path).isEmpty, "Removed spills should be deleted")
+
+    // Spill files left behind by an earlier cache are deleted when a cache is created
+    let stale = spillDirectory.appendingPathComponent("stale.frame")
+    try Data([0]).write(to: stale)
+    _ = FITSFrameCache(spillDirectory: spillDirectory)
+    #expect(!FileManager.default.fileExists(atPath: stale.path), "Stale spill files should be removed")
+
+    // Frames larger than the budget are returned but not kept
+    let smallCache = FITSFrameCache(byteBudget: frameBytes - 1, spillDirectory: directory.appendingPathComponent("small-spill"))
+    #expect(try smallCache.image(path: pathA) == expected)
+    _ = try smallCache.image(path: pathB)
+    statistics = smallCache.statistics
+    #expect(statistics.entryCount == 0 && statistics.spills == 0, "Oversized frames should not be cached or spilled")
+}
+
+@Test("Gzip reader streams .fits.gz files like CFITSIO")
+func readGzipFile() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    // CFITSIO compresses files whose name ends in .gz when they are closed
+    let expected = try FITSFile(path: firstFile).readFITSImage()
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("gzip-\(UUID().uuidString).fits.gz").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+    try FITSWriter.write(expected, to: path, options: FITSWriter.Options(pixelFormat: .float32))
+    let reference = try FITSFile(path: path).readFITSImage()
+
+    let reader = try FITSGzipReader(path: path)
+    #expect(!reader.isBlockCompressed, "A single gzip stream has no BGZF index")
+    let image = try reader.readFITSImage()
+    #expect(image.width == reference.width && image.height == reference.height && image.depth == reference.depth)
+    #expect(image.originalMinValue == reference.originalMinValue && image.originalMaxValue == reference.originalMaxValue)
+    let pixels = image.normalizedPixels.toArray()
+    let referencePixels = reference.normalizedPixels.toArray()
+    #expect(zip(pixels, referencePixels).allSatisfy { abs($0 - $1) <= 1e-6 }, "Streamed pixels should match CFITSIO")
+
+    var rows = 0
+    try reader.forEachRowChunk(rowsPerChunk: 100) { chunk in
+        #expect(chunk.rowCount <= 100 && chunk.width == image.width)
+        rows += chunk.rowCount
+    }
+    #expect(rows == image.height * image.depth)
+}
+
+@Test("Gzip reader inflates BGZF members in parallel")
+func readBlockGzipFile() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let directory = FileManager.default.temporaryDirectory
+    let plainPath = directory.appendingPathComponent("bgzf-\(UUID().uuidString).fits").path
+    let blockedPath = plainPath + ".gz"
+    defer {
+        try? FileManager.default.removeItem(atPath: plainPath)
+        try? FileManager.default.removeItem(atPath: blockedPath)
+    }
+    try FITSWriter.write(try FITSFile(path: firstFile).readFITSImage(), to: plainPath)
+    let plainBytes = [UInt8](try Data(contentsOf: URL(fileURLWithPath: plainPath)))
+
+    // CRC-32 as used by gzip (reflected polynomial 0xEDB88320)
+    let crcTable: [UInt32] = (0..<256).map { entry in
+        (0..<8).reduce(UInt32(entry)) { crc, _ in crc & 1 != 0 ? (crc >> 1) ^ 0xEDB8_8320 : crc >> 1 }
+    }
+    func crc32(_ bytes: ArraySlice<UInt8>) -> UInt32 {
+        ~bytes.reduce(UInt32.max) { crc, byte in crcTable[Int((crc ^ UInt32(byte)) & 0xFF)] ^ (crc >> 8) }
+    }
+    func appendLittleEndian<T: FixedWidthInteger>(_ value: T, to data: inout [UInt8]) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+
+    // Concatenated gzip members with a 'BC' extra field, each holding one stored deflate block
+    let memberPayload = 60_000
+    var blocked: [UInt8] = []
+    for start in stride(from: 0, to: plainBytes.count, by: memberPayload) {
+        let payload = plainBytes[start..<min(start + memberPayload, plainBytes.count)]
+        let memberSize = 18 + 5 + payload.count + 8
+        blocked += [0x1F, 0x8B, 8, 4, 0, 0, 0, 0, 0, 0xFF, 6, 0, UInt8(ascii: "B"), UInt8(ascii: "C"), 2, 0]
+        appendLittleEndian(UInt16(memberSize - 1), to: &blocked)
+        blocked.append(1)
+        appendLittleEndian(UInt16(payload.count), to: &blocked)
+        appendLittleEndian(~UInt16(payload.count), to: &blocked)
+        blocked += payload
+        appendLittleEndian(crc32(payload), to: &blocked)
+        appendLittleEndian(UInt32(payload.count), to: &blocked)
+    }
+    try Data(blocked).write(to: URL(fileURLWithPath: blockedPath))
+
+    let reference = try FITSFile(path: plainPath).readFITSImage()
+    let reader = try FITSGzipReader(path: blockedPath, maxConcurrency: 4)
+    #expect(reader.isBlockCompressed, "Members with BC fields should be indexed")
+    let image = try reader.readFITSImage()
+    #expect(image.width == reference.width && image.height == reference.height && image.depth == reference.depth)
+    let pixels = image.normalizedPixels.toArray()
+    let referencePixels = reference.normalizedPixels.toArray()
+    #expect(pixels.count == referencePixels.count)
+    #expect(zip(pixels, referencePixels).allSatisfy { abs($0 - $1) <= 1e-6 }, "Block-parallel pixels should match the plain file")
+}
+
+@Test("SER reader maps frames and converts them in chunks")
+func readSERFile() throws {
+    // 5 mono frames of 4x3 16-bit little-endian pixels, followed by a timestamp trailer
+    let width = 4, height = 3, frameCount = 5
+    var data = Data("LUCAM-RECORDER".utf8)
+    for value in [Int32(0), 0, 0, Int32(width), Int32(height), 12, Int32(frameCount)] {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+    for field in ["Observer", "Camera", "Telescope"] {
+        data.append(contentsOf: Array(field.utf8) + [UInt8](repeating: 0, count: 40 - field.utf8.count))
+    }
+    data.append(contentsOf: [UInt8](repeating: 0, count: 16))
+    #expect(data.count == 178)
+    for frame in 0..<frameCount {
+        for pixel in 0..<(width * height) {
+            withUnsafeBytes(of: UInt16(frame * 100 + pixel).littleEndian) { data.append(contentsOf: $0) }
+        }
+    }
+    let ticksAt1970: Int64 = 621_355_968_000_000_000
+    for frame in 0..<frameCount {
+        withUnsafeBytes(of: (ticksAt1970 + Int64(frame) * 10_000_000).littleEndian) { data.append(contentsOf: $0) }
+    }
+
+    let path = FileManager.default.temporaryDirectory.appendingPathComponent("stream-\(UUID().uuidString).ser").path
+    defer { try? FileManager.default.removeItem(atPath: path) }
+    try data.write(to: URL(fileURLWithPath: path))
+
+    let file = try SERFile(path: path)
+    #expect(file.width == width && file.height == height && file.frameCount == frameCount)
+    #expect(file.colorID == .mono && file.isLittleEndian && file.instrument == "Camera")
+
+    let frame = file.frame(at: 3)
+    #expect(frame[1, 2] == Float32(300 + 2 * width + 1))
+    #expect(frame.timestamp == Date(timeIntervalSince1970: 3))
+    let image = frame.makeFITSImage()
+    #expect(image.originalMinValue == 300 && image.originalMaxValue == Float32(300 + width * height - 1))
+    #expect(image.header["INSTRUME"]?.stringValue == "Camera")
+
+    var firstFrames: [Int] = []
+    file.forEachFrameChunk(chunkSize: 2) { firstFrame, images in
+        firstFrames.append(firstFrame)
+        for (offset, image) in images.enumerated() {
+            #expect(image.originalMinValue == Float32((firstFrame + offset) * 100))
+        }
+    }
+    #expect(firstFrames == [0, 2, 4])
+
+    // Frames whose pipeline fails are reported without ending the batch
+    let executor = PipelineExecutor(backend: .cpu(CPUComputeContext()))
+    let results = executor.executeBatch(pipeline: StarDetectionPipeline(), serFile: file, frameRange: 1..<4, chunkSize: 2, inputName: "missing_input")
+    #expect(results.map(\.index) == [1, 2, 3], "Every frame should get a result")
+    for frame in results {
+        if case .success = frame.result {
+            Issue.record("A frame without the pipeline's input should fail")
+        }
+    }
+}
+
+@Test("Star detection runs on the CPU backend")
+func starDetectionOnCPU() throws {
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+
+    let context = CPUComputeContext()
+    let constant = context.uniformImage(width: 40, height: 30, value: 0.25)
+    let blurredConstant = context.gaussianBlur(constant, radius: 3)
+    #expect(blurredConstant.toArray().allSatisfy { abs($0 - 0.25) < 1e-5 }, "Blur should preserve a constant image")
+
+    var spot = [Float32](repeating: 0, count: 40 * 30)
+    spot[15 * 40 + 20] = 1
+    let spotImage = context.uniformImage(width: 40, height: 30, value: 0)
+    spotImage.row(15)[20] = 1
+    let dilated = context.binaryMorphology(spotImage, kernelSize: 3, erode: false)
+    #expect(dilated.toArray().reduce(0, +) == 9, "Dilating one pixel with a 3x3 kernel should set 9 pixels")
+    #expect(context.binaryMorphology(dilated, kernelSize: 3, erode: true).toArray() == spot)
+
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let executor = PipelineExecutor(backend: .cpu(context))
+    let outputs = try executor.execute(pipeline: StarDetectionPipeline(), inputs: ["input_image": .fitsImage(image)])
+
+    for name in ["blurred_image", "background_subtracted_image", "thresholded_image", "dilated_image"] {
+        let buffer = try #require(outputs[name]?.processedImage?.buffer, "\(name) should be an image buffer")
+        #expect(buffer.width == image.width && buffer.height == image.height)
+    }
+    let thresholded = try #require(outputs["thresholded_image"]?.processedImage)
+    #expect(thresholded.imageType == .binary)
+    #expect(thresholded.buffer?.toArray().allSatisfy { $0 == 0 || $0 == 1 } == true)
+    #expect(outputs["coordinate_count"]?.processedScalar != nil)
+    #expect(outputs["annotated_image"]?.processedImage?.buffer != nil)
+}
+
+@Test("Pixel buffers align rows and share regions and borrowed memory")
+func pixelBufferViews() throws {
+    let buffer = ImageBuffer(width: 10, height: 6)
+    #expect(buffer.rowStride == 16, "Rows should start on 64-byte boundaries")
+    #expect(Int(bitPattern: buffer.baseAddress) % 64 == 0)
+    buffer.withUnsafeBaseAddress { base, rowStride in
+        for y in 0..<6 {
+            for x in 0..<10 {
+                base[y * rowStride + x] = Float32(y * 10 + x)
+            }
+        }
+    }
+
+    let region = buffer.region(x: 2, y: 3, width: 4, height: 2)
+    #expect(region.store === buffer.store, "Regions should share the store")
+    #expect(region[x: 0, y: 0] == 32 && region[x: 3, y: 1] == 45)
+    #expect(region.toArray() == [32, 33, 34, 35, 42, 43, 44, 45])
+    #expect(region.copy().toArray() == region.toArray())
+
+    let bytes = PixelBuffer<UInt8>(width: 3, height: 2)
+    #expect(bytes.rowStride == 64)
+
+    var values: [Float32] = [1, 2, 3, 4, 5, 6]
+    let owner = NSObject()
+    let borrowed = values.withUnsafeMutableBufferPointer { pixels in
+        ImageBuffer(borrowing: pixels.baseAddress!, width: 2, height: 3, owner: owner).copy()
+    }
+    #expect(borrowed.isBorrowed == false && borrowed.toArray() == values)
+    values.withUnsafeMutableBufferPointer { pixels in
+        let view = ImageBuffer(borrowing: pixels.baseAddress!, width: 2, height: 3, owner: owner)
+        #expect(view.isBorrowed && view[x: 1, y: 2] == 6)
+    }
+
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    let processed = ProcessedImage.fromFITSImage(image)
+    let pixels = try processed.pixelBuffer()
+    #expect(pixels.toArray() == image.normalizedPixels.toArray(), "The buffer should hold the normalized FITS pixels")
+    #expect(processed.buffer != nil && processed.existingTexture == nil)
+}
+
+@Test("Buffer pool reuses stores once their images are released")
+func bufferPoolReuse() throws {
+    let pageSize = Int(getpagesize())
+    #expect(PixelBufferPool.sizeClassByteCount(for: 100) == 128)
+    #expect(PixelBufferPool.sizeClassByteCount(for: 10 * pageSize + 1) == 12 * pageSize)
+
+    let pool = PixelBufferPool()
+    do {
+        let first: ImageBuffer = pool.makeBuffer(width: 100, height: 80)
+        let held: ImageBuffer = pool.makeBuffer(width: 100, height: 80)
+        #expect(first.store !== held.store, "A store in use should not be handed out twice")
+    }
+    let reused: ImageBuffer = pool.makeBuffer(width: 100, height: 80)
+    #expect(pool.statistics.buffersAllocated == 2 && pool.statistics.buffersReused == 1)
+    #expect(Int(bitPattern: reused.baseAddress) % 64 == 0)
+    let bytes: PixelBuffer<UInt8> = pool.makeBuffer(width: 100, height: 80)
+    #expect(bytes.rowStride == 128 && pool.statistics.buffersAllocated == 3, "Element types should not share stores")
+
+    guard let firstFile = getAllFITSFiles().first else {
+        Issue.record("No FITS files available for testing")
+        return
+    }
+    let image = try FITSFile(path: firstFile).readFITSImage()
+    // Steps run one at a time, so both frames make the same requests in the same order
+    let executor = PipelineExecutor(backend: .cpu(CPUComputeContext()), maxConcurrentSteps: 1)
+    do {
+        _ = try executor.execute(pipeline: StarDetectionPipeline(), inputs: ["input_image": .fitsImage(image)])
+    }
+    let afterFirstFrame = executor.bufferPool.statistics
+    #expect(afterFirstFrame.buffersAllocated > 0)
+    _ = try executor.execute(pipeline: StarDetectionPipeline(), inputs: ["input_image": .fitsImage(image)])
+    let afterSecondFrame = executor.bufferPool.statistics
+    #expect(afterSecondFrame.buffersAllocated == afterFirstFrame.buffersAllocated, "A second frame should only reuse the first frame's buffers")
+    #expect(afterSecondFrame.buffersReused > afterFirstFrame.buffersReused)
+    #expect(afterSecondFrame.bytes <= executor.bufferPool.byteBudget)
+}
+
+/// Counts how many test steps run at the same time
+final class StepTracker {
+    private let lock = NSLock()
+    private var running = 0
+    private(set) var maxRunning = 0
+
+    func enter() {
+        lock.lock()
+        running += 1
+        maxRunning = max(maxRunning, running)
+        lock.unlock()
+    }
+
+    func leave() {
+        lock.lock()
+        running -= 1
+        lock.unlock()
+    }
+}
+
+/// Test step that adds its scalar inputs and one, after a short delay
+final class SumStep: PipelineStep {
+    let id: String
+    let name: String
+    let description = "Adds its inputs"
+    let requiredInputs: [String]
+    let optionalInputs: [String] = []
+    let outputs: [String]
+    let tracker: StepTracker
+
+    init(_ id: String, inputs: [String], output: String, tracker: StepTracker) {
+        self.id = id
+        self.name = id
+        self.requiredInputs = inputs
+        self.outputs = [output]
+        self.tracker = tracker
+    }
+
+    func execute(inputs: [String: PipelineStepInput], device: MTLDevice, commandQueue: MTLCommandQueue) throws -> [String: PipelineStepOutput] {
+        return try execute(inputs: inputs, context: CPUComputeContext())
+    }
+
+    func execute(inputs: [String: PipelineStepInput], context: CPUComputeContext) throws -> [String: PipelineStepOutput] {
+        tracker.enter()
+        Thread.sleep(forTimeInterval: 0.05)
+        tracker.leave()
+
+        let sum = requiredInputs.compactMap { inputs[$0]?.data.scalar }.reduce(0, +)
+        return [outputs[0]: PipelineStepOutput(name: outputs[0], data: .scalar(sum + 1))]
+    }
+}
+
+/// Pipeline of two branches joined by a last step: w = 2 * input + 5
+func diamondPipeline(tracker: StepTracker) -> BasePipeline {
+    return BasePipeline(
+        id: "diamond",
+        name: "Diamond",
+        description: "Two branches joined by a last step",
+        steps: [
+            SumStep("a", inputs: ["input"], output: "x", tracker: tracker),
+            SumStep("b", inputs: ["x"], output: "y", tracker: tracker),
+            SumStep("c", inputs: ["x"], output: "z", tracker: tracker),
+            SumStep("d", inputs: ["y", "z"], output: "w", tracker: tracker)
+        ],
+        requiredInputs: ["input"],
+        outputs: ["x", "y", "z", "w"]
+    )
+}
+
+@Test("Independent pipeline steps run concurrently with deterministic outputs")
+func pipelineGraphScheduling() throws {
+    let starGraph = PipelineGraph(pipeline: StarDetectionPipeline())
+    #expect(starGraph.isChain)
+    #expect(starGraph.dependencies.last == [5, 6], "The overlay should wait for the coordinates and the quads")
+    #expect(starGraph.ancestors.last == Array(0..<7))
+
+    let tracker = StepTracker()
+    let pipeline = diamondPipeline(tracker: tracker)
+    let graph = PipelineGraph(pipeline: pipeline)
+    #expect(graph.levels == [[0], [1, 2], [3]])
+    #expect(graph.dependents[0] == [1, 2] && graph.dependencies[3] == [1, 2])
+
+    var completed: [Int] = []
+    let executor = PipelineExecutor(backend: .cpu(CPUComputeContext()))
+    let outputs = try executor.execute(pipeline: pipeline, inputs: ["input": .scalar(1)]) { index, _, _ in
+        completed.append(index)
+    }
+    #expect(outputs["x"]?.scalar == 2 && outputs["y"]?.scalar == 3 && outputs["z"]?.scalar == 3)
+    #expect(outputs["w"]?.scalar == 7)
+    #expect(completed.count == 4 && completed.first == 0 && completed.last == 3)
+    if ProcessInfo.processInfo.activeProcessorCount > 1 {
+        #expect(tracker.maxRunning == 2, "The two branches should run at the same time")
+    }
+}
+
+@Test("Parallel batches stream every frame and collect per-frame errors")
+func parallelBatch() async throws {
+    let tracker = StepTracker()
+    let pipeline = diamondPipeline(tracker: tracker)
+    let executor = PipelineExecutor(backend: .cpu(CPUComputeContext()))
+    let imageInputs: [[String: PipelineData]] = (0..<8).map { index in
+        index == 5 ? [:] : ["input": .scalar(Float(index))]
+    }
+
+    let batch = executor.executeBatchInParallel(pipeline: pipeline, imageInputs: imageInputs, maxConcurrentFrames: 3)
+    var results: [Int: Result<[String: PipelineData], Error>] = [:]
+    for await frame in batch {
+        results[frame.index] = frame.result
+    }
+
+    #expect(results.count == 8, "Every frame should be delivered once")
+    for index in 0..<8 where index != 5 {
+        let outputs = try #require(try? results[index]?.get())
+        #expect(outputs["w"]?.scalar == Float(2 * index + 5))
+    }
+    if case .success? = results[5] {
+        Issue.record("A frame without its required input should fail")
+    }
+    let metrics = batch.metrics
+    #expect(metrics.framesCompleted == 8 && metrics.framesFailed == 1)
+    #expect(metrics.peakRunningFrames <= 3)
+}
+
 // MARK: - Multiple Files Tests
 
 @Test("Can read all FITS test files")
@@ -169,7 +1159,7 @@ func readAllFITSFiles() throws {
         
         #expect(image.width > 0, "File \(filePath) should have valid width")
         #expect(image.height > 0, "File \(filePath) should have valid height")
-        #expect(!image.pixelData.isEmpty, "File \(filePath) should have pixel data")
+        #expect(!image.normalizedPixels.isEmpty, "File \(filePath) should have pixel data")
     }
 }
 
@@ -244,7 +1234,7 @@ func createMetalBuffer() throws {
     
     let buffer = image.createMetalBuffer(device: device)
     #expect(buffer != nil, "Should create Metal buffer")
-    #expect(buffer?.length == image.pixelData.count * MemoryLayout<Float32>.size, "Buffer size should match pixel data size")
+    #expect(buffer?.length == image.normalizedPixels.count * MemoryLayout<Float32>.size, "Buffer size should match pixel data size")
 }
 
 // MARK: - Astronomical Metadata Tests